@@ -0,0 +1,160 @@
+// Replacements of every form of the global operator new and delete:
+// the plain, array, nothrow and over-aligned ones, so that all the
+// allocations are counted, and every delete frees the way its new allocated.
+// They live apart from the benchmarks, so that the compiler does not pair
+// inlined new and delete expressions with the library's forms
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "Allocations.h"
+
+std::atomic<std::size_t> allocatedBytes{ 0 };
+std::atomic<std::size_t> allocationCount{ 0 };
+
+namespace
+{
+    void* Allocate(const std::size_t size) noexcept
+    {
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size != 0 ? size : 1);
+    }
+
+    void* AllocateAligned(const std::size_t size, const std::align_val_t alignment) noexcept
+    {
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t bytes{ static_cast<std::size_t>(alignment) };
+#if defined(_MSC_VER)
+        return _aligned_malloc(size != 0 ? size : 1, bytes);
+#else
+        // aligned_alloc wants a non-zero multiple of the alignment
+        const std::size_t rounded{ (std::max<std::size_t>(size, 1) + bytes - 1) / bytes * bytes };
+        return std::aligned_alloc(bytes, rounded);
+#endif
+    }
+
+    void Free(void* pointer) noexcept
+    {
+        std::free(pointer);
+    }
+
+    void FreeAligned(void* pointer) noexcept
+    {
+#if defined(_MSC_VER)
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* pointer = Allocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* pointer = Allocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = AllocateAligned(size, alignment))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = AllocateAligned(size, alignment))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    Free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    Free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    Free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    Free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    Free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    Free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    FreeAligned(pointer);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Bytes and number of the allocations of the whole program, counted by the
+// replacements of the global operator new in Allocations.cpp, so that the
+// benchmarks can tell how much memory an operation allocates
+
+#include <atomic>
+#include <cstddef>
+
+extern std::atomic<std::size_t> allocatedBytes;
+extern std::atomic<std::size_t> allocationCount;
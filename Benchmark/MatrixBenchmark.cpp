@@ -0,0 +1,431 @@
+// Throughput benchmark of the MatrixMath operations
+//
+// Runs every operator, Determinant, AdjointMatrix, Inverse, ChangeOrder,
+// Merge, Transpose (the view and the access through it) and ToString
+// on square matrices of several sizes, element types and storage orders,
+// and reports for each
+//   - the nanoseconds per operation (best of several runs),
+//   - the GFLOP/s, for the operations with a standard operation count,
+//   - the bytes and the allocations per operation, counted by the
+//     replacements of the global operator new (Allocations.cpp),
+//   - with --perf, the hardware counters of one more run (Linux only):
+//     instructions per cycle, and the L1D, LLC and branch misses
+//     per entry of the result,
+// as a table, and optionally as JSON for tracking regressions.
+//
+// usage:
+//   MatrixBenchmark [--filter TEXT] [--min-time SECONDS] [--perf] [--json PATH]
+//   MatrixBenchmark --tune PATH
+//
+// TEXT selects the benchmarks whose full name contains it,
+// e.g. "Multiply/double" or "/8x8".
+// --tune times the block sizes and unroll factors of the kernels instead,
+// and writes the winners into the tuning file at PATH (see Tuning.h)
+//
+// build (GCC/Clang):
+//   cmake -S Benchmark -B build && cmake --build build
+// or
+//   g++ -std=c++17 -O2 -IMatrix Benchmark/MatrixBenchmark.cpp Benchmark/Allocations.cpp -o MatrixBenchmark
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#   include <intrin.h>
+#endif
+
+#include "Allocations.h"
+#include "Autotune.h"
+#include "Matrix.h"
+#include "PerfCounters.h"
+
+namespace
+{
+    // Make the compiler assume that `value` is read, and that any memory
+    // reachable from escaped pointers may change, so that neither the
+    // operation nor the loading of its operands is optimized away
+    template <typename _Ty>
+    inline void Escape(const _Ty& value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        static const void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r"(&value) : "memory");
+#endif
+    }
+
+    struct Options
+    {
+        std::string filter;
+        double minTime{ 0.02 };
+        bool perf{ false };
+        std::string json;
+        std::string tune;
+    };
+
+    struct Result
+    {
+        std::string name;
+        double nanoseconds;
+        // 0 if the operation has no standard operation count
+        double gflops;
+        double bytes;
+        double allocations;
+        long long iterations;
+        // per operation, all zero without --perf
+        PerfCounters::Values counters;
+        // entries of the result, to which the misses are related
+        double entries;
+    };
+
+    class Suite
+    {
+    private:
+        Options options;
+        std::vector<Result> results;
+        std::unique_ptr<PerfCounters> pCounters;
+
+    public:
+        explicit Suite(const Options& options)
+            : options{ options }
+        {
+            if (!options.perf)
+                return;
+            pCounters = std::make_unique<PerfCounters>();
+            if (!pCounters->IsAvailable())
+            {
+                std::printf("hardware counters unavailable (%s), continuing without them\n",
+                    pCounters->GetError() > 0 ? std::strerror(pCounters->GetError()) : "not Linux");
+                pCounters.reset();
+            }
+        }
+
+        const std::vector<Result>& GetResults() const { return results; }
+        bool HasCounters() const { return pCounters != nullptr; }
+        bool HasCounter(const PerfCounters::Counter counter) const { return pCounters != nullptr && pCounters->Has(counter); }
+
+        // Time `fn` over enough iterations to last `minTime`, keeping the best
+        // of three runs; `flops` is the operation count of one call,
+        // producing `entries` entries
+        template <typename _Fn>
+        void Run(const std::string& name, const double entries, const double flops, _Fn&& fn)
+        {
+            if (name.find(options.filter) == std::string::npos)
+                return;
+
+            auto loop = [&fn](const long long iterations) {
+                const auto start{ std::chrono::steady_clock::now() };
+                for (long long i = 0; i < iterations; i++)
+                {
+                    if constexpr (std::is_void_v<decltype(fn())>)
+                        fn();
+                    else
+                        Escape(fn());
+                }
+                const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+                return elapsed.count();
+            };
+
+            long long iterations{ 1 };
+            while (loop(iterations) < options.minTime && iterations < (1LL << 40))
+                iterations *= 2;
+
+            double best{ 1e30 };
+            std::size_t bytes{ 0 };
+            std::size_t allocations{ 0 };
+            for (int repeat = 0; repeat < 3; repeat++)
+            {
+                const std::size_t bytesBefore{ allocatedBytes.load() };
+                const std::size_t allocationsBefore{ allocationCount.load() };
+                best = std::min(best, loop(iterations));
+                bytes = allocatedBytes.load() - bytesBefore;
+                allocations = allocationCount.load() - allocationsBefore;
+            }
+
+            Result result{};
+            if (pCounters != nullptr)
+            {
+                pCounters->Start();
+                loop(iterations);
+                pCounters->Stop();
+                result.counters = pCounters->Read();
+                for (double& counter : result.counters)
+                    counter /= iterations;
+            }
+
+            result.name = name;
+            result.nanoseconds = best / iterations * 1e9;
+            result.gflops = flops > 0.0 ? flops / result.nanoseconds : 0.0;
+            result.bytes = static_cast<double>(bytes) / iterations;
+            result.allocations = static_cast<double>(allocations) / iterations;
+            result.iterations = iterations;
+            result.entries = entries;
+            std::printf("%-44s %12.1f ns %9.3f GFLOP/s %9.1f B %6.2f allocs",
+                result.name.c_str(), result.nanoseconds, result.gflops, result.bytes, result.allocations);
+            if (pCounters != nullptr)
+            {
+                const PerfCounters::Values& counters{ result.counters };
+                std::printf(" %6.2f IPC", counters[PerfCounters::Cycles] > 0.0
+                    ? counters[PerfCounters::Instructions] / counters[PerfCounters::Cycles] : 0.0);
+                for (const PerfCounters::Counter counter : { PerfCounters::L1DMisses, PerfCounters::LLCMisses, PerfCounters::BranchMisses })
+                    std::printf(" %8.3f %s/entry", counters[counter] / entries, PerfCounters::GetName(counter));
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+            results.push_back(result);
+        }
+    };
+
+    template <typename _Ty>
+    constexpr const char* TypeName()
+    {
+        if constexpr (std::is_same_v<_Ty, float>)
+            return "float";
+        else if constexpr (std::is_same_v<_Ty, double>)
+            return "double";
+        else
+            return "int";
+    }
+
+    template <typename _Ty, int Height, int Width, typename order>
+    MatrixMath::Matrix<_Ty, Height, Width, order> Random(std::mt19937& engine)
+    {
+        std::uniform_int_distribution<int> distribution{ -9, 9 };
+        MatrixMath::Matrix<_Ty, Height, Width, order> result;
+        for (int row = 0; row < Height; row++)
+            for (int column = 0; column < Width; column++)
+                result.SetElement(row, column, static_cast<_Ty>(distribution(engine)));
+        // well conditioned, and invertible
+        if constexpr (Height == Width)
+            for (int i = 0; i < Height; i++)
+                result.GetElement(i, i) += static_cast<_Ty>(10 * Height);
+        return result;
+    }
+
+    // All the benchmarks of (N x N) matrices of `_Ty` stored in `order`
+    template <typename _Ty, int N, typename order>
+    void Square(Suite& suite)
+    {
+        using MatrixType = MatrixMath::Matrix<_Ty, N, N, order>;
+        using OtherOrder = std::conditional_t<order::IsRowMajor(),
+            MatrixMath::StorageOrder::ColumnMajor, MatrixMath::StorageOrder::RowMajor>;
+
+        std::mt19937 engine{ 42 };
+        MatrixType lhs{ Random<_Ty, N, N, order>(engine) };
+        const MatrixType rhs{ Random<_Ty, N, N, order>(engine) };
+        const _Ty scalar{ static_cast<_Ty>(3) };
+        Escape(lhs);
+        Escape(rhs);
+        Escape(scalar);
+
+        const std::string suffix{ std::string{ "/" } + TypeName<_Ty>() + (order::IsRowMajor() ? "/row/" : "/column/")
+            + std::to_string(N) + "x" + std::to_string(N) };
+        const double entries{ static_cast<double>(N) * N };
+        const double cube{ entries * N };
+
+        suite.Run("Add" + suffix, entries, entries, [&]() { return lhs + rhs; });
+        suite.Run("Subtract" + suffix, entries, entries, [&]() { return lhs - rhs; });
+        // zero, so that repeating them does not overflow
+        const MatrixType delta;
+        Escape(delta);
+        suite.Run("AddAssign" + suffix, entries, entries, [&]() { lhs += delta; });
+        suite.Run("SubtractAssign" + suffix, entries, entries, [&]() { lhs -= delta; });
+        // by one, for the same reason
+        const _Ty one{ static_cast<_Ty>(1) };
+        Escape(one);
+        suite.Run("ScalarMultiplyAssign" + suffix, entries, entries, [&]() { lhs *= one; });
+        suite.Run("ScalarDivideAssign" + suffix, entries, entries, [&]() { lhs /= one; });
+        suite.Run("ScalarMultiply" + suffix, entries, entries, [&]() { return rhs * scalar; });
+        suite.Run("LeftScalarMultiply" + suffix, entries, entries, [&]() { return scalar * rhs; });
+        suite.Run("ScalarDivide" + suffix, entries, entries, [&]() { return rhs / scalar; });
+        suite.Run("Multiply" + suffix, entries, 2.0 * cube, [&]() { return lhs * rhs; });
+        const MatrixMath::Vector<_Ty, N, order> vector{ Random<_Ty, N, 1, order>(engine) };
+        Escape(vector);
+        suite.Run("MultiplyVector" + suffix, static_cast<double>(N), 2.0 * entries, [&]() { return rhs * vector; });
+        suite.Run("Equal" + suffix, 1.0, 0.0, [&]() { return lhs == rhs; });
+        suite.Run("NotEqual" + suffix, 1.0, 0.0, [&]() { return lhs != rhs; });
+
+        // flipping the flag of a shared buffer, then reading through it
+        suite.Run("Transpose" + suffix, entries, 0.0, [&]() { return rhs.Transpose(); });
+        suite.Run("Access" + suffix, entries, entries, [&]() {
+            _Ty sum{};
+            for (int row = 0; row < N; row++)
+                for (int column = 0; column < N; column++)
+                    sum += rhs.GetElement(row, column);
+            return sum;
+        });
+        const auto transposed{ rhs.Transpose() };
+        Escape(transposed);
+        suite.Run("TransposedAccess" + suffix, entries, entries, [&]() {
+            _Ty sum{};
+            for (int row = 0; row < N; row++)
+                for (int column = 0; column < N; column++)
+                    sum += transposed.GetElement(row, column);
+            return sum;
+        });
+
+        // integer determinants expand the N! permutations, which are generated
+        // at compile time; the next benchmarked size, 8, would generate 40320
+        // of them (sizes 5 to 7 still build, in seconds, but are not benchmarked)
+        if constexpr (std::is_floating_point_v<_Ty> || N <= 4)
+        {
+            // nominal count of LU elimination: 2/3 N^3
+            suite.Run("Determinant" + suffix, 1.0, 2.0 * cube / 3.0, [&]() { return MatrixMath::Determinant(rhs).value(); });
+            suite.Run("AdjointMatrix" + suffix, entries, 0.0, [&]() { return MatrixMath::AdjointMatrix(rhs); });
+        }
+        if constexpr (std::is_floating_point_v<_Ty>)
+            suite.Run("Inverse" + suffix, entries, 0.0, [&]() { return MatrixMath::Inverse(rhs); });
+
+        suite.Run("ChangeOrder" + suffix, entries, 0.0, [&]() { return MatrixMath::ChangeOrder<OtherOrder>(rhs); });
+        // side by side: a proxy referring to both, then a copy of both
+        suite.Run("Merge" + suffix, 2.0 * entries, 0.0, [&]() {
+            return MatrixMath::Merge<MatrixType, MatrixType, MatrixMath::MergeMode::ROW, order>(lhs, rhs);
+        });
+        suite.Run("MergeCopy" + suffix, 2.0 * entries, 0.0, [&]() {
+            return MatrixMath::Merge<MatrixMath::MergeMode::ROW_MEG, order>(lhs, rhs);
+        });
+
+        suite.Run("ToString" + suffix, entries, 0.0, [&]() { return rhs.ToString(); });
+    }
+
+    template <typename _Ty, typename order>
+    void Sizes(Suite& suite)
+    {
+        Square<_Ty, 2, order>(suite);
+        Square<_Ty, 3, order>(suite);
+        Square<_Ty, 4, order>(suite);
+        Square<_Ty, 8, order>(suite);
+        Square<_Ty, 16, order>(suite);
+    }
+
+    template <typename _Ty>
+    void Orders(Suite& suite)
+    {
+        Sizes<_Ty, MatrixMath::StorageOrder::RowMajor>(suite);
+        Sizes<_Ty, MatrixMath::StorageOrder::ColumnMajor>(suite);
+    }
+
+    bool WriteJson(const std::string& path, const Suite& suite)
+    {
+        const std::vector<Result>& results{ suite.GetResults() };
+        std::FILE* file{ std::fopen(path.c_str(), "w") };
+        if (file == nullptr)
+            return false;
+
+#if defined(__clang__)
+        const std::string compiler{ "clang " __clang_version__ };
+#elif defined(__GNUC__)
+        const std::string compiler{ "gcc " __VERSION__ };
+#elif defined(_MSC_VER)
+        const std::string compiler{ "msvc " + std::to_string(_MSC_FULL_VER) };
+#else
+        const std::string compiler{ "unknown" };
+#endif
+#if defined(NDEBUG)
+        const char* build{ "release" };
+#else
+        const char* build{ "debug" };
+#endif
+
+        std::fprintf(file, "{\n  \"context\": {\n");
+        std::fprintf(file, "    \"time\": %lld,\n", static_cast<long long>(std::time(nullptr)));
+        std::fprintf(file, "    \"compiler\": \"%s\",\n", compiler.c_str());
+        std::fprintf(file, "    \"build\": \"%s\",\n", build);
+        // the kernels measured, e.g. lowered with MATRIX_ISA
+        std::fprintf(file, "    \"isa\": \"%s\",\n", MatrixMath::GetIsaName(MatrixMath::GetIsaLevel()));
+        std::fprintf(file, "    \"hardware_threads\": %u\n  },\n", std::thread::hardware_concurrency());
+        std::fprintf(file, "  \"benchmarks\": [\n");
+        for (std::size_t index = 0; index < results.size(); index++)
+        {
+            const Result& result{ results[index] };
+            std::fprintf(file,
+                "    { \"name\": \"%s\", \"ns_per_op\": %.3f, \"gflops\": %.4f, "
+                "\"bytes_per_op\": %.1f, \"allocs_per_op\": %.3f, \"iterations\": %lld",
+                result.name.c_str(), result.nanoseconds, result.gflops,
+                result.bytes, result.allocations, result.iterations);
+            // only the counters which could be read
+            if (suite.HasCounters())
+            {
+                const PerfCounters::Values& counters{ result.counters };
+                std::fprintf(file, ", \"ipc\": %.3f", counters[PerfCounters::Cycles] > 0.0
+                    ? counters[PerfCounters::Instructions] / counters[PerfCounters::Cycles] : 0.0);
+                for (int counter = 0; counter < PerfCounters::CounterCount; counter++)
+                {
+                    const PerfCounters::Counter which{ static_cast<PerfCounters::Counter>(counter) };
+                    if (!suite.HasCounter(which))
+                        continue;
+                    std::fprintf(file, ", \"%s_per_op\": %.3f", PerfCounters::GetName(which), counters[counter]);
+                    if (which != PerfCounters::Cycles && which != PerfCounters::Instructions)
+                        std::fprintf(file, ", \"%s_per_entry\": %.4f", PerfCounters::GetName(which), counters[counter] / result.entries);
+                }
+            }
+            std::fprintf(file, " }%s\n", index + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int index = 1; index < argc; index++)
+    {
+        const std::string argument{ argv[index] };
+        if (argument == "--filter" && index + 1 < argc)
+            options.filter = argv[++index];
+        else if (argument == "--min-time" && index + 1 < argc)
+            options.minTime = std::atof(argv[++index]);
+        else if (argument == "--perf")
+            options.perf = true;
+        else if (argument == "--json" && index + 1 < argc)
+            options.json = argv[++index];
+        else if (argument == "--tune" && index + 1 < argc)
+            options.tune = argv[++index];
+        else
+        {
+            std::printf("usage: %s [--filter TEXT] [--min-time SECONDS] [--perf] [--json PATH]\n"
+                "       %s --tune PATH\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    if (!options.tune.empty())
+    {
+        std::cout << "tuning " << MatrixMath::GetMachineKey() << std::endl;
+        MatrixMath::AutotuneOptions tuneOptions;
+        tuneOptions.pLog = &std::cout;
+        const MatrixMath::TuningParameters tuning{ MatrixMath::Autotune(tuneOptions) };
+        if (MatrixMath::SaveTuning(options.tune.c_str(), tuning) != std::errc{})
+        {
+            std::printf("cannot write %s\n", options.tune.c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    Suite suite{ options };
+    Orders<float>(suite);
+    Orders<double>(suite);
+    Orders<int>(suite);
+
+    if (!options.json.empty() && !WriteJson(options.json, suite))
+    {
+        std::printf("cannot write %s\n", options.json.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Throughput benchmark of the text parser
+//
+// Writes a CSV file of random doubles, then loads it
+//   - with `LoadMatrix` on one thread,
+//   - with `LoadMatrix` on every core,
+//   - with std::ifstream and operator>>, the usual baseline,
+// and reports the megabytes parsed per second of each.
+//
+// usage:
+//   ParseBenchmark [rows] [columns] [path]
+//
+// build (GCC/Clang):
+//   g++ -std=c++17 -O2 -IMatrix Benchmark/ParseBenchmark.cpp -o ParseBenchmark -lpthread
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "Parse.h"
+
+namespace
+{
+    template <typename _Fn>
+    double BestSeconds(const int repeat, _Fn&& fn)
+    {
+        double best{ 1e30 };
+        for (int i = 0; i < repeat; i++)
+        {
+            const auto start{ std::chrono::steady_clock::now() };
+            fn();
+            const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    void Report(const char* name, const std::size_t bytes, const double seconds)
+    {
+        std::printf("%-24s %9.1f ms %9.1f MB/s\n", name, seconds * 1e3, bytes / seconds / 1e6);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int rows{ argc > 1 ? std::atoi(argv[1]) : 200000 };
+    const int columns{ argc > 2 ? std::atoi(argv[2]) : 16 };
+    const std::string path{ argc > 3 ? argv[3] : "ParseBenchmark.csv" };
+    constexpr int repeat{ 5 };
+
+    {
+        MatrixMath::DynamicMatrix<double> source(rows, columns);
+        std::mt19937_64 engine{ 42 };
+        std::uniform_real_distribution<double> distribution{ -1e3, 1e3 };
+        for (int row = 0; row < rows; row++)
+            for (int column = 0; column < columns; column++)
+                source.SetElement(row, column, distribution(engine));
+
+        std::ofstream file(path, std::ios::binary);
+        MatrixMath::FormatStream(file, source, MatrixMath::FormatOptions::CSV());
+    }
+
+    const std::size_t bytes{ MatrixMath::MappedFile(path.c_str()).GetSize() };
+    if (bytes == 0)
+    {
+        std::printf("cannot map %s\n", path.c_str());
+        return 1;
+    }
+    std::printf("%d x %d doubles, %.1f MB, %u hardware threads\n",
+        rows, columns, bytes / 1e6, std::thread::hardware_concurrency());
+
+    MatrixMath::DynamicMatrix<double> matrix;
+    bool valid{ true };
+
+    MatrixMath::ParseOptions single;
+    single.threads = 1;
+    Report("LoadMatrix, 1 thread", bytes, BestSeconds(repeat, [&]() {
+        valid &= static_cast<bool>(MatrixMath::LoadMatrix(path.c_str(), matrix, single));
+    }));
+
+    const MatrixMath::ParseOptions parallel;
+    Report("LoadMatrix, all threads", bytes, BestSeconds(repeat, [&]() {
+        valid &= static_cast<bool>(MatrixMath::LoadMatrix(path.c_str(), matrix, parallel));
+    }));
+
+    Report("ifstream >>", bytes, BestSeconds(repeat, [&]() {
+        std::ifstream stream(path);
+        MatrixMath::DynamicMatrix<double> result(rows, columns);
+        char comma;
+        for (int row = 0; row < rows; row++)
+            for (int column = 0; column < columns; column++)
+            {
+                stream >> result.GetElement(row, column);
+                if (column + 1 < columns)
+                    stream >> comma;
+            }
+        valid &= static_cast<bool>(stream);
+    }));
+
+    std::remove(path.c_str());
+    if (!valid || matrix.GetHeight() != rows || matrix.GetWidth() != columns)
+    {
+        std::printf("parse failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+// Hardware performance counters around a region of code, read from Linux's
+// perf_event_open as one group, so that they cover the same instructions.
+// Elsewhere, or when the kernel refuses them (perf_event_paranoid, containers,
+// virtual machines without a PMU), IsAvailable() is false and the counters
+// read as zero; the counters the CPU lacks are left out individually
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        // L1 data cache read misses
+        L1DMisses,
+        // last level cache misses
+        LLCMisses,
+        BranchMisses,
+        CounterCount,
+    };
+
+    using Values = std::array<double, CounterCount>;
+
+private:
+    std::array<int, CounterCount> descriptors;
+    // position of every counter in the group, -1 if missing
+    std::array<int, CounterCount> positions;
+    int members{ 0 };
+    int error{ 0 };
+
+public:
+    PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters();
+
+    static const char* GetName(const Counter counter);
+
+    // At least the cycles can be counted
+    bool IsAvailable() const { return positions[Cycles] >= 0; }
+    bool Has(const Counter counter) const { return positions[counter] >= 0; }
+    // errno of the failure to open the cycles, if unavailable
+    int GetError() const { return error; }
+
+    void Start();
+    void Stop();
+    // Since the last Start, scaled up if the kernel multiplexed the group
+    Values Read() const;
+};
+
+
+inline
+PerfCounters::
+PerfCounters()
+{
+    descriptors.fill(-1);
+    positions.fill(-1);
+#if defined(__linux__)
+    struct Event
+    {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+    const Event events[CounterCount]{
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    for (int counter = 0; counter < CounterCount; counter++)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = events[counter].type;
+        attributes.config = events[counter].config;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        // the whole group follows its leader, the cycles
+        attributes.disabled = counter == Cycles ? 1 : 0;
+
+        const int leader{ descriptors[Cycles] };
+        const int descriptor{ static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0)) };
+        if (descriptor < 0)
+        {
+            if (counter == Cycles)
+            {
+                error = errno;
+                return;
+            }
+            continue;
+        }
+        descriptors[counter] = descriptor;
+        positions[counter] = members++;
+    }
+#else
+    error = -1;
+#endif
+}
+
+inline
+PerfCounters::
+~PerfCounters()
+{
+#if defined(__linux__)
+    for (const int descriptor : descriptors)
+        if (descriptor >= 0)
+            ::close(descriptor);
+#endif
+}
+
+inline const char*
+PerfCounters::
+GetName(const Counter counter)
+{
+    static const char* const names[CounterCount]{ "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+    return names[counter];
+}
+
+inline void
+PerfCounters::
+Start()
+{
+#if defined(__linux__)
+    if (!this->IsAvailable())
+        return;
+    ::ioctl(descriptors[Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(descriptors[Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+inline void
+PerfCounters::
+Stop()
+{
+#if defined(__linux__)
+    if (!this->IsAvailable())
+        return;
+    ::ioctl(descriptors[Cycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+inline PerfCounters::Values
+PerfCounters::
+Read() const
+{
+    Values result{};
+#if defined(__linux__)
+    if (!this->IsAvailable())
+        return result;
+
+    // number of counters, time enabled, time running, then the counters
+    std::uint64_t buffer[3 + CounterCount];
+    if (::read(descriptors[Cycles], buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t)))
+        return result;
+    const double enabled{ static_cast<double>(buffer[1]) };
+    const double running{ static_cast<double>(buffer[2]) };
+    if (running <= 0.0)
+        return result;
+    for (int counter = 0; counter < CounterCount; counter++)
+        if (positions[counter] >= 0 && positions[counter] < static_cast<int>(buffer[0]))
+            result[counter] = static_cast<double>(buffer[3 + positions[counter]]) * enabled / running;
+#endif
+    return result;
+}
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# Compile-time benchmark of the square-matrix algorithms
+#
+# Compiles one translation unit per size N, instantiating `Inverse` (double)
+# and `AdjointMatrix` (long long) on (N x N) matrices, against the headers of
+# a git revision ("before") and against the working tree ("after"),
+# then reports the compile time and the object size of both.
+#
+# usage:
+#   python3 Benchmark/compile_time.py --before REV [--cxx COMPILER]
+#       [--flags FLAGS] [--sizes 2-8] [--repeat COUNT]
+#
+# REV is the revision to compare against, e.g. the parent of the commit
+# which rewrote ForLoop_t and AdjointMatrix. COMPILER is a GCC/Clang-like
+# driver (default: $CXX, then g++) or MSVC's cl.
+#
+# The headers before that commit declare the explicit specializations of
+# MetaMath::Zero `static`, which only MSVC accepts; so that GCC and Clang
+# can compile them, `static` is dropped from those declarations in the
+# exported headers (see drop_static_specializations).
+
+import argparse
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HEADER_DIR = "Matrix"
+
+SOURCE = """#include "Matrix.h"
+
+MatrixMath::MatrixQ<double, {n}> invert(const MatrixMath::MatrixQ<double, {n}>& matrix)
+{{
+    return MatrixMath::Inverse(matrix);
+}}
+
+MatrixMath::MatrixQ<long long, {n}> adjoint(const MatrixMath::MatrixQ<long long, {n}>& matrix)
+{{
+    return MatrixMath::AdjointMatrix(matrix);
+}}
+"""
+
+
+def drop_static_specializations(content):
+    # "explicit template specialization cannot have a storage class"
+    return content.replace(b"template <> constexpr static", b"template <> constexpr")
+
+
+def export_headers(revision, destination):
+    names = subprocess.check_output(
+        ["git", "ls-tree", "--name-only", revision, HEADER_DIR + "/"], cwd=ROOT, text=True).split()
+    for name in names:
+        if name.endswith(".h"):
+            content = drop_static_specializations(
+                subprocess.check_output(["git", "show", revision + ":" + name], cwd=ROOT))
+            with open(os.path.join(destination, os.path.basename(name)), "wb") as file:
+                file.write(content)
+
+
+def compile_command(cxx, flags, include, source, output):
+    if os.path.basename(cxx).lower().startswith("cl"):
+        return [cxx, "/nologo", "/c", "/I" + include, "/Fo" + output, source] + flags
+    return [cxx, "-c", "-I" + include, source, "-o", output] + flags
+
+
+def measure(cxx, flags, include, n, workdir, repeat):
+    source = os.path.join(workdir, "adjoint_{}.cpp".format(n))
+    output = os.path.join(workdir, "adjoint_{}.o".format(n))
+    with open(source, "w") as file:
+        file.write(SOURCE.format(n=n))
+
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        result = subprocess.run(compile_command(cxx, flags, include, source, output),
+            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        elapsed = time.perf_counter() - start
+        if result.returncode != 0:
+            return None, None, result.stdout.strip().splitlines()[:3]
+        best = elapsed if best is None else min(best, elapsed)
+    return best, os.path.getsize(output), None
+
+
+def parse_sizes(text):
+    first, _, last = text.partition("-")
+    return range(int(first), int(last or first) + 1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile-time benchmark of the square-matrix algorithms")
+    parser.add_argument("--before", required=True, help="git revision to compare against")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    parser.add_argument("--flags", default="-std=c++17 -O2")
+    parser.add_argument("--sizes", default="2-8")
+    parser.add_argument("--repeat", type=int, default=1)
+    args = parser.parse_args()
+    flags = shlex.split(args.flags)
+
+    with tempfile.TemporaryDirectory() as workdir:
+        before = os.path.join(workdir, "before")
+        os.mkdir(before)
+        export_headers(args.before, before)
+        after = os.path.join(ROOT, HEADER_DIR)
+
+        print("{:>2} | {:>10} {:>10} | {:>10} {:>10}".format(
+            "N", "before (s)", "after (s)", "before (KB)", "after (KB)"))
+        for n in parse_sizes(args.sizes):
+            row = [n]
+            for include in (before, after):
+                seconds, size, errors = measure(args.cxx, flags, include, n, workdir, args.repeat)
+                if errors:
+                    print("N = {}: compilation failed with {}".format(n, include), file=sys.stderr)
+                    print("\n".join(errors), file=sys.stderr)
+                row.append(seconds)
+                row.append(size)
+            print("{:>2} | {:>10} {:>10} | {:>10} {:>10}".format(
+                row[0],
+                "-" if row[1] is None else "{:.2f}".format(row[1]),
+                "-" if row[3] is None else "{:.2f}".format(row[3]),
+                "-" if row[2] is None else "{:.1f}".format(row[2] / 1024),
+                "-" if row[4] is None else "{:.1f}".format(row[4] / 1024)))
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
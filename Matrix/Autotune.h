@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "Distributed.h"
+#include "DynamicMatrix.h"
+#include "Kernel.h"
+#include "Tuning.h"
+
+namespace MatrixMath
+{
+    struct AutotuneOptions
+    {
+        // edge lengths of the square matrices of double timed
+        int multiplySize{ 384 };
+        int transposeSize{ 1024 };
+        int luSize{ 512 };
+        // runs of every candidate, the fastest of which counts
+        int repetitions{ 3 };
+        // one line per candidate, if not null
+        std::ostream* pLog{ nullptr };
+    };
+
+    // Time the candidate block sizes and unroll factors of the GEMM kernel,
+    // of the transpositions and of the blocked LU factorization on this
+    // machine, one group of parameters after another, the later groups
+    // running with the winners of the earlier ones. The winners stay
+    // in use, and are returned to be saved with SaveTuning
+    TuningParameters Autotune(const AutotuneOptions& options = AutotuneOptions{});
+}
+
+namespace detail
+{
+    // The fastest of `repetitions` runs of `run`, in seconds,
+    // each of them after an untimed `setup`
+    template <typename _Setup, typename _Run>
+    double TimeFastest(const int repetitions, _Setup&& setup, _Run&& run)
+    {
+        double fastest{ std::numeric_limits<double>::max() };
+        for (int repetition = 0; repetition < std::max(repetitions, 1); repetition++)
+        {
+            setup();
+            const auto start{ std::chrono::steady_clock::now() };
+            run();
+            const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+            fastest = std::min(fastest, elapsed.count());
+        }
+        return fastest;
+    }
+
+    // Set `parameter` of the tuning to every candidate in turn,
+    // keep the fastest one according to `time`
+    template <typename _Time>
+    void TuneParameter(MatrixMath::TuningParameters& tuning, int MatrixMath::TuningParameters::* parameter,
+        const char* name, const std::initializer_list<int> candidates, std::ostream* pLog, _Time&& time)
+    {
+        double fastest{ std::numeric_limits<double>::max() };
+        int best{ tuning.*parameter };
+        for (const int candidate : candidates)
+        {
+            MatrixMath::TuningParameters trial{ tuning };
+            trial.*parameter = candidate;
+            if (MatrixMath::SetTuning(trial) != std::errc{})
+                continue;
+
+            const double seconds{ time() };
+            if (pLog != nullptr)
+                *pLog << name << " = " << candidate << ": " << seconds * 1e3 << " ms\n";
+            if (seconds < fastest)
+            {
+                fastest = seconds;
+                best = candidate;
+            }
+        }
+        tuning.*parameter = best;
+        MatrixMath::SetTuning(tuning);
+    }
+}
+
+
+inline MatrixMath::TuningParameters
+MatrixMath::
+Autotune(const AutotuneOptions& options)
+{
+    TuningParameters tuning{ GetTuning() };
+    std::mt19937 engine{ 42 };
+    std::uniform_real_distribution<double> distribution{ -1.0, 1.0 };
+    const auto random = [&](const std::size_t count) {
+        std::vector<double> entries(count);
+        for (double& entry : entries)
+            entry = distribution(engine);
+        return entries;
+    };
+
+    // GEMM: first the rows in registers, then the blocks of B
+    {
+        const int n{ options.multiplySize };
+        const std::vector<double> a{ random(static_cast<std::size_t>(n) * n) };
+        const std::vector<double> b{ random(static_cast<std::size_t>(n) * n) };
+        std::vector<double> c(static_cast<std::size_t>(n) * n);
+        const auto time = [&] {
+            return detail::TimeFastest(options.repetitions,
+                [&] { std::fill(c.begin(), c.end(), 0.0); },
+                [&] { detail::MultiplyAddBlock(a.data(), n, b.data(), n, c.data(), n, n, n, n); });
+        };
+        detail::TuneParameter(tuning, &TuningParameters::multiplyRows, "multiply.rows", { 1, 2, 4, 8 }, options.pLog, time);
+        detail::TuneParameter(tuning, &TuningParameters::multiplyDepth, "multiply.depth", { 64, 128, 256, 512 }, options.pLog, time);
+        detail::TuneParameter(tuning, &TuningParameters::multiplyWidth, "multiply.width", { 64, 128, 256, 512, 1024 }, options.pLog, time);
+    }
+
+    // transpositions, out of place then in place
+    {
+        const int n{ options.transposeSize };
+        const std::vector<double> source{ random(static_cast<std::size_t>(n) * n) };
+        std::vector<double> target(source.size());
+        const auto time = [&] {
+            return detail::TimeFastest(options.repetitions, [] {}, [&] {
+                detail::TransposeBlock(source.data(), n, target.data(), n, n, n);
+                detail::TransposeSquareInPlace(target.data(), n, n);
+            });
+        };
+        detail::TuneParameter(tuning, &TuningParameters::transposeLeaf, "transpose.leaf", { 8, 16, 32, 64, 128 }, options.pLog, time);
+    }
+
+    // LU on a single process, the panel width being the block size
+    {
+        const int n{ options.luSize };
+        DynamicMatrix<double> matrix(n, n);
+        const std::vector<double> entries{ random(static_cast<std::size_t>(n) * n) };
+        for (int row = 0; row < n; row++)
+            for (int column = 0; column < n; column++)
+                matrix.GetElement(row, column) = entries[static_cast<std::size_t>(row) * n + column];
+
+        SingleProcessTransport transport;
+        const ProcessGrid grid{ ProcessGrid::Square(transport) };
+        const auto time = [&] {
+            DistributedMatrix<double> distributed(transport, grid, n, n);
+            std::vector<int> pivots;
+            return detail::TimeFastest(options.repetitions,
+                [&] { distributed.Scatter(matrix, 0); },
+                [&] { DecomposeLU(distributed, pivots); });
+        };
+        detail::TuneParameter(tuning, &TuningParameters::luBlock, "lu.block", { 16, 32, 48, 64, 96, 128, 192 }, options.pLog, time);
+    }
+
+    return tuning;
+}
@@ -0,0 +1,540 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "DynamicMatrix.h"
+#include "Format.h"
+#include "Kernel.h"
+#include "MappedFile.h"
+#include "Matrix.h"
+
+namespace MatrixMath
+{
+    // Type of the entries stored in a binary matrix file
+    enum class ElementCode : std::uint8_t
+    {
+        Unknown = 0,
+        Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64,
+        Float32, Float64,
+    };
+
+    // Binary matrix file, version 1:
+    //
+    //   [0, 64)                    this header
+    //   [64, dataOffset)           zero padding up to `alignment`
+    //   [dataOffset, +dataSize)    the entries in `order`, without gaps
+    //
+    // Every field is written in the byte order of the writer,
+    // which `byteOrder` (0x0102) tells the readers
+    struct BinaryHeader
+    {
+        constexpr static char Magic[4]{ 'M', 'T', 'R', 'X' };
+        constexpr static std::uint16_t Version{ 1 };
+        constexpr static std::uint16_t ByteOrderMark{ 0x0102 };
+
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t byteOrder;
+        ElementCode elementCode;
+        std::uint8_t elementSize;
+        // 0: row-major, 1: column-major
+        std::uint8_t order;
+        std::uint8_t reserved0;
+        // of the entries within the file, a power of two
+        std::uint32_t alignment;
+        std::uint32_t height;
+        std::uint32_t width;
+        std::uint64_t dataOffset;
+        std::uint64_t dataSize;
+        // CRC-32C of the entries
+        std::uint32_t dataChecksum;
+        std::uint8_t reserved1[16];
+        // CRC-32C of the 60 bytes before
+        std::uint32_t headerChecksum;
+    };
+    static_assert(sizeof(BinaryHeader) == 64, "BinaryHeader must be packed into 64 bytes!");
+    static_assert(std::is_trivially_copyable_v<BinaryHeader>, "BinaryHeader must be trivially copyable!");
+
+    struct BinaryOptions
+    {
+        // of the entries within the file; at least 64
+        std::uint32_t alignment{ 64 };
+        // entries not stored contiguously are written through a buffer of this size
+        std::size_t bufferSize{ 1 << 16 };
+    };
+
+    // Errors:
+    // - std::errc::io_error: the stream failed
+    // - std::errc::invalid_argument: bad alignment
+    template <typename MatrixType>
+    std::errc WriteBinary(std::ostream& stream, const MatrixType& matrix, const BinaryOptions& options = {});
+
+    template <typename MatrixType>
+    std::errc SaveBinary(const char* path, const MatrixType& matrix, const BinaryOptions& options = {});
+
+    // Binary matrix file mapped into memory. Opening it reads the header
+    // only; the entries are paged in when they are used, and their checksum
+    // is computed the first time `Verify` is called.
+    // The mapping is copy-on-write, so the views may be modified
+    // without changing the file
+    class BinaryFile
+    {
+    private:
+        std::shared_ptr<const MappedFile> pFile;
+        BinaryHeader header{};
+        std::errc error{};
+        // written by another machine
+        bool isSwapped{ false };
+        // 0: not verified yet, 1: valid, 2: corrupted
+        mutable unsigned char checksumState{ 0 };
+
+    public:
+        BinaryFile() = default;
+        // Errors, reported by `GetError`:
+        // - those of the file system
+        // - std::errc::illegal_byte_sequence: not a matrix file, or corrupted header
+        // - std::errc::not_supported: unknown version
+        explicit BinaryFile(const char* path);
+
+        inline bool IsOpen() const;
+        inline std::errc GetError() const;
+        inline const BinaryHeader& GetHeader() const;
+        inline int GetHeight() const;
+        inline int GetWidth() const;
+
+        // Whether the entries match their checksum;
+        // reads the whole data the first time only
+        bool Verify() const;
+
+        // Matrix pointing into the mapped pages, sharing their ownership,
+        // which requires the same element type, storage order and byte order
+        // (std::errc::not_supported otherwise) and, for fixed-size matrices,
+        // the same dimensions (std::errc::invalid_argument otherwise);
+        // an empty or zero matrix on errors
+        template <typename MatrixType>
+        MatrixType View(std::errc& ec) const;
+
+        // Copy the entries, converting the storage order and the byte order;
+        // dynamic matrices are resized, fixed-size ones must have the dimensions
+        template <typename MatrixType>
+        std::errc Load(MatrixType& matrix) const;
+
+    private:
+        template <typename _Ty>
+        std::errc checkType() const;
+
+        template <typename _Ty>
+        _Ty* entries() const;
+
+        template <typename _Ty>
+        _Ty readEntry(const int row, const int column) const;
+    };
+
+    // A view when possible, a copy otherwise;
+    // `verify` checks the entries first (std::errc::illegal_byte_sequence)
+    template <typename MatrixType>
+    MatrixType LoadBinary(const char* path, std::errc& ec, const bool verify = false);
+}
+
+namespace detail
+{
+    template <typename _Ty>
+    constexpr MatrixMath::ElementCode ElementCodeOf()
+    {
+        using MatrixMath::ElementCode;
+        if constexpr (std::is_same_v<_Ty, float> && sizeof(float) == 4)
+            return ElementCode::Float32;
+        else if constexpr (std::is_same_v<_Ty, double> && sizeof(double) == 8)
+            return ElementCode::Float64;
+        else if constexpr (std::is_integral_v<_Ty> && !std::is_same_v<_Ty, bool>)
+        {
+            constexpr bool isSigned{ std::is_signed_v<_Ty> };
+            switch (sizeof(_Ty))
+            {
+            case 1: return isSigned ? ElementCode::Int8 : ElementCode::UInt8;
+            case 2: return isSigned ? ElementCode::Int16 : ElementCode::UInt16;
+            case 4: return isSigned ? ElementCode::Int32 : ElementCode::UInt32;
+            case 8: return isSigned ? ElementCode::Int64 : ElementCode::UInt64;
+            default: return ElementCode::Unknown;
+            }
+        }
+        else
+            return ElementCode::Unknown;
+    }
+
+    inline void ByteSwap(void* value, const std::size_t size)
+    {
+        unsigned char* bytes{ static_cast<unsigned char*>(value) };
+        std::reverse(bytes, bytes + size);
+    }
+
+    inline void ByteSwapHeader(MatrixMath::BinaryHeader& header)
+    {
+        ByteSwap(&header.version, sizeof(header.version));
+        ByteSwap(&header.byteOrder, sizeof(header.byteOrder));
+        ByteSwap(&header.alignment, sizeof(header.alignment));
+        ByteSwap(&header.height, sizeof(header.height));
+        ByteSwap(&header.width, sizeof(header.width));
+        ByteSwap(&header.dataOffset, sizeof(header.dataOffset));
+        ByteSwap(&header.dataSize, sizeof(header.dataSize));
+        ByteSwap(&header.dataChecksum, sizeof(header.dataChecksum));
+        ByteSwap(&header.headerChecksum, sizeof(header.headerChecksum));
+    }
+
+    constexpr std::size_t BinaryHeaderChecksumSize{ offsetof(MatrixMath::BinaryHeader, headerChecksum) };
+
+    // Entries of a matrix stored contiguously in its storage order, or null
+    template <typename _Ty, int Height, int Width, typename order>
+    const _Ty* ContiguousEntries(const MatrixMath::Matrix<_Ty, Height, Width, order>& matrix)
+    {
+        return matrix.IsTransposed() ? nullptr : matrix.GetData().data();
+    }
+
+    template <typename _Ty, typename order>
+    const _Ty* ContiguousEntries(const MatrixMath::DynamicMatrix<_Ty, order>& matrix)
+    {
+        return matrix.GetData();
+    }
+
+    // Visit the entries of the matrix in its storage order
+    template <typename MatrixType, typename _Fn>
+    void ForEachStoredEntry(const MatrixType& matrix, _Fn&& fn)
+    {
+        const int height{ FormatHeight(matrix) };
+        const int width{ FormatWidth(matrix) };
+        if constexpr (MatrixType::OrderType::IsRowMajor())
+        {
+            for (int row = 0; row < height; row++)
+                for (int column = 0; column < width; column++)
+                    fn(matrix.GetElement(row, column));
+        }
+        else
+        {
+            for (int column = 0; column < width; column++)
+                for (int row = 0; row < height; row++)
+                    fn(matrix.GetElement(row, column));
+        }
+    }
+}
+
+
+template <typename MatrixType>
+std::errc
+MatrixMath::
+WriteBinary(std::ostream& stream, const MatrixType& matrix, const BinaryOptions& options)
+{
+    using _Ty = std::remove_cv_t<std::remove_reference_t<decltype(matrix.GetElement(0, 0))>>;
+    static_assert(detail::ElementCodeOf<_Ty>() != ElementCode::Unknown, "Element type cannot be stored in binary files!");
+
+    const std::uint32_t alignment{ options.alignment };
+    if (alignment < sizeof(BinaryHeader) || (alignment & (alignment - 1)) != 0)
+        return std::errc::invalid_argument;
+
+    const int height{ detail::FormatHeight(matrix) };
+    const int width{ detail::FormatWidth(matrix) };
+    const std::size_t count{ static_cast<std::size_t>(height) * width };
+    const _Ty* const contiguous{ detail::ContiguousEntries(matrix) };
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BinaryHeader::Magic, sizeof(header.magic));
+    header.version = BinaryHeader::Version;
+    header.byteOrder = BinaryHeader::ByteOrderMark;
+    header.elementCode = detail::ElementCodeOf<_Ty>();
+    header.elementSize = static_cast<std::uint8_t>(sizeof(_Ty));
+    header.order = MatrixType::OrderType::IsRowMajor() ? 0 : 1;
+    header.alignment = alignment;
+    header.height = static_cast<std::uint32_t>(height);
+    header.width = static_cast<std::uint32_t>(width);
+    header.dataOffset = alignment;
+    header.dataSize = count * sizeof(_Ty);
+
+    // the checksum goes first in the file, so the entries are read twice;
+    // both passes run through memory, the second one into the stream
+    if (contiguous != nullptr)
+        header.dataChecksum = detail::Crc32c(contiguous, header.dataSize);
+    else
+    {
+        std::uint32_t crc{ 0 };
+        detail::ForEachStoredEntry(matrix, [&crc](const _Ty& value) {
+            crc = detail::Crc32c(&value, sizeof(_Ty), crc);
+        });
+        header.dataChecksum = crc;
+    }
+    header.headerChecksum = detail::Crc32c(&header, detail::BinaryHeaderChecksumSize);
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const std::vector<char> padding(alignment - sizeof(header), '\0');
+    stream.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+    if (contiguous != nullptr)
+        stream.write(reinterpret_cast<const char*>(contiguous), static_cast<std::streamsize>(header.dataSize));
+    else
+    {
+        const std::size_t capacity{ std::max<std::size_t>(options.bufferSize / sizeof(_Ty), 1) };
+        std::vector<_Ty> buffer;
+        buffer.reserve(capacity);
+        auto flush = [&stream, &buffer]() {
+            stream.write(reinterpret_cast<const char*>(buffer.data()),
+                static_cast<std::streamsize>(buffer.size() * sizeof(_Ty)));
+            buffer.clear();
+        };
+        detail::ForEachStoredEntry(matrix, [&buffer, &flush, capacity](const _Ty& value) {
+            buffer.push_back(value);
+            if (buffer.size() == capacity)
+                flush();
+        });
+        flush();
+    }
+    return stream ? std::errc{} : std::errc::io_error;
+}
+
+template <typename MatrixType>
+std::errc
+MatrixMath::
+SaveBinary(const char* path, const MatrixType& matrix, const BinaryOptions& options)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        return std::errc::permission_denied;
+    const std::errc ec{ WriteBinary(stream, matrix, options) };
+    stream.close();
+    if (ec == std::errc{} && !stream)
+        return std::errc::io_error;
+    return ec;
+}
+
+inline
+MatrixMath::BinaryFile::
+BinaryFile(const char* path)
+{
+    auto pMapped{ std::make_shared<MappedFile>(path, MappedFile::Access::CopyOnWrite) };
+    if (!pMapped->IsOpen())
+    {
+        error = pMapped->GetError();
+        return;
+    }
+    if (pMapped->GetSize() < sizeof(BinaryHeader))
+    {
+        error = std::errc::illegal_byte_sequence;
+        return;
+    }
+
+    std::memcpy(&header, pMapped->GetData(), sizeof(header));
+    if (std::memcmp(header.magic, BinaryHeader::Magic, sizeof(header.magic)) != 0)
+    {
+        error = std::errc::illegal_byte_sequence;
+        return;
+    }
+    // the checksum covers the bytes as they are in the file
+    const std::uint32_t checksum{ detail::Crc32c(&header, detail::BinaryHeaderChecksumSize) };
+    isSwapped = header.byteOrder != BinaryHeader::ByteOrderMark;
+    if (isSwapped)
+        detail::ByteSwapHeader(header);
+
+    const std::uint64_t count{ static_cast<std::uint64_t>(header.height) * header.width };
+    if (header.headerChecksum != checksum || header.byteOrder != BinaryHeader::ByteOrderMark
+        || header.height > static_cast<std::uint32_t>(1 << 30) || header.width > static_cast<std::uint32_t>(1 << 30)
+        || header.dataSize != count * header.elementSize
+        // the alignments WriteBinary accepts, checked before the modulo
+        || header.alignment < sizeof(BinaryHeader) || (header.alignment & (header.alignment - 1)) != 0
+        || header.dataOffset < sizeof(BinaryHeader) || header.dataOffset % header.alignment != 0
+        || header.dataOffset > pMapped->GetSize() || header.dataSize > pMapped->GetSize() - header.dataOffset)
+    {
+        error = std::errc::illegal_byte_sequence;
+        return;
+    }
+    if (header.version != BinaryHeader::Version)
+    {
+        error = std::errc::not_supported;
+        return;
+    }
+    pFile = std::move(pMapped);
+}
+
+inline bool
+MatrixMath::BinaryFile::
+IsOpen() const
+{
+    return error == std::errc{} && pFile != nullptr;
+}
+
+inline std::errc
+MatrixMath::BinaryFile::
+GetError() const
+{
+    return error;
+}
+
+inline const MatrixMath::BinaryHeader&
+MatrixMath::BinaryFile::
+GetHeader() const
+{
+    return header;
+}
+
+inline int
+MatrixMath::BinaryFile::
+GetHeight() const
+{
+    return static_cast<int>(header.height);
+}
+
+inline int
+MatrixMath::BinaryFile::
+GetWidth() const
+{
+    return static_cast<int>(header.width);
+}
+
+inline bool
+MatrixMath::BinaryFile::
+Verify() const
+{
+    if (!this->IsOpen())
+        return false;
+    if (checksumState == 0)
+    {
+        const std::uint32_t checksum{ detail::Crc32c(pFile->GetData() + header.dataOffset,
+            static_cast<std::size_t>(header.dataSize)) };
+        checksumState = checksum == header.dataChecksum ? 1 : 2;
+    }
+    return checksumState == 1;
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::BinaryFile::
+checkType() const
+{
+    if (!this->IsOpen())
+        return error == std::errc{} ? std::errc::bad_file_descriptor : error;
+    if (header.elementCode != detail::ElementCodeOf<_Ty>() || header.elementSize != sizeof(_Ty))
+        return std::errc::invalid_argument;
+    return std::errc{};
+}
+
+template <typename _Ty>
+_Ty*
+MatrixMath::BinaryFile::
+entries() const
+{
+    // aligned, as the mapping starts at a page boundary
+    return reinterpret_cast<_Ty*>(pFile->GetWritableData() + header.dataOffset);
+}
+
+template <typename _Ty>
+_Ty
+MatrixMath::BinaryFile::
+readEntry(const int row, const int column) const
+{
+    const std::size_t index{ header.order == 0
+        ? static_cast<std::size_t>(column) + static_cast<std::size_t>(row) * header.width
+        : static_cast<std::size_t>(row) + static_cast<std::size_t>(column) * header.height };
+    _Ty value;
+    std::memcpy(&value, pFile->GetData() + header.dataOffset + index * sizeof(_Ty), sizeof(_Ty));
+    if (isSwapped)
+        detail::ByteSwap(&value, sizeof(_Ty));
+    return value;
+}
+
+template <typename MatrixType>
+MatrixType
+MatrixMath::BinaryFile::
+View(std::errc& ec) const
+{
+    using _Ty = typename MatrixType::ElementType;
+    using order = typename MatrixType::OrderType;
+
+    ec = this->checkType<_Ty>();
+    if (ec != std::errc{})
+        return MatrixType();
+    if constexpr (detail::HasStaticExtent<MatrixType>::value)
+    {
+        if (this->GetHeight() != MatrixType::Height || this->GetWidth() != MatrixType::Width)
+        {
+            ec = std::errc::invalid_argument;
+            return MatrixType();
+        }
+    }
+    // overlaying needs the entries aligned for _Ty, left to Load otherwise
+    if (isSwapped || header.order != (order::IsRowMajor() ? 0 : 1) || header.dataOffset % alignof(_Ty) != 0)
+    {
+        ec = std::errc::not_supported;
+        return MatrixType();
+    }
+
+    if constexpr (detail::HasStaticExtent<MatrixType>::value)
+    {
+        // std::array holds exactly its elements, so it can overlay the entries
+        const typename MatrixType::data_ptr_t pData(pFile,
+            reinterpret_cast<typename MatrixType::DataType::data_t*>(this->entries<_Ty>()));
+        return MatrixType(pData, false);
+    }
+    else
+    {
+        const typename MatrixType::data_ptr_t pData(pFile, this->entries<_Ty>());
+        return MatrixType(this->GetHeight(), this->GetWidth(), pData);
+    }
+}
+
+template <typename MatrixType>
+std::errc
+MatrixMath::BinaryFile::
+Load(MatrixType& matrix) const
+{
+    using _Ty = typename MatrixType::ElementType;
+    using order = typename MatrixType::OrderType;
+
+    if (const std::errc ec{ this->checkType<_Ty>() }; ec != std::errc{})
+        return ec;
+    if constexpr (detail::HasStaticExtent<MatrixType>::value)
+    {
+        if (this->GetHeight() != MatrixType::Height || this->GetWidth() != MatrixType::Width)
+            return std::errc::invalid_argument;
+    }
+    else
+        matrix.Resize(this->GetHeight(), this->GetWidth());
+
+    _Ty* const contiguous{ const_cast<_Ty*>(detail::ContiguousEntries(matrix)) };
+    if (contiguous != nullptr && !isSwapped && header.order == (order::IsRowMajor() ? 0 : 1))
+        std::memcpy(contiguous, pFile->GetData() + header.dataOffset, static_cast<std::size_t>(header.dataSize));
+    else
+    {
+        for (int row = 0; row < this->GetHeight(); row++)
+            for (int column = 0; column < this->GetWidth(); column++)
+                matrix.SetElement(row, column, this->readEntry<_Ty>(row, column));
+    }
+    return std::errc{};
+}
+
+template <typename MatrixType>
+MatrixType
+MatrixMath::
+LoadBinary(const char* path, std::errc& ec, const bool verify)
+{
+    const BinaryFile file(path);
+    ec = file.GetError();
+    if (!file.IsOpen())
+        return MatrixType();
+    if (verify && !file.Verify())
+    {
+        ec = std::errc::illegal_byte_sequence;
+        return MatrixType();
+    }
+
+    MatrixType view{ file.View<MatrixType>(ec) };
+    if (ec != std::errc::not_supported)
+        return view;
+    MatrixType copy;
+    ec = file.Load(copy);
+    return copy;
+}
@@ -0,0 +1,408 @@
+#pragma once
+
+#include "Matrix.h"
+
+namespace MatrixMath
+{
+    // Partitioned matrix made of (BlockRows x BlockColumns) blocks,
+    // each of which is a (BlockHeight x BlockWidth) matrix.
+    //
+    // A newly created block matrix stores all its blocks contiguously
+    // in one data container; blocks can also be borrowed from other
+    // matrices, in which case no entry is copied.
+    template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+    class BlockMatrix
+    {
+        static_assert(BlockRows > 0, "Template argument 'BlockRows' has negative value!");
+        static_assert(BlockColumns > 0, "Template argument 'BlockColumns' has negative value!");
+
+    public:
+        using ElementType = _Ty;
+        using OrderType = order;
+        using BlockType = Matrix<_Ty, BlockHeight, BlockWidth, order>;
+        using Transposed = BlockMatrix<_Ty, BlockWidth, BlockHeight, BlockColumns, BlockRows, order>;
+        using data_ptr_t = typename BlockType::data_ptr_t;
+
+        constexpr static int Height{ BlockHeight * BlockRows };
+        constexpr static int Width{ BlockWidth * BlockColumns };
+        constexpr static int Count{ BlockRows * BlockColumns };
+
+    private:
+        using data_t = typename BlockType::data_t;
+
+        std::array<data_ptr_t, Count> pBlocks;
+        std::array<bool, Count> transposed;
+
+        inline static int convert2index(const int row, const int column);
+
+    public:
+        BlockMatrix();
+        // Create a block matrix without any data container;
+        // every block must be set by `SetBlock` before use
+        explicit BlockMatrix(std::nullptr_t);
+        BlockMatrix(const BlockMatrix& other);
+        BlockMatrix(BlockMatrix&& other) = default;
+
+        // Access blocks
+
+        // The returned matrix shares the data container of the block
+        BlockType GetBlock(const int row, const int column) const;
+        // Borrow the data container of `block`, nothing is copied
+        void SetBlock(const int row, const int column, const BlockType& block);
+        // Copy the entries of `block` into the data container of the block,
+        // which the matrices sharing it see
+        void AssignBlock(const int row, const int column, const BlockType& block);
+
+        // Access data
+
+        inline void SetElement(const int row, const int column, const _Ty& value);
+        inline const _Ty& GetElement(const int row, const int column) const;
+        inline _Ty& GetElement(const int row, const int column);
+
+        // The blocks of the result share the data containers of this matrix
+        [[nodiscard]]
+        Transposed Transpose() const;
+
+        // Always output a string representing the matrix in row-major order
+        const std::string ToString() const;
+    };
+
+    template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+    BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order> operator+(
+        const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& lhs,
+        const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& rhs);
+
+    template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+    BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order> operator-(
+        const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& lhs,
+        const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& rhs);
+
+    // multiplying (M x P) blocks of (BM x BP) and (P x N) blocks of (BP x BN),
+    // result: (M x N) blocks of (BM x BN);
+    // every product of two blocks is done by the small matrix kernels
+    template <typename _Ty, int BM, int BP, int BN, int M, int P, int N, typename order>
+    BlockMatrix<_Ty, BM, BN, M, N, order> operator*(
+        const BlockMatrix<_Ty, BM, BP, M, P, order>& lhs,
+        const BlockMatrix<_Ty, BP, BN, P, N, order>& rhs);
+
+    // Block Gauss-Jordan elimination:
+    // at the k-th step the diagonal block holds the Schur complement
+    // of the leading (k x k) blocks, which must be invertible;
+    // no pivoting among blocks is conducted
+    template <typename _Ty, int N, int R, typename order>
+    BlockMatrix<_Ty, N, N, R, R, order> Inverse(const BlockMatrix<_Ty, N, N, R, R, order>& matrix);
+
+    // Solve `matrix * X = rhs` by block Gaussian elimination and back substitution,
+    // under the same condition as `Inverse`
+    template <typename _Ty, int N, int R, int K, typename order>
+    BlockMatrix<_Ty, N, K, R, 1, order> Solve(
+        const BlockMatrix<_Ty, N, N, R, R, order>& matrix,
+        const BlockMatrix<_Ty, N, K, R, 1, order>& rhs);
+
+    // Assemble a block matrix from the given blocks, listed in row-major order,
+    // without copying any entry
+    template <int BlockRows, int BlockColumns, typename _Ty, int BlockHeight, int BlockWidth, typename order,
+        typename... _RestTypes>
+    BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order> Merge(
+        const Matrix<_Ty, BlockHeight, BlockWidth, order>& first, const _RestTypes&... rest);
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+inline int
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+convert2index(const int row, const int column)
+{
+    return column + row * BlockColumns;
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+BlockMatrix()
+{
+    // allocate all the blocks at once,
+    // every block points into the same data container
+    std::shared_ptr<std::array<data_t, Count>> pAll{ std::make_shared<std::array<data_t, Count>>() };
+    for (int index = 0; index < Count; index++)
+    {
+        this->pBlocks[index] = data_ptr_t(pAll, &(*pAll)[index]);
+        this->transposed[index] = false;
+    }
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+BlockMatrix(std::nullptr_t)
+    : pBlocks{}
+    , transposed{}
+{
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+BlockMatrix(const BlockMatrix& other)
+    : BlockMatrix()
+{
+    for (int row = 0; row < BlockRows; row++)
+        for (int column = 0; column < BlockColumns; column++)
+            this->AssignBlock(row, column, other.GetBlock(row, column));
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+typename MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::BlockType
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+GetBlock(const int row, const int column) const
+{
+    const int index{ BlockMatrix::convert2index(row, column) };
+    return BlockType{ this->pBlocks[index], this->transposed[index] };
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+void
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+SetBlock(const int row, const int column, const BlockType& block)
+{
+    const int index{ BlockMatrix::convert2index(row, column) };
+    this->pBlocks[index] = block.GetDataPointer();
+    this->transposed[index] = block.IsTransposed();
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+void
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+AssignBlock(const int row, const int column, const BlockType& block)
+{
+    const int index{ BlockMatrix::convert2index(row, column) };
+    if (this->pBlocks[index] == block.GetDataPointer())
+    {
+        if (this->transposed[index] == block.IsTransposed())
+            return;
+        // the entries would be overwritten while being read
+        this->AssignBlock(row, column, BlockType(block));
+        return;
+    }
+
+    // the container keeps the layout that the matrices sharing it
+    // (e.g. through Transpose) expect, the entries are rearranged if necessary
+    if (!this->transposed[index])
+    {
+        detail::CopyMatrixInto<order, BlockHeight, BlockWidth>(block, this->pBlocks[index]->data(), 0, 0);
+        return;
+    }
+    data_t& data{ *this->pBlocks[index] };
+    for (int i = 0; i < BlockHeight; i++)
+        for (int j = 0; j < BlockWidth; j++)
+            data[order::convert2index(BlockHeight, BlockWidth, i, j, true)] = block.GetElement(i, j);
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+inline void
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+SetElement(const int row, const int column, const _Ty& value)
+{
+    this->GetElement(row, column) = value;
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+inline const _Ty&
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+GetElement(const int row, const int column) const
+{
+    const int block{ BlockMatrix::convert2index(row / BlockHeight, column / BlockWidth) };
+    const int index{ order::convert2index(BlockHeight, BlockWidth,
+        row % BlockHeight, column % BlockWidth, this->transposed[block]) };
+    return (*this->pBlocks[block])[index];
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+inline _Ty&
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+GetElement(const int row, const int column)
+{
+    const int block{ BlockMatrix::convert2index(row / BlockHeight, column / BlockWidth) };
+    const int index{ order::convert2index(BlockHeight, BlockWidth,
+        row % BlockHeight, column % BlockWidth, this->transposed[block]) };
+    return (*this->pBlocks[block])[index];
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+typename MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::Transposed
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+Transpose() const
+{
+    Transposed result(nullptr);
+    for (int row = 0; row < BlockRows; row++)
+        for (int column = 0; column < BlockColumns; column++)
+            result.SetBlock(column, row, this->GetBlock(row, column).Transpose());
+    return result;
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+const std::string
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>::
+ToString() const
+{
+    return MatrixMath::ToString(*this);
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>
+MatrixMath::
+operator+(const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& lhs,
+    const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& rhs)
+{
+    BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order> result(lhs);
+    for (int row = 0; row < BlockRows; row++)
+    {
+        for (int column = 0; column < BlockColumns; column++)
+        {
+            auto block{ result.GetBlock(row, column) };
+            block += rhs.GetBlock(row, column);
+        }
+    }
+    return result;
+}
+
+template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns, typename order>
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>
+MatrixMath::
+operator-(const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& lhs,
+    const BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>& rhs)
+{
+    BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order> result(lhs);
+    for (int row = 0; row < BlockRows; row++)
+    {
+        for (int column = 0; column < BlockColumns; column++)
+        {
+            auto block{ result.GetBlock(row, column) };
+            block -= rhs.GetBlock(row, column);
+        }
+    }
+    return result;
+}
+
+template <typename _Ty, int BM, int BP, int BN, int M, int P, int N, typename order>
+MatrixMath::BlockMatrix<_Ty, BM, BN, M, N, order>
+MatrixMath::
+operator*(const BlockMatrix<_Ty, BM, BP, M, P, order>& lhs,
+    const BlockMatrix<_Ty, BP, BN, P, N, order>& rhs)
+{
+    BlockMatrix<_Ty, BM, BN, M, N, order> result;
+    for (int i = 0; i < M; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            // the blocks of `result` are not transposed,
+            // neither are the products of two blocks
+            auto block{ result.GetBlock(i, j) };
+            result.AssignBlock(i, j, lhs.GetBlock(i, 0) * rhs.GetBlock(0, j));
+            for (int k = 1; k < P; k++)
+                block += lhs.GetBlock(i, k) * rhs.GetBlock(k, j);
+        }
+    }
+    return result;
+}
+
+template <typename _Ty, int N, int R, typename order>
+MatrixMath::BlockMatrix<_Ty, N, N, R, R, order>
+MatrixMath::
+Inverse(const BlockMatrix<_Ty, N, N, R, R, order>& matrix)
+{
+    BlockMatrix<_Ty, N, N, R, R, order> work(matrix);
+    BlockMatrix<_Ty, N, N, R, R, order> result;
+    for (int row = 0; row < R; row++)
+        for (int column = 0; column < R; column++)
+            if (row == column)
+                result.AssignBlock(row, column, IdentityMatrix<_Ty, N, order>());
+
+    for (int k = 0; k < R; k++)
+    {
+        // scale the k-th block row by the inverse of the pivot block
+        const MatrixQ<_Ty, N, order> pivot{ MatrixMath::Inverse(work.GetBlock(k, k)) };
+        for (int j = 0; j < R; j++)
+        {
+            work.AssignBlock(k, j, pivot * work.GetBlock(k, j));
+            result.AssignBlock(k, j, pivot * result.GetBlock(k, j));
+        }
+
+        // eliminate the k-th block column from the other block rows;
+        // what remains at the diagonal is the Schur complement
+        for (int i = 0; i < R; i++)
+        {
+            if (i == k)
+                continue;
+            // copy the entries, the block itself is updated below
+            const auto block{ work.GetBlock(i, k) };
+            const MatrixQ<_Ty, N, order> factor(block);
+            for (int j = 0; j < R; j++)
+            {
+                auto workBlock{ work.GetBlock(i, j) };
+                auto resultBlock{ result.GetBlock(i, j) };
+                workBlock -= factor * work.GetBlock(k, j);
+                resultBlock -= factor * result.GetBlock(k, j);
+            }
+        }
+    }
+
+    return result;
+}
+
+template <typename _Ty, int N, int R, int K, typename order>
+MatrixMath::BlockMatrix<_Ty, N, K, R, 1, order>
+MatrixMath::
+Solve(const BlockMatrix<_Ty, N, N, R, R, order>& matrix,
+    const BlockMatrix<_Ty, N, K, R, 1, order>& rhs)
+{
+    BlockMatrix<_Ty, N, N, R, R, order> work(matrix);
+    BlockMatrix<_Ty, N, K, R, 1, order> result(rhs);
+
+    // forward elimination, leaving the inverses of the pivot blocks
+    // on the diagonal and an upper block triangle above it
+    std::vector<MatrixQ<_Ty, N, order>> pivots;
+    pivots.reserve(R);
+    for (int k = 0; k < R; k++)
+    {
+        pivots.emplace_back(MatrixMath::Inverse(work.GetBlock(k, k)));
+        const auto& pivot{ pivots.back() };
+        for (int i = k + 1; i < R; i++)
+        {
+            const MatrixQ<_Ty, N, order> factor{ work.GetBlock(i, k) * pivot };
+            for (int j = k + 1; j < R; j++)
+            {
+                auto workBlock{ work.GetBlock(i, j) };
+                workBlock -= factor * work.GetBlock(k, j);
+            }
+            auto resultBlock{ result.GetBlock(i, 0) };
+            resultBlock -= factor * result.GetBlock(k, 0);
+        }
+    }
+
+    // back substitution
+    for (int k = R - 1; k >= 0; k--)
+    {
+        auto resultBlock{ result.GetBlock(k, 0) };
+        for (int j = k + 1; j < R; j++)
+            resultBlock -= work.GetBlock(k, j) * result.GetBlock(j, 0);
+        result.AssignBlock(k, 0, pivots[k] * resultBlock);
+    }
+
+    return result;
+}
+
+template <int BlockRows, int BlockColumns, typename _Ty, int BlockHeight, int BlockWidth, typename order,
+    typename... _RestTypes>
+MatrixMath::BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order>
+MatrixMath::
+Merge(const Matrix<_Ty, BlockHeight, BlockWidth, order>& first, const _RestTypes&... rest)
+{
+    using BlockType = Matrix<_Ty, BlockHeight, BlockWidth, order>;
+    static_assert(1 + sizeof...(_RestTypes) == BlockRows * BlockColumns,
+        "Invalid argument: The number of blocks mismatches!");
+    static_assert((std::is_same_v<BlockType, _RestTypes> && ...),
+        "Invalid argument: All the blocks must be of the same type!");
+
+    BlockMatrix<_Ty, BlockHeight, BlockWidth, BlockRows, BlockColumns, order> result(nullptr);
+    int index{ 0 };
+    result.SetBlock(0, 0, first);
+    ((++index, result.SetBlock(index / BlockColumns, index % BlockColumns, rest)), ...);
+    return result;
+}
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <initializer_list>
+#include <type_traits>
+
+#include "Matrix.h"
+
+namespace MatrixMath
+{
+    // Literal matrix
+    // Stores its entries inline in row-major order, so that it can be built,
+    // combined and inverted in constant expressions, e.g. to bake constant
+    // projections and changes of basis and check them with `static_assert`;
+    // use `ToMatrix` to hand the result over to the run-time algorithms
+    template <typename _Ty, int _Height, int _Width>
+    class ConstMatrix
+    {
+    public:
+        static_assert(_Height > 0 && _Width > 0, "Invalid template argument: empty matrix!");
+
+        using ElementType = _Ty;
+        using DataType = std::array<_Ty, _Height * _Width>;
+        using Transposed = ConstMatrix<_Ty, _Width, _Height>;
+
+        constexpr static int Height{ _Height };
+        constexpr static int Width{ _Width };
+        constexpr static int Size{ _Height * _Width };
+
+    private:
+        DataType data;
+
+    public:
+        // Zero matrix
+        constexpr ConstMatrix();
+        // Entries in row-major order, the missing ones are zero
+        constexpr ConstMatrix(const std::initializer_list<_Ty>& init);
+        template <typename order>
+        explicit ConstMatrix(const Matrix<_Ty, _Height, _Width, order>& other);
+
+        constexpr static ConstMatrix Identity();
+
+        constexpr void SetElement(const int row, const int column, const _Ty& value);
+        constexpr const _Ty& GetElement(const int row, const int column) const;
+        constexpr _Ty& GetElement(const int row, const int column);
+        constexpr const DataType& GetData() const;
+
+        constexpr Transposed Transpose() const;
+
+        // Valid only if the matrix is square:
+        // exact fraction-free elimination (Bareiss) for integers,
+        // Gaussian elimination with partial pivoting otherwise
+        constexpr _Ty Determinant() const;
+        constexpr bool IsInvertible() const;
+        // Gauss-Jordan elimination with partial pivoting;
+        // meaningful only if the element type is a field, e.g. float or double.
+        // Inverting a singular matrix is not a constant expression
+        constexpr ConstMatrix Inverse() const;
+
+        template <typename order = StorageOrder::RowMajor>
+        Matrix<_Ty, _Height, _Width, order> ToMatrix() const;
+
+    private:
+        // `std::swap` is not constexpr before C++20
+        constexpr static void swapRows(DataType& entries, const int lhs, const int rhs);
+        constexpr static _Ty absolute(const _Ty& value);
+    };
+
+    template <typename _Ty, int N>
+    using ConstMatrixQ = ConstMatrix<_Ty, N, N>;
+
+    template <typename _Ty, int N>
+    using ConstVector = ConstMatrix<_Ty, N, 1>;
+
+    template <typename _Ty, int Height, int Width>
+    constexpr ConstMatrix<_Ty, Height, Width> operator+(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs);
+
+    template <typename _Ty, int Height, int Width>
+    constexpr ConstMatrix<_Ty, Height, Width> operator-(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs);
+
+    template <typename _Ty, int M, int P, int N>
+    constexpr ConstMatrix<_Ty, M, N> operator*(const ConstMatrix<_Ty, M, P>& lhs, const ConstMatrix<_Ty, P, N>& rhs);
+
+    template <typename _Ty, int Height, int Width>
+    constexpr ConstMatrix<_Ty, Height, Width> operator*(const ConstMatrix<_Ty, Height, Width>& lhs, const _Ty& rhs);
+
+    template <typename _Ty, int Height, int Width>
+    constexpr ConstMatrix<_Ty, Height, Width> operator*(const _Ty& lhs, const ConstMatrix<_Ty, Height, Width>& rhs);
+
+    template <typename _Ty, int Height, int Width>
+    constexpr bool operator==(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs);
+
+    template <typename _Ty, int Height, int Width>
+    constexpr bool operator!=(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs);
+}
+
+
+template <typename _Ty, int _Height, int _Width>
+constexpr
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+ConstMatrix()
+    : data{}
+{
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+ConstMatrix(const std::initializer_list<_Ty>& init)
+    : data{}
+{
+    int index{ 0 };
+    for (auto it = init.begin(); it != init.end() && index < Size; ++it)
+        data[index++] = *it;
+}
+
+template <typename _Ty, int _Height, int _Width>
+template <typename order>
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+ConstMatrix(const Matrix<_Ty, _Height, _Width, order>& other)
+    : data{}
+{
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            data[col + row * Width] = other.GetElement(row, col);
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr MatrixMath::ConstMatrix<_Ty, _Height, _Width>
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+Identity()
+{
+    static_assert(Height == Width, "Identity matrix must be square.");
+
+    ConstMatrix result;
+    for (int i = 0; i < Height; i++)
+        result.data[i + i * Width] = static_cast<_Ty>(1);
+    return result;
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr void
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+SetElement(const int row, const int column, const _Ty& value)
+{
+    data[column + row * Width] = value;
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr const _Ty&
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+GetElement(const int row, const int column) const
+{
+    return data[column + row * Width];
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr _Ty&
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+GetElement(const int row, const int column)
+{
+    return data[column + row * Width];
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr const typename MatrixMath::ConstMatrix<_Ty, _Height, _Width>::DataType&
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+GetData() const
+{
+    return data;
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr typename MatrixMath::ConstMatrix<_Ty, _Height, _Width>::Transposed
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+Transpose() const
+{
+    Transposed result;
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            result.SetElement(col, row, data[col + row * Width]);
+    return result;
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr void
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+swapRows(DataType& entries, const int lhs, const int rhs)
+{
+    for (int col = 0; col < Width; col++)
+    {
+        const _Ty temp{ entries[col + lhs * Width] };
+        entries[col + lhs * Width] = entries[col + rhs * Width];
+        entries[col + rhs * Width] = temp;
+    }
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr _Ty
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+absolute(const _Ty& value)
+{
+    return value < static_cast<_Ty>(0) ? -value : value;
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr _Ty
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+Determinant() const
+{
+    static_assert(Height == Width, "Determinant is defined for square matrices only.");
+    constexpr int N{ Height };
+
+    DataType a{ data };
+    _Ty result{ 1 };
+
+    if constexpr (std::is_integral_v<_Ty>)
+    {
+        // every division below is exact:
+        // a[i][j] ends up as the leading (k + 1) minor bordered by row i and column j
+        _Ty previous{ 1 };
+        for (int k = 0; k < N; k++)
+        {
+            if (a[k + k * N] == static_cast<_Ty>(0))
+            {
+                int pivot{ k + 1 };
+                while (pivot < N && a[k + pivot * N] == static_cast<_Ty>(0))
+                    ++pivot;
+                if (pivot == N)
+                    return static_cast<_Ty>(0);
+                swapRows(a, k, pivot);
+                result = -result;
+            }
+
+            for (int i = k + 1; i < N; i++)
+            {
+                for (int j = k + 1; j < N; j++)
+                    a[j + i * N] = (a[j + i * N] * a[k + k * N] - a[k + i * N] * a[j + k * N]) / previous;
+            }
+            previous = a[k + k * N];
+        }
+        return result * a[(N - 1) + (N - 1) * N];
+    }
+    else
+    {
+        for (int k = 0; k < N; k++)
+        {
+            int pivot{ k };
+            for (int i = k + 1; i < N; i++)
+                if (absolute(a[k + i * N]) > absolute(a[k + pivot * N]))
+                    pivot = i;
+            if (a[k + pivot * N] == static_cast<_Ty>(0))
+                return static_cast<_Ty>(0);
+            if (pivot != k)
+            {
+                swapRows(a, k, pivot);
+                result = -result;
+            }
+
+            const _Ty diagonal{ a[k + k * N] };
+            result *= diagonal;
+            for (int i = k + 1; i < N; i++)
+            {
+                const _Ty factor{ a[k + i * N] / diagonal };
+                for (int j = k + 1; j < N; j++)
+                    a[j + i * N] -= factor * a[j + k * N];
+            }
+        }
+        return result;
+    }
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr bool
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+IsInvertible() const
+{
+    return this->Determinant() != static_cast<_Ty>(0);
+}
+
+template <typename _Ty, int _Height, int _Width>
+constexpr MatrixMath::ConstMatrix<_Ty, _Height, _Width>
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+Inverse() const
+{
+    static_assert(Height == Width, "Inverse is defined for square matrices only.");
+    constexpr int N{ Height };
+
+    DataType a{ data };
+    DataType result{ Identity().data };
+
+    for (int k = 0; k < N; k++)
+    {
+        int pivot{ k };
+        for (int i = k + 1; i < N; i++)
+            if (absolute(a[k + i * N]) > absolute(a[k + pivot * N]))
+                pivot = i;
+        assert(a[k + pivot * N] != static_cast<_Ty>(0) && "Singular matrix!");
+        if (pivot != k)
+        {
+            swapRows(a, k, pivot);
+            swapRows(result, k, pivot);
+        }
+
+        const _Ty diagonal{ a[k + k * N] };
+        for (int j = 0; j < N; j++)
+        {
+            a[j + k * N] /= diagonal;
+            result[j + k * N] /= diagonal;
+        }
+
+        for (int i = 0; i < N; i++)
+        {
+            if (i == k)
+                continue;
+            const _Ty factor{ a[k + i * N] };
+            for (int j = 0; j < N; j++)
+            {
+                a[j + i * N] -= factor * a[j + k * N];
+                result[j + i * N] -= factor * result[j + k * N];
+            }
+        }
+    }
+
+    ConstMatrix inverse;
+    inverse.data = result;
+    return inverse;
+}
+
+template <typename _Ty, int _Height, int _Width>
+template <typename order>
+MatrixMath::Matrix<_Ty, _Height, _Width, order>
+MatrixMath::ConstMatrix<_Ty, _Height, _Width>::
+ToMatrix() const
+{
+    Matrix<_Ty, _Height, _Width, order> result;
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            result.SetElement(row, col, data[col + row * Width]);
+    return result;
+}
+
+template <typename _Ty, int Height, int Width>
+constexpr MatrixMath::ConstMatrix<_Ty, Height, Width>
+MatrixMath::
+operator+(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs)
+{
+    ConstMatrix<_Ty, Height, Width> result;
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            result.SetElement(row, col, lhs.GetElement(row, col) + rhs.GetElement(row, col));
+    return result;
+}
+
+template <typename _Ty, int Height, int Width>
+constexpr MatrixMath::ConstMatrix<_Ty, Height, Width>
+MatrixMath::
+operator-(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs)
+{
+    ConstMatrix<_Ty, Height, Width> result;
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            result.SetElement(row, col, lhs.GetElement(row, col) - rhs.GetElement(row, col));
+    return result;
+}
+
+template <typename _Ty, int M, int P, int N>
+constexpr MatrixMath::ConstMatrix<_Ty, M, N>
+MatrixMath::
+operator*(const ConstMatrix<_Ty, M, P>& lhs, const ConstMatrix<_Ty, P, N>& rhs)
+{
+    ConstMatrix<_Ty, M, N> result;
+    for (int row = 0; row < M; row++)
+    {
+        for (int col = 0; col < N; col++)
+        {
+            _Ty sum{ 0 };
+            for (int k = 0; k < P; k++)
+                sum += lhs.GetElement(row, k) * rhs.GetElement(k, col);
+            result.SetElement(row, col, sum);
+        }
+    }
+    return result;
+}
+
+template <typename _Ty, int Height, int Width>
+constexpr MatrixMath::ConstMatrix<_Ty, Height, Width>
+MatrixMath::
+operator*(const ConstMatrix<_Ty, Height, Width>& lhs, const _Ty& rhs)
+{
+    ConstMatrix<_Ty, Height, Width> result;
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            result.SetElement(row, col, lhs.GetElement(row, col) * rhs);
+    return result;
+}
+
+template <typename _Ty, int Height, int Width>
+constexpr MatrixMath::ConstMatrix<_Ty, Height, Width>
+MatrixMath::
+operator*(const _Ty& lhs, const ConstMatrix<_Ty, Height, Width>& rhs)
+{
+    return rhs * lhs;
+}
+
+template <typename _Ty, int Height, int Width>
+constexpr bool
+MatrixMath::
+operator==(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs)
+{
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            if (lhs.GetElement(row, col) != rhs.GetElement(row, col))
+                return false;
+    return true;
+}
+
+template <typename _Ty, int Height, int Width>
+constexpr bool
+MatrixMath::
+operator!=(const ConstMatrix<_Ty, Height, Width>& lhs, const ConstMatrix<_Ty, Height, Width>& rhs)
+{
+    return !(lhs == rhs);
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#   if defined(_M_X64) || defined(_M_IX86)
+#       include <immintrin.h>
+#   endif
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <cpuid.h>
+#endif
+
+// Define MATRIX_DISPATCH=0 to compile the kernels (Kernel.h) only for the
+// instruction set the compiler targets; by default on x86, they are compiled
+// for every level below, and the level of the processor is picked at run time
+#if !defined(MATRIX_DISPATCH)
+#   if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) \
+        && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#       define MATRIX_DISPATCH 1
+#   else
+#       define MATRIX_DISPATCH 0
+#   endif
+#endif
+
+// The level the compiler targets anyway, as an IsaLevel;
+// MSVC defines neither __FMA__ nor __SSE4_2__, /arch:AVX2 implies both
+#if defined(__AVX512F__)
+#   define MATRIX_BASELINE_LEVEL 4
+#elif defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#   define MATRIX_BASELINE_LEVEL 3
+#elif defined(__SSE4_2__) || (defined(_MSC_VER) && defined(__AVX__))
+#   define MATRIX_BASELINE_LEVEL 2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define MATRIX_BASELINE_LEVEL 1
+#else
+#   define MATRIX_BASELINE_LEVEL 0
+#endif
+
+namespace MatrixMath
+{
+    // Instruction set levels of the kernels, each one including the previous ones
+    enum class IsaLevel : int
+    {
+        Scalar,
+        // 128-bit packs
+        Sse2,
+        // and the CRC-32C instruction
+        Sse42,
+        // 256-bit packs, with fused multiply-add
+        Avx2,
+        // 512-bit packs
+        Avx512,
+    };
+
+    constexpr int IsaLevelCount{ 5 };
+
+    struct CpuFeatures
+    {
+        bool sse2{ false };
+        bool sse42{ false };
+        // the AVX features count only if the OS saves their registers
+        bool avx{ false };
+        bool avx2{ false };
+        bool fma{ false };
+        bool avx512f{ false };
+    };
+
+    // Detected on first use
+    const CpuFeatures& GetCpuFeatures();
+    // The brand string of the processor, "unknown" if it cannot be queried
+    const std::string& GetCpuModel();
+
+    // The highest level supported by both the processor and the build;
+    // without MATRIX_DISPATCH, the one the compiler targets
+    IsaLevel GetSupportedIsaLevel();
+    // The level of the kernels in use: the supported one, unless lowered
+    // by SetIsaLevel, or at startup by the environment variable MATRIX_ISA
+    // set to the name of a level
+    IsaLevel GetIsaLevel();
+    // Run the kernels of `level` from now on, e.g. to test every level
+    // on one machine; std::errc::not_supported above the supported level.
+    // Without MATRIX_DISPATCH, every level runs the same kernels
+    std::errc SetIsaLevel(const IsaLevel level);
+
+    // "scalar", "sse2", "sse4.2", "avx2" or "avx512"
+    const char* GetIsaName(const IsaLevel level);
+}
+
+namespace detail
+{
+    inline void Cpuid(const unsigned int leaf, const unsigned int subleaf, unsigned int (&registers)[4])
+    {
+        registers[0] = registers[1] = registers[2] = registers[3] = 0;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int values[4];
+        __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; i++)
+            registers[i] = static_cast<unsigned int>(values[i]);
+#elif defined(__x86_64__) || defined(__i386__)
+        if (leaf <= __get_cpuid_max(leaf & 0x80000000u, nullptr))
+            __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#else
+        (void)leaf;
+        (void)subleaf;
+#endif
+    }
+
+    // The register states the OS saves on context switches (XCR0)
+    inline unsigned long long SavedRegisterStates()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return _xgetbv(0);
+#elif defined(__x86_64__) || defined(__i386__)
+        unsigned int low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<unsigned long long>(high) << 32) | low;
+#else
+        return 0;
+#endif
+    }
+
+    inline MatrixMath::CpuFeatures DetectCpuFeatures()
+    {
+        MatrixMath::CpuFeatures features;
+        unsigned int basic[4];
+        Cpuid(0, 0, basic);
+        if (basic[0] < 1)
+            return features;
+
+        unsigned int leaf1[4];
+        unsigned int leaf7[4];
+        Cpuid(1, 0, leaf1);
+        Cpuid(7, 0, leaf7);
+        if (basic[0] < 7)
+            leaf7[0] = leaf7[1] = leaf7[2] = leaf7[3] = 0;
+
+        features.sse2 = (leaf1[3] >> 26 & 1) != 0;
+        features.sse42 = (leaf1[2] >> 20 & 1) != 0;
+
+        // XMM and YMM, then opmask and the upper ZMM
+        const bool isOsXsave{ (leaf1[2] >> 27 & 1) != 0 };
+        const unsigned long long states{ isOsXsave ? SavedRegisterStates() : 0 };
+        const bool isYmmSaved{ (states & 0x06) == 0x06 };
+        const bool isZmmSaved{ (states & 0xE6) == 0xE6 };
+
+        features.avx = isYmmSaved && (leaf1[2] >> 28 & 1) != 0;
+        features.fma = features.avx && (leaf1[2] >> 12 & 1) != 0;
+        features.avx2 = features.avx && (leaf7[1] >> 5 & 1) != 0;
+        features.avx512f = isZmmSaved && (leaf7[1] >> 16 & 1) != 0;
+        return features;
+    }
+
+    inline int InitialIsaLevel()
+    {
+        int level{ static_cast<int>(MatrixMath::GetSupportedIsaLevel()) };
+#if defined(_MSC_VER)
+        char* value{ nullptr };
+        std::size_t length{ 0 };
+        std::string name;
+        if (_dupenv_s(&value, &length, "MATRIX_ISA") == 0 && value != nullptr)
+            name = value;
+        std::free(value);
+#else
+        const char* value{ std::getenv("MATRIX_ISA") };
+        const std::string name{ value != nullptr ? value : "" };
+#endif
+        for (int candidate = 0; candidate < MatrixMath::IsaLevelCount; candidate++)
+            if (name == MatrixMath::GetIsaName(static_cast<MatrixMath::IsaLevel>(candidate)))
+                level = std::min(level, candidate);
+        return level;
+    }
+
+    // The level in use, read by every dispatched kernel call
+    inline std::atomic<int>& IsaLevelState()
+    {
+        static std::atomic<int> level{ InitialIsaLevel() };
+        return level;
+    }
+
+    inline int CurrentIsaLevel()
+    {
+        return IsaLevelState().load(std::memory_order_relaxed);
+    }
+}
+
+
+inline const MatrixMath::CpuFeatures&
+MatrixMath::
+GetCpuFeatures()
+{
+    static const CpuFeatures features{ detail::DetectCpuFeatures() };
+    return features;
+}
+
+inline const std::string&
+MatrixMath::
+GetCpuModel()
+{
+    static const std::string model{ [] {
+        std::string model;
+        unsigned int extended[4];
+        detail::Cpuid(0x80000000u, 0, extended);
+        if (extended[0] >= 0x80000004u)
+        {
+            for (unsigned int leaf = 0; leaf < 3; leaf++)
+            {
+                unsigned int registers[4];
+                detail::Cpuid(0x80000002u + leaf, 0, registers);
+                model.append(reinterpret_cast<const char*>(registers), sizeof(registers));
+            }
+        }
+        model.erase(model.find_last_not_of(std::string(" \0", 2)) + 1);
+        model.erase(0, model.find_first_not_of(' '));
+        return model.empty() ? std::string("unknown") : model;
+    }() };
+    return model;
+}
+
+inline MatrixMath::IsaLevel
+MatrixMath::
+GetSupportedIsaLevel()
+{
+#if MATRIX_DISPATCH
+    const CpuFeatures& features{ GetCpuFeatures() };
+    if (features.avx512f && features.avx2 && features.fma)
+        return IsaLevel::Avx512;
+    if (features.avx2 && features.fma)
+        return IsaLevel::Avx2;
+    if (features.sse42)
+        return IsaLevel::Sse42;
+    if (features.sse2)
+        return IsaLevel::Sse2;
+    return IsaLevel::Scalar;
+#else
+    return static_cast<IsaLevel>(MATRIX_BASELINE_LEVEL);
+#endif
+}
+
+inline MatrixMath::IsaLevel
+MatrixMath::
+GetIsaLevel()
+{
+    return static_cast<IsaLevel>(detail::CurrentIsaLevel());
+}
+
+inline std::errc
+MatrixMath::
+SetIsaLevel(const IsaLevel level)
+{
+    if (static_cast<int>(level) < 0 || level > GetSupportedIsaLevel())
+        return std::errc::not_supported;
+    detail::IsaLevelState().store(static_cast<int>(level), std::memory_order_relaxed);
+    return std::errc{};
+}
+
+inline const char*
+MatrixMath::
+GetIsaName(const IsaLevel level)
+{
+    switch (level)
+    {
+    case IsaLevel::Scalar:
+        return "scalar";
+    case IsaLevel::Sse2:
+        return "sse2";
+    case IsaLevel::Sse42:
+        return "sse4.2";
+    case IsaLevel::Avx2:
+        return "avx2";
+    case IsaLevel::Avx512:
+        return "avx512";
+    }
+    return "unknown";
+}
@@ -0,0 +1,1037 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#   include <cerrno>
+#   include <sys/socket.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif
+
+#include "DynamicMatrix.h"
+#include "Kernel.h"
+
+namespace MatrixMath
+{
+    // Point-to-point messages between the processes of a distributed
+    // computation, numbered from 0 to GetSize() - 1. Both calls block;
+    // the messages from one process to another arrive in the order
+    // they were sent, and are received by the call with the same tag
+    class Transport
+    {
+    public:
+        virtual ~Transport() = default;
+
+        virtual int GetRank() const = 0;
+        virtual int GetSize() const = 0;
+
+        virtual std::errc Send(const int destination, const int tag, const void* data, const std::size_t size) = 0;
+        // std::errc::message_size if the message has another size
+        virtual std::errc Receive(const int source, const int tag, void* data, const std::size_t size) = 0;
+    };
+
+#if !defined(_WIN32)
+    // Processes of one machine, every pair of them being connected
+    // by a Unix socket pair created before they were forked
+    class LocalSocketTransport
+        : public Transport
+    {
+    private:
+        struct Message
+        {
+            int source;
+            int tag;
+            std::vector<char> data;
+        };
+
+        int rank;
+        // one socket per process, -1 for this one
+        std::vector<int> sockets;
+        // received while waiting for another tag
+        std::vector<Message> pending;
+
+    public:
+        LocalSocketTransport(const int rank, std::vector<int> sockets);
+        LocalSocketTransport(const LocalSocketTransport&) = delete;
+        LocalSocketTransport& operator=(const LocalSocketTransport&) = delete;
+        ~LocalSocketTransport() override;
+
+        int GetRank() const override;
+        int GetSize() const override;
+        std::errc Send(const int destination, const int tag, const void* data, const std::size_t size) override;
+        std::errc Receive(const int source, const int tag, void* data, const std::size_t size) override;
+
+    private:
+        static std::errc readAll(const int socket, void* data, std::size_t size);
+        static std::errc writeAll(const int socket, const void* data, std::size_t size);
+    };
+#endif
+
+    // The only process of a computation, whose messages to itself
+    // are queued; e.g. to run the distributed algorithms on one core
+    class SingleProcessTransport
+        : public Transport
+    {
+    private:
+        struct Message
+        {
+            int tag;
+            std::vector<char> data;
+        };
+
+        std::vector<Message> pending;
+
+    public:
+        int GetRank() const override;
+        int GetSize() const override;
+        std::errc Send(const int destination, const int tag, const void* data, const std::size_t size) override;
+        // std::errc::resource_unavailable_try_again if no such message was sent,
+        // since it could never arrive
+        std::errc Receive(const int source, const int tag, void* data, const std::size_t size) override;
+    };
+
+    // Fork `count` processes connected by a LocalSocketTransport,
+    // each of them returning `worker(transport)` as its exit code,
+    // and wait for them; returns the first nonzero exit code, or -1
+    // if the processes could not be started (always on Windows)
+    int RunLocalProcesses(const int count, const std::function<int(Transport&)>& worker);
+
+    // Processes arranged in (Rows x Columns), row by row
+    struct ProcessGrid
+    {
+        int rows{ 1 };
+        int columns{ 1 };
+        // coordinates of this process
+        int row{ 0 };
+        int column{ 0 };
+
+        // The grid closest to a square, with no more rows than columns
+        static ProcessGrid Square(const Transport& transport);
+        static ProcessGrid Make(const Transport& transport, const int rows, const int columns);
+
+        inline int RankOf(const int row, const int column) const { return row * columns + column; }
+    };
+
+    // Matrix distributed in 2D block-cyclic layout: the (BlockSize x BlockSize)
+    // block (I, J) lives in the process (I mod Rows, J mod Columns) of the grid,
+    // which stores its blocks in one row-major DynamicMatrix, in order
+    template <typename _Ty>
+    class DistributedMatrix
+    {
+    private:
+        Transport* pTransport;
+        ProcessGrid grid;
+        int height;
+        int width;
+        int blockSize;
+        DynamicMatrix<_Ty> local;
+
+    public:
+        // Zero matrix; a `blockSize` of 0 takes the tuned one (Tuning.h)
+        DistributedMatrix(Transport& transport, const ProcessGrid& grid, const int height, const int width,
+            const int blockSize = 0);
+
+        inline Transport& GetTransport() const;
+        inline const ProcessGrid& GetGrid() const;
+        inline int GetHeight() const;
+        inline int GetWidth() const;
+        inline int GetBlockSize() const;
+
+        // The entries of this process
+        inline const DynamicMatrix<_Ty>& GetLocal() const;
+        inline DynamicMatrix<_Ty>& GetLocal();
+
+        // Process row / column owning a global row / column
+        inline int OwnerRow(const int row) const;
+        inline int OwnerColumn(const int column) const;
+        // Local index of a global row / column of this process, and back
+        inline int LocalRow(const int row) const;
+        inline int LocalColumn(const int column) const;
+        inline int GlobalRow(const int localRow) const;
+        inline int GlobalColumn(const int localColumn) const;
+        // Local rows / columns of this process whose global index is below `end`
+        inline int LocalRowsBefore(const int end) const;
+        inline int LocalColumnsBefore(const int end) const;
+
+        // Distribute a matrix held by `root`, and collect it back;
+        // `matrix` is ignored on the other processes
+        std::errc Scatter(const DynamicMatrix<_Ty>& matrix, const int root);
+        std::errc Gather(DynamicMatrix<_Ty>& matrix, const int root) const;
+
+        // Entries of `count` global indices owned by the process `owner`
+        // out of `processes`, the first ones being `blockSize` long
+        inline static int CountOwned(const int count, const int blockSize, const int owner, const int processes);
+        // Global index of the `index`-th entry of the process `owner`
+        inline static int GlobalIndex(const int index, const int blockSize, const int owner, const int processes);
+    };
+
+    // result = lhs * rhs by SUMMA: for every block column of lhs and block
+    // row of rhs, their owners broadcast them along the rows and columns
+    // of the grid, and every process accumulates their product into its
+    // blocks of the result. The three matrices must share grid and block size
+    // @see: van de Geijn, Watts. SUMMA: Scalable Universal Matrix Multiplication Algorithm. 1997
+    template <typename _Ty>
+    std::errc Multiply(const DistributedMatrix<_Ty>& lhs, const DistributedMatrix<_Ty>& rhs,
+        DistributedMatrix<_Ty>& result);
+
+    // P * A = L * U in place by right-looking blocked elimination with partial
+    // pivoting: L is unit lower triangular below the diagonal, U upper triangular
+    // on and above it, and row `i` was exchanged with row `pivots[i]` at step `i`,
+    // as LAPACK's getrf. Every process gets all the pivots.
+    // std::errc::invalid_argument if the matrix is not square, or singular,
+    // in which case the factorization is still completed
+    template <typename _Ty>
+    std::errc DecomposeLU(DistributedMatrix<_Ty>& matrix, std::vector<int>& pivots);
+}
+
+namespace detail
+{
+    // Tags of the messages of the distributed algorithms
+    enum DistributedTag : int
+    {
+        ScatterTag = 1,
+        GatherTag,
+        PanelTag,
+        PivotSearchTag,
+        PivotTag,
+        RowExchangeTag,
+        PivotRowTag,
+        DiagonalBlockTag,
+    };
+
+    // Binomial-tree broadcast of `count` entries from `group[rootIndex]`
+    // to the other processes of the group, in log2(group size) rounds
+    template <typename _Ty>
+    std::errc Broadcast(MatrixMath::Transport& transport, const std::vector<int>& group, const int rootIndex,
+        _Ty* data, const std::size_t count, const int tag)
+    {
+        const int size{ static_cast<int>(group.size()) };
+        const int index{ static_cast<int>(std::find(group.begin(), group.end(), transport.GetRank()) - group.begin()) };
+        const int relative{ (index - rootIndex + size) % size };
+        const std::size_t bytes{ count * sizeof(_Ty) };
+
+        int mask{ 1 };
+        for (; mask < size; mask <<= 1)
+        {
+            if ((relative & mask) != 0)
+            {
+                const int source{ group[(relative - mask + rootIndex) % size] };
+                if (const std::errc ec{ transport.Receive(source, tag, data, bytes) }; ec != std::errc{})
+                    return ec;
+                break;
+            }
+        }
+        for (mask >>= 1; mask > 0; mask >>= 1)
+        {
+            if (relative + mask < size)
+            {
+                const int destination{ group[(relative + mask + rootIndex) % size] };
+                if (const std::errc ec{ transport.Send(destination, tag, data, bytes) }; ec != std::errc{})
+                    return ec;
+            }
+        }
+        return std::errc{};
+    }
+
+    // Ranks of the processes in the row / column of the grid of this process
+    inline std::vector<int> GridRow(const MatrixMath::ProcessGrid& grid)
+    {
+        std::vector<int> group(grid.columns);
+        for (int column = 0; column < grid.columns; column++)
+            group[column] = grid.RankOf(grid.row, column);
+        return group;
+    }
+
+    inline std::vector<int> GridColumn(const MatrixMath::ProcessGrid& grid)
+    {
+        std::vector<int> group(grid.rows);
+        for (int row = 0; row < grid.rows; row++)
+            group[row] = grid.RankOf(row, grid.column);
+        return group;
+    }
+
+    // Exchange the global rows `a` and `b` on the local columns `columns`
+    // between the processes of a column of the grid which own them
+    template <typename _Ty>
+    std::errc ExchangeRows(MatrixMath::DistributedMatrix<_Ty>& matrix, const int a, const int b,
+        const std::vector<int>& columns)
+    {
+        if (a == b || columns.empty())
+            return std::errc{};
+
+        const MatrixMath::ProcessGrid& grid{ matrix.GetGrid() };
+        MatrixMath::DynamicMatrix<_Ty>& local{ matrix.GetLocal() };
+        const int ownerA{ matrix.OwnerRow(a) };
+        const int ownerB{ matrix.OwnerRow(b) };
+        if (grid.row != ownerA && grid.row != ownerB)
+            return std::errc{};
+
+        if (ownerA == ownerB)
+        {
+            const int localA{ matrix.LocalRow(a) };
+            const int localB{ matrix.LocalRow(b) };
+            for (const int column : columns)
+                std::swap(local.GetElement(localA, column), local.GetElement(localB, column));
+            return std::errc{};
+        }
+
+        const int mine{ matrix.LocalRow(grid.row == ownerA ? a : b) };
+        const int peerRow{ grid.row == ownerA ? ownerB : ownerA };
+        const int peer{ grid.RankOf(peerRow, grid.column) };
+        std::vector<_Ty> outgoing(columns.size());
+        std::vector<_Ty> incoming(columns.size());
+        for (std::size_t index = 0; index < columns.size(); index++)
+            outgoing[index] = local.GetElement(mine, columns[index]);
+
+        MatrixMath::Transport& transport{ matrix.GetTransport() };
+        const std::size_t bytes{ columns.size() * sizeof(_Ty) };
+        // the upper process sends first, so that both never wait for each other
+        std::errc ec{};
+        if (grid.row < peerRow)
+        {
+            ec = transport.Send(peer, RowExchangeTag, outgoing.data(), bytes);
+            if (ec == std::errc{})
+                ec = transport.Receive(peer, RowExchangeTag, incoming.data(), bytes);
+        }
+        else
+        {
+            ec = transport.Receive(peer, RowExchangeTag, incoming.data(), bytes);
+            if (ec == std::errc{})
+                ec = transport.Send(peer, RowExchangeTag, outgoing.data(), bytes);
+        }
+        if (ec != std::errc{})
+            return ec;
+        for (std::size_t index = 0; index < columns.size(); index++)
+            local.SetElement(mine, columns[index], incoming[index]);
+        return std::errc{};
+    }
+
+    // Factorize the panel of global columns [first, first + count)
+    // on the processes of the grid column owning it, the pivots being
+    // searched in the whole column below the diagonal
+    template <typename _Ty>
+    std::errc FactorizePanel(MatrixMath::DistributedMatrix<_Ty>& matrix, const int first, const int count,
+        std::vector<int>& pivots, bool& isSingular)
+    {
+        struct Candidate
+        {
+            double magnitude;
+            int row;
+        };
+
+        const MatrixMath::ProcessGrid& grid{ matrix.GetGrid() };
+        MatrixMath::DynamicMatrix<_Ty>& local{ matrix.GetLocal() };
+        MatrixMath::Transport& transport{ matrix.GetTransport() };
+        const std::vector<int> column{ GridColumn(grid) };
+        const int localRows{ local.GetHeight() };
+
+        std::vector<int> panelColumns(count);
+        for (int index = 0; index < count; index++)
+            panelColumns[index] = matrix.LocalColumn(first + index);
+
+        std::vector<_Ty> pivotRow(count);
+        for (int j = first; j < first + count; j++)
+        {
+            const int lj{ matrix.LocalColumn(j) };
+            const int below{ matrix.LocalRowsBefore(j) };
+
+            // the largest entry of this process, then of the grid column
+            Candidate best{ -1.0, -1 };
+            for (int li = below; li < localRows; li++)
+            {
+                const double magnitude{ static_cast<double>(std::abs(local.GetElement(li, lj))) };
+                if (magnitude > best.magnitude)
+                    best = { magnitude, matrix.GlobalRow(li) };
+            }
+            if (grid.row == 0)
+            {
+                for (int row = 1; row < grid.rows; row++)
+                {
+                    Candidate other;
+                    if (const std::errc ec{ transport.Receive(column[row], PivotSearchTag, &other, sizeof(other)) }; ec != std::errc{})
+                        return ec;
+                    if (other.magnitude > best.magnitude || (other.magnitude == best.magnitude && other.row >= 0 && other.row < best.row))
+                        best = other;
+                }
+            }
+            else if (const std::errc ec{ transport.Send(column[0], PivotSearchTag, &best, sizeof(best)) }; ec != std::errc{})
+                return ec;
+            if (const std::errc ec{ Broadcast(transport, column, 0, &best, 1, PivotSearchTag) }; ec != std::errc{})
+                return ec;
+
+            pivots[j] = best.row;
+            if (const std::errc ec{ ExchangeRows(matrix, j, best.row, panelColumns) }; ec != std::errc{})
+                return ec;
+
+            // the pivot row, right of the diagonal within the panel
+            const int owner{ matrix.OwnerRow(j) };
+            if (grid.row == owner)
+                for (int index = 0; index < first + count - j; index++)
+                    pivotRow[index] = local.GetElement(matrix.LocalRow(j), matrix.LocalColumn(j + index));
+            if (const std::errc ec{ Broadcast(transport, column, owner, pivotRow.data(), first + count - j, PivotRowTag) }; ec != std::errc{})
+                return ec;
+
+            if (pivotRow[0] == _Ty{})
+            {
+                isSingular = true;
+                continue;
+            }
+            for (int li = matrix.LocalRowsBefore(j + 1); li < localRows; li++)
+            {
+                const _Ty factor{ local.GetElement(li, lj) / pivotRow[0] };
+                local.SetElement(li, lj, factor);
+                for (int index = 1; index < first + count - j; index++)
+                    local.GetElement(li, matrix.LocalColumn(j + index)) -= factor * pivotRow[index];
+            }
+        }
+        return std::errc{};
+    }
+}
+
+
+inline int
+MatrixMath::SingleProcessTransport::
+GetRank() const
+{
+    return 0;
+}
+
+inline int
+MatrixMath::SingleProcessTransport::
+GetSize() const
+{
+    return 1;
+}
+
+inline std::errc
+MatrixMath::SingleProcessTransport::
+Send(const int destination, const int tag, const void* data, const std::size_t size)
+{
+    if (destination != 0)
+        return std::errc::invalid_argument;
+
+    const char* bytes{ static_cast<const char*>(data) };
+    pending.push_back(Message{ tag, std::vector<char>(bytes, bytes + size) });
+    return std::errc{};
+}
+
+inline std::errc
+MatrixMath::SingleProcessTransport::
+Receive(const int source, const int tag, void* data, const std::size_t size)
+{
+    if (source != 0)
+        return std::errc::invalid_argument;
+
+    for (auto it = pending.begin(); it != pending.end(); ++it)
+    {
+        if (it->tag == tag)
+        {
+            if (it->data.size() != size)
+                return std::errc::message_size;
+            std::memcpy(data, it->data.data(), size);
+            pending.erase(it);
+            return std::errc{};
+        }
+    }
+    return std::errc::resource_unavailable_try_again;
+}
+
+#if !defined(_WIN32)
+
+inline
+MatrixMath::LocalSocketTransport::
+LocalSocketTransport(const int rank, std::vector<int> sockets)
+    : rank{ rank }
+    , sockets{ std::move(sockets) }
+{
+}
+
+inline
+MatrixMath::LocalSocketTransport::
+~LocalSocketTransport()
+{
+    for (const int socket : sockets)
+        if (socket >= 0)
+            ::close(socket);
+}
+
+inline int
+MatrixMath::LocalSocketTransport::
+GetRank() const
+{
+    return rank;
+}
+
+inline int
+MatrixMath::LocalSocketTransport::
+GetSize() const
+{
+    return static_cast<int>(sockets.size());
+}
+
+inline std::errc
+MatrixMath::LocalSocketTransport::
+readAll(const int socket, void* data, std::size_t size)
+{
+    char* bytes{ static_cast<char*>(data) };
+    while (size > 0)
+    {
+        const ssize_t count{ ::read(socket, bytes, size) };
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return static_cast<std::errc>(errno);
+        if (count == 0)
+            return std::errc::connection_reset;
+        bytes += count;
+        size -= static_cast<std::size_t>(count);
+    }
+    return std::errc{};
+}
+
+inline std::errc
+MatrixMath::LocalSocketTransport::
+writeAll(const int socket, const void* data, std::size_t size)
+{
+    const char* bytes{ static_cast<const char*>(data) };
+    while (size > 0)
+    {
+        const ssize_t count{ ::write(socket, bytes, size) };
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return static_cast<std::errc>(errno);
+        bytes += count;
+        size -= static_cast<std::size_t>(count);
+    }
+    return std::errc{};
+}
+
+inline std::errc
+MatrixMath::LocalSocketTransport::
+Send(const int destination, const int tag, const void* data, const std::size_t size)
+{
+    if (destination < 0 || destination >= this->GetSize() || sockets[destination] < 0)
+        return std::errc::invalid_argument;
+
+    const std::uint64_t header[2]{ static_cast<std::uint64_t>(tag), size };
+    if (const std::errc ec{ writeAll(sockets[destination], header, sizeof(header)) }; ec != std::errc{})
+        return ec;
+    return writeAll(sockets[destination], data, size);
+}
+
+inline std::errc
+MatrixMath::LocalSocketTransport::
+Receive(const int source, const int tag, void* data, const std::size_t size)
+{
+    if (source < 0 || source >= this->GetSize() || sockets[source] < 0)
+        return std::errc::invalid_argument;
+
+    for (auto it = pending.begin(); it != pending.end(); ++it)
+    {
+        if (it->source == source && it->tag == tag)
+        {
+            if (it->data.size() != size)
+                return std::errc::message_size;
+            std::memcpy(data, it->data.data(), size);
+            pending.erase(it);
+            return std::errc{};
+        }
+    }
+
+    while (true)
+    {
+        std::uint64_t header[2];
+        if (const std::errc ec{ readAll(sockets[source], header, sizeof(header)) }; ec != std::errc{})
+            return ec;
+        if (static_cast<int>(header[0]) == tag)
+        {
+            if (header[1] != size)
+                return std::errc::message_size;
+            return readAll(sockets[source], data, size);
+        }
+
+        Message message{ source, static_cast<int>(header[0]), std::vector<char>(header[1]) };
+        if (const std::errc ec{ readAll(sockets[source], message.data.data(), message.data.size()) }; ec != std::errc{})
+            return ec;
+        pending.push_back(std::move(message));
+    }
+}
+
+#endif
+
+inline int
+MatrixMath::
+RunLocalProcesses(const int count, const std::function<int(Transport&)>& worker)
+{
+#if defined(_WIN32)
+    (void)count;
+    (void)worker;
+    return -1;
+#else
+    if (count <= 0)
+        return -1;
+
+    // sockets[i][j]: the end held by i of the pair connecting i and j
+    std::vector<std::vector<int>> sockets(count, std::vector<int>(count, -1));
+    auto closeAll = [&sockets](const int except) {
+        for (int rank = 0; rank < static_cast<int>(sockets.size()); rank++)
+            if (rank != except)
+                for (const int socket : sockets[rank])
+                    if (socket >= 0)
+                        ::close(socket);
+    };
+    for (int i = 0; i < count; i++)
+    {
+        for (int j = i + 1; j < count; j++)
+        {
+            int pair[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+            {
+                closeAll(-1);
+                return -1;
+            }
+            sockets[i][j] = pair[0];
+            sockets[j][i] = pair[1];
+        }
+    }
+
+    // pending output would be written by every child otherwise
+    std::fflush(nullptr);
+    std::vector<pid_t> children;
+    for (int rank = 0; rank < count; rank++)
+    {
+        const pid_t child{ ::fork() };
+        if (child == 0)
+        {
+            closeAll(rank);
+            int code;
+            {
+                LocalSocketTransport transport(rank, std::move(sockets[rank]));
+                code = worker(transport);
+            }
+            std::fflush(nullptr);
+            ::_exit(code);
+        }
+        if (child < 0)
+            break;
+        children.push_back(child);
+    }
+    closeAll(-1);
+
+    int result{ static_cast<int>(children.size()) == count ? 0 : -1 };
+    for (const pid_t child : children)
+    {
+        int status{ 0 };
+        while (::waitpid(child, &status, 0) < 0 && errno == EINTR)
+            ;
+        const int code{ WIFEXITED(status) ? WEXITSTATUS(status) : -1 };
+        if (result == 0 && code != 0)
+            result = code;
+    }
+    return result;
+#endif
+}
+
+inline MatrixMath::ProcessGrid
+MatrixMath::ProcessGrid::
+Square(const Transport& transport)
+{
+    const int size{ transport.GetSize() };
+    int rows{ static_cast<int>(std::sqrt(static_cast<double>(size))) };
+    while (size % rows != 0)
+        rows--;
+    return Make(transport, rows, size / rows);
+}
+
+inline MatrixMath::ProcessGrid
+MatrixMath::ProcessGrid::
+Make(const Transport& transport, const int rows, const int columns)
+{
+    ProcessGrid grid;
+    grid.rows = rows;
+    grid.columns = columns;
+    grid.row = transport.GetRank() / columns;
+    grid.column = transport.GetRank() % columns;
+    return grid;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+CountOwned(const int count, const int blockSize, const int owner, const int processes)
+{
+    const int blocks{ count / blockSize };
+    int owned{ blocks / processes * blockSize };
+    const int extra{ blocks % processes };
+    if (owner < extra)
+        owned += blockSize;
+    else if (owner == extra)
+        owned += count % blockSize;
+    return owned;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+GlobalIndex(const int index, const int blockSize, const int owner, const int processes)
+{
+    return (index / blockSize * processes + owner) * blockSize + index % blockSize;
+}
+
+template <typename _Ty>
+MatrixMath::DistributedMatrix<_Ty>::
+DistributedMatrix(Transport& transport, const ProcessGrid& grid, const int height, const int width,
+    const int blockSize)
+    : pTransport{ &transport }
+    , grid{ grid }
+    , height{ height }
+    , width{ width }
+    , blockSize{ blockSize > 0 ? blockSize : GetTuning().luBlock }
+    , local(CountOwned(height, this->blockSize, grid.row, grid.rows), CountOwned(width, this->blockSize, grid.column, grid.columns))
+{
+}
+
+template <typename _Ty>
+inline MatrixMath::Transport&
+MatrixMath::DistributedMatrix<_Ty>::
+GetTransport() const
+{
+    return *pTransport;
+}
+
+template <typename _Ty>
+inline const MatrixMath::ProcessGrid&
+MatrixMath::DistributedMatrix<_Ty>::
+GetGrid() const
+{
+    return grid;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+GetHeight() const
+{
+    return height;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+GetWidth() const
+{
+    return width;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+GetBlockSize() const
+{
+    return blockSize;
+}
+
+template <typename _Ty>
+inline const MatrixMath::DynamicMatrix<_Ty>&
+MatrixMath::DistributedMatrix<_Ty>::
+GetLocal() const
+{
+    return local;
+}
+
+template <typename _Ty>
+inline MatrixMath::DynamicMatrix<_Ty>&
+MatrixMath::DistributedMatrix<_Ty>::
+GetLocal()
+{
+    return local;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+OwnerRow(const int row) const
+{
+    return row / blockSize % grid.rows;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+OwnerColumn(const int column) const
+{
+    return column / blockSize % grid.columns;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+LocalRow(const int row) const
+{
+    return row / blockSize / grid.rows * blockSize + row % blockSize;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+LocalColumn(const int column) const
+{
+    return column / blockSize / grid.columns * blockSize + column % blockSize;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+GlobalRow(const int localRow) const
+{
+    return GlobalIndex(localRow, blockSize, grid.row, grid.rows);
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+GlobalColumn(const int localColumn) const
+{
+    return GlobalIndex(localColumn, blockSize, grid.column, grid.columns);
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+LocalRowsBefore(const int end) const
+{
+    return CountOwned(end, blockSize, grid.row, grid.rows);
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::DistributedMatrix<_Ty>::
+LocalColumnsBefore(const int end) const
+{
+    return CountOwned(end, blockSize, grid.column, grid.columns);
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::DistributedMatrix<_Ty>::
+Scatter(const DynamicMatrix<_Ty>& matrix, const int root)
+{
+    if (pTransport->GetRank() != root)
+        return pTransport->Receive(root, detail::ScatterTag, local.GetData(), local.GetSize() * sizeof(_Ty));
+
+    if (matrix.GetHeight() != height || matrix.GetWidth() != width)
+        return std::errc::invalid_argument;
+    for (int rank = 0; rank < grid.rows * grid.columns; rank++)
+    {
+        const int row{ rank / grid.columns };
+        const int column{ rank % grid.columns };
+        DynamicMatrix<_Ty> blocks(CountOwned(height, blockSize, row, grid.rows),
+            CountOwned(width, blockSize, column, grid.columns));
+        for (int i = 0; i < blocks.GetHeight(); i++)
+            for (int j = 0; j < blocks.GetWidth(); j++)
+                blocks.SetElement(i, j, matrix.GetElement(GlobalIndex(i, blockSize, row, grid.rows),
+                    GlobalIndex(j, blockSize, column, grid.columns)));
+
+        if (rank == root)
+            local = std::move(blocks);
+        else if (const std::errc ec{ pTransport->Send(rank, detail::ScatterTag, blocks.GetData(), blocks.GetSize() * sizeof(_Ty)) };
+            ec != std::errc{})
+            return ec;
+    }
+    return std::errc{};
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::DistributedMatrix<_Ty>::
+Gather(DynamicMatrix<_Ty>& matrix, const int root) const
+{
+    if (pTransport->GetRank() != root)
+        return pTransport->Send(root, detail::GatherTag, local.GetData(), local.GetSize() * sizeof(_Ty));
+
+    matrix.Resize(height, width);
+    DynamicMatrix<_Ty> received;
+    for (int rank = 0; rank < grid.rows * grid.columns; rank++)
+    {
+        const int row{ rank / grid.columns };
+        const int column{ rank % grid.columns };
+        if (rank != root)
+        {
+            received.Resize(CountOwned(height, blockSize, row, grid.rows), CountOwned(width, blockSize, column, grid.columns));
+            if (const std::errc ec{ pTransport->Receive(rank, detail::GatherTag, received.GetData(), received.GetSize() * sizeof(_Ty)) };
+                ec != std::errc{})
+                return ec;
+        }
+        const DynamicMatrix<_Ty>& blocks{ rank == root ? local : received };
+        for (int i = 0; i < blocks.GetHeight(); i++)
+            for (int j = 0; j < blocks.GetWidth(); j++)
+                matrix.SetElement(GlobalIndex(i, blockSize, row, grid.rows), GlobalIndex(j, blockSize, column, grid.columns),
+                    blocks.GetElement(i, j));
+    }
+    return std::errc{};
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::
+Multiply(const DistributedMatrix<_Ty>& lhs, const DistributedMatrix<_Ty>& rhs, DistributedMatrix<_Ty>& result)
+{
+    const ProcessGrid& grid{ result.GetGrid() };
+    const int blockSize{ result.GetBlockSize() };
+    if (lhs.GetWidth() != rhs.GetHeight() || lhs.GetHeight() != result.GetHeight() || rhs.GetWidth() != result.GetWidth()
+        || lhs.GetBlockSize() != blockSize || rhs.GetBlockSize() != blockSize
+        || lhs.GetGrid().rows != grid.rows || lhs.GetGrid().columns != grid.columns
+        || rhs.GetGrid().rows != grid.rows || rhs.GetGrid().columns != grid.columns)
+        return std::errc::invalid_argument;
+
+    Transport& transport{ result.GetTransport() };
+    DynamicMatrix<_Ty>& c{ result.GetLocal() };
+    const int m{ c.GetHeight() };
+    const int n{ c.GetWidth() };
+    const std::vector<int> row{ detail::GridRow(grid) };
+    const std::vector<int> column{ detail::GridColumn(grid) };
+    std::vector<_Ty> lhsPanel(static_cast<std::size_t>(m) * blockSize);
+    std::vector<_Ty> rhsPanel(static_cast<std::size_t>(blockSize) * n);
+
+    std::fill(c.GetData(), c.GetData() + c.GetSize(), _Ty{});
+    for (int first = 0; first < lhs.GetWidth(); first += blockSize)
+    {
+        const int k{ std::min(blockSize, lhs.GetWidth() - first) };
+        const int owner{ first / blockSize };
+
+        // the block column of lhs along the rows of the grid
+        const int ownerColumn{ owner % grid.columns };
+        if (grid.column == ownerColumn)
+        {
+            const int offset{ lhs.LocalColumn(first) };
+            for (int i = 0; i < m; i++)
+                for (int p = 0; p < k; p++)
+                    lhsPanel[i * k + p] = lhs.GetLocal().GetElement(i, offset + p);
+        }
+        if (const std::errc ec{ detail::Broadcast(transport, row, ownerColumn, lhsPanel.data(), static_cast<std::size_t>(m) * k, detail::PanelTag) };
+            ec != std::errc{})
+            return ec;
+
+        // the block row of rhs along the columns of the grid
+        const int ownerRow{ owner % grid.rows };
+        // a process may hold no columns, and then no buffer to index
+        if (grid.row == ownerRow && n > 0)
+        {
+            const _Ty* source{ rhs.GetLocal().GetData() + static_cast<std::size_t>(rhs.LocalRow(first)) * n };
+            std::copy(source, source + static_cast<std::size_t>(k) * n, rhsPanel.data());
+        }
+        if (const std::errc ec{ detail::Broadcast(transport, column, ownerRow, rhsPanel.data(), static_cast<std::size_t>(k) * n, detail::PanelTag) };
+            ec != std::errc{})
+            return ec;
+
+        if (m > 0 && n > 0)
+            detail::MultiplyAddBlock(lhsPanel.data(), k, rhsPanel.data(), n, c.GetData(), n, m, n, k);
+    }
+    return std::errc{};
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::
+DecomposeLU(DistributedMatrix<_Ty>& matrix, std::vector<int>& pivots)
+{
+    const int size{ matrix.GetHeight() };
+    if (matrix.GetWidth() != size)
+        return std::errc::invalid_argument;
+
+    const ProcessGrid& grid{ matrix.GetGrid() };
+    const int blockSize{ matrix.GetBlockSize() };
+    Transport& transport{ matrix.GetTransport() };
+    DynamicMatrix<_Ty>& local{ matrix.GetLocal() };
+    const std::vector<int> row{ detail::GridRow(grid) };
+    const std::vector<int> column{ detail::GridColumn(grid) };
+    bool isSingular{ false };
+    pivots.assign(size, 0);
+
+    for (int first = 0; first < size; first += blockSize)
+    {
+        const int count{ std::min(blockSize, size - first) };
+        const int last{ first + count };
+        const int ownerRow{ first / blockSize % grid.rows };
+        const int ownerColumn{ first / blockSize % grid.columns };
+
+        // L11 and L21, and the pivots of the panel
+        if (grid.column == ownerColumn)
+            if (const std::errc ec{ detail::FactorizePanel(matrix, first, count, pivots, isSingular) }; ec != std::errc{})
+                return ec;
+        if (const std::errc ec{ detail::Broadcast(transport, row, ownerColumn, pivots.data() + first, count, detail::PivotTag) };
+            ec != std::errc{})
+            return ec;
+
+        // the same exchanges on the left and on the right of the panel
+        std::vector<int> outside;
+        for (int lc = 0; lc < local.GetWidth(); lc++)
+        {
+            const int global{ matrix.GlobalColumn(lc) };
+            if (global < first || global >= last)
+                outside.push_back(lc);
+        }
+        for (int j = first; j < last; j++)
+            if (const std::errc ec{ detail::ExchangeRows(matrix, j, pivots[j], outside) }; ec != std::errc{})
+                return ec;
+
+        // U12 = L11^-1 * A12 on the grid row owning the block row
+        const int right{ matrix.LocalColumnsBefore(last) };
+        const int width{ local.GetWidth() - right };
+        if (grid.row == ownerRow)
+        {
+            std::vector<_Ty> diagonal(static_cast<std::size_t>(count) * count);
+            if (grid.column == ownerColumn)
+                for (int i = 0; i < count; i++)
+                    for (int p = 0; p < count; p++)
+                        diagonal[i * count + p] = local.GetElement(matrix.LocalRow(first + i), matrix.LocalColumn(first + p));
+            if (const std::errc ec{ detail::Broadcast(transport, row, ownerColumn, diagonal.data(), diagonal.size(), detail::DiagonalBlockTag) };
+                ec != std::errc{})
+                return ec;
+
+            const int top{ matrix.LocalRow(first) };
+            for (int i = 1; i < count; i++)
+                for (int p = 0; p < i; p++)
+                    for (int lc = right; lc < local.GetWidth(); lc++)
+                        local.GetElement(top + i, lc) -= diagonal[i * count + p] * local.GetElement(top + p, lc);
+        }
+
+        // A22 -= L21 * U12, L21 travelling along the rows of the grid
+        // and U12 along its columns
+        const int below{ matrix.LocalRowsBefore(last) };
+        const int height{ local.GetHeight() - below };
+        std::vector<_Ty> lower(static_cast<std::size_t>(height) * count);
+        std::vector<_Ty> upper(static_cast<std::size_t>(count) * width);
+        if (grid.column == ownerColumn)
+            for (int i = 0; i < height; i++)
+                for (int p = 0; p < count; p++)
+                    lower[i * count + p] = -local.GetElement(below + i, matrix.LocalColumn(first + p));
+        if (const std::errc ec{ detail::Broadcast(transport, row, ownerColumn, lower.data(), lower.size(), detail::PanelTag) };
+            ec != std::errc{})
+            return ec;
+        if (grid.row == ownerRow)
+            for (int p = 0; p < count; p++)
+                for (int j = 0; j < width; j++)
+                    upper[p * width + j] = local.GetElement(matrix.LocalRow(first + p), right + j);
+        if (const std::errc ec{ detail::Broadcast(transport, column, ownerRow, upper.data(), upper.size(), detail::PanelTag) };
+            ec != std::errc{})
+            return ec;
+
+        if (height > 0 && width > 0)
+            detail::MultiplyAddBlock(lower.data(), count, upper.data(), width,
+                &local.GetElement(below, right), local.GetWidth(), height, width, count);
+    }
+    return isSingular ? std::errc::invalid_argument : std::errc{};
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#include "Matrix.h"
+
+namespace MatrixMath
+{
+    // Matrix whose dimensions are decided at run time, e.g. by the contents
+    // of a file. The entries live in one block owned through a shared pointer,
+    // which may also point into storage owned by someone else
+    // (see the aliasing constructor of std::shared_ptr), e.g. a mapped file
+    template <typename _Ty, typename order = StorageOrder::RowMajor>
+    class DynamicMatrix
+    {
+        static_assert(std::is_base_of_v<StorageOrder, order>, "Template argument 'order' is invalid type!");
+
+    public:
+        using ElementType = _Ty;
+        using OrderType = order;
+        using data_ptr_t = std::shared_ptr<_Ty>;
+
+    private:
+        data_ptr_t pData;
+        int height;
+        int width;
+
+        inline std::size_t index(const int row, const int column) const;
+
+    public:
+        // Empty (0 x 0) matrix
+        DynamicMatrix();
+        // Zero matrix
+        DynamicMatrix(const int height, const int width);
+        // Entries in row-major order, the missing ones are zero
+        DynamicMatrix(const int height, const int width, const std::initializer_list<_Ty>& init);
+        // View of `height * width` entries stored in `order`, without copying them
+        DynamicMatrix(const int height, const int width, const data_ptr_t& pData);
+        template <int Height, int Width>
+        explicit DynamicMatrix(const Matrix<_Ty, Height, Width, order>& other);
+
+        // copies the entries, as Matrix does
+        DynamicMatrix(const DynamicMatrix& other);
+        DynamicMatrix(DynamicMatrix&& other) noexcept;
+        DynamicMatrix& operator=(const DynamicMatrix& other);
+        DynamicMatrix& operator=(DynamicMatrix&& other) noexcept;
+
+        // Reallocate a zero matrix, unless the dimensions are unchanged
+        // and the entries are not shared, in which case they are kept
+        void Resize(const int height, const int width);
+
+        inline int GetHeight() const;
+        inline int GetWidth() const;
+        inline std::size_t GetSize() const;
+        inline bool IsEmpty() const;
+
+        inline void SetElement(const int row, const int column, const _Ty& value);
+        inline const _Ty& GetElement(const int row, const int column) const;
+        inline _Ty& GetElement(const int row, const int column);
+
+        inline const _Ty* GetData() const;
+        inline _Ty* GetData();
+        inline const data_ptr_t& GetDataPointer() const;
+
+        // Valid only if the dimensions match
+        template <int Height, int Width>
+        Matrix<_Ty, Height, Width, order> ToMatrix() const;
+
+        const std::string ToString() const;
+
+    private:
+        static data_ptr_t allocate(const std::size_t size);
+    };
+}
+
+
+template <typename _Ty, typename order>
+typename MatrixMath::DynamicMatrix<_Ty, order>::data_ptr_t
+MatrixMath::DynamicMatrix<_Ty, order>::
+allocate(const std::size_t size)
+{
+    if (size == 0)
+        return nullptr;
+    return data_ptr_t(new _Ty[size](), std::default_delete<_Ty[]>());
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix()
+    : pData{ nullptr }
+    , height{ 0 }
+    , width{ 0 }
+{
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix(const int height, const int width)
+    : pData{ allocate(static_cast<std::size_t>(height) * width) }
+    , height{ height }
+    , width{ width }
+{
+    assert(height >= 0 && width >= 0);
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix(const int height, const int width, const std::initializer_list<_Ty>& init)
+    : DynamicMatrix(height, width)
+{
+    int position{ 0 };
+    for (auto it = init.begin(); it != init.end() && position < height * width; ++it, ++position)
+        this->SetElement(position / width, position % width, *it);
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix(const int height, const int width, const data_ptr_t& pData)
+    : pData{ pData }
+    , height{ height }
+    , width{ width }
+{
+}
+
+template <typename _Ty, typename order>
+template <int Height, int Width>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix(const Matrix<_Ty, Height, Width, order>& other)
+    : DynamicMatrix(Height, Width)
+{
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            this->SetElement(row, col, other.GetElement(row, col));
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix(const DynamicMatrix& other)
+    : DynamicMatrix(other.height, other.width)
+{
+    std::copy(other.GetData(), other.GetData() + other.GetSize(), this->GetData());
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+DynamicMatrix(DynamicMatrix&& other) noexcept
+    : pData{ std::move(other.pData) }
+    , height{ other.height }
+    , width{ other.width }
+{
+    other.height = 0;
+    other.width = 0;
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>&
+MatrixMath::DynamicMatrix<_Ty, order>::
+operator=(const DynamicMatrix& other)
+{
+    if (this != &other)
+    {
+        this->Resize(other.height, other.width);
+        std::copy(other.GetData(), other.GetData() + other.GetSize(), this->GetData());
+    }
+    return *this;
+}
+
+template <typename _Ty, typename order>
+MatrixMath::DynamicMatrix<_Ty, order>&
+MatrixMath::DynamicMatrix<_Ty, order>::
+operator=(DynamicMatrix&& other) noexcept
+{
+    pData = std::move(other.pData);
+    height = other.height;
+    width = other.width;
+    other.height = 0;
+    other.width = 0;
+    return *this;
+}
+
+template <typename _Ty, typename order>
+void
+MatrixMath::DynamicMatrix<_Ty, order>::
+Resize(const int height, const int width)
+{
+    assert(height >= 0 && width >= 0);
+    if (height == this->height && width == this->width && pData.use_count() == 1)
+        return;
+    pData = allocate(static_cast<std::size_t>(height) * width);
+    this->height = height;
+    this->width = width;
+}
+
+template <typename _Ty, typename order>
+inline std::size_t
+MatrixMath::DynamicMatrix<_Ty, order>::
+index(const int row, const int column) const
+{
+    if constexpr (order::IsRowMajor())
+        return static_cast<std::size_t>(column) + static_cast<std::size_t>(row) * width;
+    else
+        return static_cast<std::size_t>(row) + static_cast<std::size_t>(column) * height;
+}
+
+template <typename _Ty, typename order>
+inline int
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetHeight() const
+{
+    return height;
+}
+
+template <typename _Ty, typename order>
+inline int
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetWidth() const
+{
+    return width;
+}
+
+template <typename _Ty, typename order>
+inline std::size_t
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetSize() const
+{
+    return static_cast<std::size_t>(height) * width;
+}
+
+template <typename _Ty, typename order>
+inline bool
+MatrixMath::DynamicMatrix<_Ty, order>::
+IsEmpty() const
+{
+    return height == 0 || width == 0;
+}
+
+template <typename _Ty, typename order>
+inline void
+MatrixMath::DynamicMatrix<_Ty, order>::
+SetElement(const int row, const int column, const _Ty& value)
+{
+    pData.get()[index(row, column)] = value;
+}
+
+template <typename _Ty, typename order>
+inline const _Ty&
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetElement(const int row, const int column) const
+{
+    return pData.get()[index(row, column)];
+}
+
+template <typename _Ty, typename order>
+inline _Ty&
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetElement(const int row, const int column)
+{
+    return pData.get()[index(row, column)];
+}
+
+template <typename _Ty, typename order>
+inline const _Ty*
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetData() const
+{
+    return pData.get();
+}
+
+template <typename _Ty, typename order>
+inline _Ty*
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetData()
+{
+    return pData.get();
+}
+
+template <typename _Ty, typename order>
+inline const typename MatrixMath::DynamicMatrix<_Ty, order>::data_ptr_t&
+MatrixMath::DynamicMatrix<_Ty, order>::
+GetDataPointer() const
+{
+    return pData;
+}
+
+template <typename _Ty, typename order>
+template <int Height, int Width>
+MatrixMath::Matrix<_Ty, Height, Width, order>
+MatrixMath::DynamicMatrix<_Ty, order>::
+ToMatrix() const
+{
+    assert(Height == height && Width == width);
+
+    Matrix<_Ty, Height, Width, order> result;
+    for (int row = 0; row < Height; row++)
+        for (int col = 0; col < Width; col++)
+            result.SetElement(row, col, this->GetElement(row, col));
+    return result;
+}
+
+template <typename _Ty, typename order>
+const std::string
+MatrixMath::DynamicMatrix<_Ty, order>::
+ToString() const
+{
+    return Format(*this, FormatOptions::Pretty());
+}
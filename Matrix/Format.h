@@ -0,0 +1,370 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace MatrixMath
+{
+    // Layout of the text written by the formatters:
+    //
+    //   prefix
+    //   rowPrefix e(0, 0) columnSeparator e(0, 1) ... rowSuffix rowSeparator
+    //   ...
+    //   rowPrefix e(H-1, 0) columnSeparator ...       rowSuffix
+    //   suffix
+    //
+    // every entry being right-aligned on `width` characters
+    struct FormatOptions
+    {
+        std::string_view prefix{ "" };
+        std::string_view rowPrefix{ "| " };
+        std::string_view columnSeparator{ " " };
+        std::string_view rowSuffix{ "     |\n" };
+        std::string_view rowSeparator{ "" };
+        std::string_view suffix{ "" };
+        int width{ 5 };
+        // Significant digits of floating-point entries, as printf's "%g",
+        // clamped to the digits needed to round-trip the type;
+        // negative: shortest representation that round-trips
+        int precision{ 6 };
+
+        // the layout of `ToString`
+        constexpr static FormatOptions Pretty(const int precision = 6);
+        // lossless by default
+        constexpr static FormatOptions CSV(const int precision = -1);
+        constexpr static FormatOptions TSV(const int precision = -1);
+        // [ 1 2; 3 4 ]
+        constexpr static FormatOptions Matlab(const int precision = -1);
+    };
+
+    // Exact number of characters written for the matrix
+    template <typename MatrixType>
+    std::size_t FormattedSize(const MatrixType& matrix, const FormatOptions& options = {});
+
+    // Write into [first, last) without terminating zero;
+    // `ec` is std::errc::value_too_large if the buffer is too small,
+    // and `ptr` is then `last`, the contents of the buffer being unspecified
+    template <typename MatrixType>
+    std::to_chars_result FormatTo(char* first, char* last, const MatrixType& matrix, const FormatOptions& options = {});
+
+    // Append to the string, growing it once by the exact size
+    template <typename MatrixType>
+    void FormatAppend(std::string& output, const MatrixType& matrix, const FormatOptions& options = {});
+
+    template <typename MatrixType>
+    std::string Format(const MatrixType& matrix, const FormatOptions& options = {});
+
+    // Stream the text through a fixed buffer of `bufferSize` characters,
+    // calling `sink(const char* data, std::size_t size)` each time it fills up,
+    // so that large matrices are never held as a whole string
+    template <typename MatrixType, typename Sink>
+    void FormatChunks(const MatrixType& matrix, Sink&& sink, const FormatOptions& options = {},
+        const std::size_t bufferSize = 1 << 16);
+
+    template <typename MatrixType>
+    void FormatStream(std::ostream& stream, const MatrixType& matrix, const FormatOptions& options = {},
+        const std::size_t bufferSize = 1 << 16);
+}
+
+namespace detail
+{
+    // Room for any entry formatted by `FormatEntry`:
+    // sign, max_digits10 digits, point and a three-digit exponent
+    constexpr static std::size_t FormatEntryCapacity{ 64 };
+
+    // Characters of the entry, without padding
+    template <typename _Ty>
+    std::size_t FormatEntry(char* buffer, const _Ty& value, const int precision)
+    {
+        char* const last{ buffer + FormatEntryCapacity };
+        if constexpr (std::is_floating_point_v<_Ty>)
+        {
+            const std::to_chars_result result{ precision < 0
+                ? std::to_chars(buffer, last, value)
+                : std::to_chars(buffer, last, value, std::chars_format::general,
+                    std::min(precision, std::numeric_limits<_Ty>::max_digits10)) };
+            return static_cast<std::size_t>(result.ptr - buffer);
+        }
+        else if constexpr (std::is_integral_v<_Ty> && !std::is_same_v<_Ty, bool>
+            && !std::is_same_v<_Ty, char>)
+        {
+            return static_cast<std::size_t>(std::to_chars(buffer, last, value).ptr - buffer);
+        }
+        else
+        {
+            // any type printable by streams
+            std::ostringstream ss;
+            ss << value;
+            const std::string text{ ss.str() };
+            const std::size_t size{ std::min(text.size(), FormatEntryCapacity) };
+            std::memcpy(buffer, text.data(), size);
+            return size;
+        }
+    }
+
+    // Drive `writer.put(const char*, std::size_t)` over the layout of `options`;
+    // `at(row, column)` returns the entries
+    template <typename _At, typename Writer>
+    void FormatMatrix(const int height, const int width, _At&& at,
+        const MatrixMath::FormatOptions& options, Writer& writer)
+    {
+        constexpr static char spaces[]{ "                                " };
+        constexpr static int spaceCount{ sizeof(spaces) - 1 };
+        char buffer[FormatEntryCapacity];
+
+        auto put = [&writer](const std::string_view text) {
+            if (!text.empty())
+                writer.put(text.data(), text.size());
+        };
+
+        put(options.prefix);
+        for (int row = 0; row < height; row++)
+        {
+            if (row > 0)
+                put(options.rowSeparator);
+            put(options.rowPrefix);
+            for (int column = 0; column < width; column++)
+            {
+                if (column > 0)
+                    put(options.columnSeparator);
+                const std::size_t size{ FormatEntry(buffer, at(row, column), options.precision) };
+                for (int padding = options.width - static_cast<int>(size); padding > 0; padding -= spaceCount)
+                    writer.put(spaces, static_cast<std::size_t>(std::min(padding, spaceCount)));
+                writer.put(buffer, size);
+            }
+            put(options.rowSuffix);
+        }
+        put(options.suffix);
+    }
+
+    struct CountingWriter
+    {
+        std::size_t size{ 0 };
+
+        inline void put(const char*, const std::size_t count)
+        {
+            size += count;
+        }
+    };
+
+    struct BufferWriter
+    {
+        char* current;
+        char* last;
+        bool overflow{ false };
+
+        inline void put(const char* data, const std::size_t count)
+        {
+            if (overflow || static_cast<std::size_t>(last - current) < count)
+            {
+                overflow = true;
+                return;
+            }
+            std::memcpy(current, data, count);
+            current += count;
+        }
+    };
+
+    template <typename Sink>
+    struct ChunkWriter
+    {
+        Sink& sink;
+        std::vector<char> buffer;
+        std::size_t used{ 0 };
+
+        ChunkWriter(Sink& sink, const std::size_t capacity)
+            : sink{ sink }
+            , buffer(std::max(capacity, FormatEntryCapacity))
+        {
+        }
+
+        inline void put(const char* data, const std::size_t count)
+        {
+            if (buffer.size() - used < count)
+            {
+                flush();
+                // separators longer than the whole buffer bypass it
+                if (buffer.size() < count)
+                {
+                    sink(data, count);
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + used, data, count);
+            used += count;
+        }
+
+        inline void flush()
+        {
+            if (used > 0)
+                sink(static_cast<const char*>(buffer.data()), used);
+            used = 0;
+        }
+    };
+
+    // Append the text to the string, growing it once by the exact size
+    template <typename _At>
+    void FormatAppend(std::string& output, const int height, const int width, _At&& at,
+        const MatrixMath::FormatOptions& options)
+    {
+        CountingWriter counter;
+        FormatMatrix(height, width, at, options, counter);
+
+        const std::size_t offset{ output.size() };
+        output.resize(offset + counter.size);
+        BufferWriter writer{ output.data() + offset, output.data() + output.size() };
+        FormatMatrix(height, width, at, options, writer);
+    }
+
+    // Fixed-size matrices know their dimensions at compile time,
+    // dynamic ones at run time only
+    template <typename MatrixType, typename = void>
+    struct HasStaticExtent : std::false_type {};
+
+    template <typename MatrixType>
+    struct HasStaticExtent<MatrixType, std::void_t<decltype(MatrixType::Height)>> : std::true_type {};
+
+    template <typename MatrixType>
+    inline int FormatHeight(const MatrixType& matrix)
+    {
+        if constexpr (HasStaticExtent<MatrixType>::value)
+            return MatrixType::Height;
+        else
+            return matrix.GetHeight();
+    }
+
+    template <typename MatrixType>
+    inline int FormatWidth(const MatrixType& matrix)
+    {
+        if constexpr (HasStaticExtent<MatrixType>::value)
+            return MatrixType::Width;
+        else
+            return matrix.GetWidth();
+    }
+
+    template <typename MatrixType>
+    inline auto MatrixEntries(const MatrixType& matrix)
+    {
+        return [&matrix](const int row, const int column) -> decltype(auto) {
+            return matrix.GetElement(row, column);
+        };
+    }
+}
+
+
+constexpr MatrixMath::FormatOptions
+MatrixMath::FormatOptions::
+Pretty(const int precision)
+{
+    FormatOptions options;
+    options.precision = precision;
+    return options;
+}
+
+constexpr MatrixMath::FormatOptions
+MatrixMath::FormatOptions::
+CSV(const int precision)
+{
+    FormatOptions options;
+    options.rowPrefix = "";
+    options.columnSeparator = ",";
+    options.rowSuffix = "\n";
+    options.width = 0;
+    options.precision = precision;
+    return options;
+}
+
+constexpr MatrixMath::FormatOptions
+MatrixMath::FormatOptions::
+TSV(const int precision)
+{
+    FormatOptions options{ CSV(precision) };
+    options.columnSeparator = "\t";
+    return options;
+}
+
+constexpr MatrixMath::FormatOptions
+MatrixMath::FormatOptions::
+Matlab(const int precision)
+{
+    FormatOptions options;
+    options.prefix = "[ ";
+    options.rowPrefix = "";
+    options.columnSeparator = " ";
+    options.rowSuffix = "";
+    options.rowSeparator = "; ";
+    options.suffix = " ]";
+    options.width = 0;
+    options.precision = precision;
+    return options;
+}
+
+template <typename MatrixType>
+std::size_t
+MatrixMath::
+FormattedSize(const MatrixType& matrix, const FormatOptions& options)
+{
+    detail::CountingWriter writer;
+    detail::FormatMatrix(detail::FormatHeight(matrix), detail::FormatWidth(matrix), detail::MatrixEntries(matrix), options, writer);
+    return writer.size;
+}
+
+template <typename MatrixType>
+std::to_chars_result
+MatrixMath::
+FormatTo(char* first, char* last, const MatrixType& matrix, const FormatOptions& options)
+{
+    detail::BufferWriter writer{ first, last };
+    detail::FormatMatrix(detail::FormatHeight(matrix), detail::FormatWidth(matrix), detail::MatrixEntries(matrix), options, writer);
+    if (writer.overflow)
+        return { last, std::errc::value_too_large };
+    return { writer.current, std::errc{} };
+}
+
+template <typename MatrixType>
+void
+MatrixMath::
+FormatAppend(std::string& output, const MatrixType& matrix, const FormatOptions& options)
+{
+    detail::FormatAppend(output, detail::FormatHeight(matrix), detail::FormatWidth(matrix), detail::MatrixEntries(matrix), options);
+}
+
+template <typename MatrixType>
+std::string
+MatrixMath::
+Format(const MatrixType& matrix, const FormatOptions& options)
+{
+    std::string result;
+    FormatAppend(result, matrix, options);
+    return result;
+}
+
+template <typename MatrixType, typename Sink>
+void
+MatrixMath::
+FormatChunks(const MatrixType& matrix, Sink&& sink, const FormatOptions& options, const std::size_t bufferSize)
+{
+    detail::ChunkWriter<std::remove_reference_t<Sink>> writer(sink, bufferSize);
+    detail::FormatMatrix(detail::FormatHeight(matrix), detail::FormatWidth(matrix), detail::MatrixEntries(matrix), options, writer);
+    writer.flush();
+}
+
+template <typename MatrixType>
+void
+MatrixMath::
+FormatStream(std::ostream& stream, const MatrixType& matrix, const FormatOptions& options, const std::size_t bufferSize)
+{
+    FormatChunks(matrix, [&stream](const char* data, const std::size_t size) {
+        stream.write(data, static_cast<std::streamsize>(size));
+    }, options, bufferSize);
+}
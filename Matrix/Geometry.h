@@ -1,7 +1,1208 @@
 #pragma once
 
+#include <cmath>
+#include <limits>
+
 #include "Matrix.h"
 
 namespace MatrixMath
 {
+    // Classes of transformations, from the cheapest to invert
+    // to the most expensive one; the class of a composition
+    // is the larger class of its two operands
+    enum class TransformKind
+    {
+        // rotation (possibly improper) and translation
+        Rigid,
+        // rigid transformation combined with the same scaling along every axis
+        UniformScale,
+        // any invertible transformation keeping (0, 0, 0, 1) as last row
+        Affine,
+        // any invertible (4 x 4) homogeneous transformation
+        Projective,
+    };
+
+    // Find the class of the homogeneous matrix,
+    // entries being compared up to a relative `tolerance`
+    template <typename _Ty, typename order>
+    TransformKind Classify(const MatrixQ<_Ty, 4, order>& matrix,
+        const _Ty tolerance = std::numeric_limits<_Ty>::epsilon() * 64);
+
+    // Affine transformation of the 3D space
+    // Only the upper (3 x 4) part of the homogeneous matrix is stored:
+    //      [ L | t ]
+    //      [ 0 | 1 ]
+    // L being the linear part and t the translation.
+    // Point clouds are transformed in batches by the SIMD kernels
+    // of "Kernel.h", straight through the buffers of the caller.
+    // The class of the transformation is kept alongside the matrix,
+    // it is found once when built from a matrix and propagated by composition
+    template <typename _Ty>
+    class Transform3
+    {
+        static_assert(std::is_floating_point_v<_Ty>, "Template argument '_Ty' must be a floating point type!");
+
+    public:
+        using ElementType = _Ty;
+        using AffineType = Matrix<_Ty, 3, 4, StorageOrder::RowMajor>;
+        using LinearType = MatrixQ<_Ty, 3, StorageOrder::RowMajor>;
+        using HomogeneousType = MatrixQ<_Ty, 4, StorageOrder::RowMajor>;
+
+    private:
+        // row-major and never marked as transposed,
+        // so that its buffer is handed to the kernels as is
+        AffineType affine;
+        TransformKind kind;
+
+        template <typename _Tx>
+        friend Transform3<_Tx> operator*(const Transform3<_Tx>&, const Transform3<_Tx>&);
+
+    public:
+        // identity
+        Transform3();
+        Transform3(const Transform3& other);
+        template <typename order>
+        explicit Transform3(const Matrix<_Ty, 3, 4, order>& affine);
+        // the last row of `homogeneous` must be (0, 0, 0, 1)
+        template <typename order>
+        explicit Transform3(const MatrixQ<_Ty, 4, order>& homogeneous);
+        template <typename order>
+        Transform3(const MatrixQ<_Ty, 3, order>& linear, const Vector<_Ty, 3, order>& translation);
+
+        Transform3& operator=(const Transform3& other);
+
+        static Transform3 Translation(const _Ty x, const _Ty y, const _Ty z);
+        static Transform3 Scaling(const _Ty x, const _Ty y, const _Ty z);
+        // rotation of `angle` radians around the unit axis (x, y, z)
+        static Transform3 Rotation(const _Ty x, const _Ty y, const _Ty z, const _Ty angle);
+
+        // Access data
+
+        inline TransformKind GetKind() const;
+        inline const AffineType& GetAffine() const;
+        // `row` may be 3, the implicit last row of the homogeneous matrix
+        inline _Ty GetElement(const int row, const int column) const;
+        HomogeneousType ToMatrix() const;
+
+        // The cheapest closed form valid for the class is used:
+        // a rigid transformation is inverted by transposing its rotation
+        [[nodiscard]]
+        Transform3 Inverse() const;
+
+        // Batch transformations
+        // `count` vectors are read either as interleaved (x, y, z) triples
+        // or as three separate coordinate arrays;
+        // the outputs may be the inputs themselves
+
+        void TransformPoints(const _Ty* xyz, _Ty* out, const std::size_t count) const;
+        void TransformPoints(const _Ty* x, const _Ty* y, const _Ty* z,
+            _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count) const;
+
+        // Normals are multiplied by the inverse transpose of the linear part,
+        // which must be invertible; they are not normalized afterwards
+        void TransformNormals(const _Ty* xyz, _Ty* out, const std::size_t count) const;
+        void TransformNormals(const _Ty* x, const _Ty* y, const _Ty* z,
+            _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count) const;
+
+        // Axis-aligned bounding box of the transformed box [min, max],
+        // found from the entries of L instead of the 8 transformed corners
+        // @see: Arvo. Transforming Axis-Aligned Bounding Boxes. Graphics Gems, 1990
+        void TransformBox(const _Ty* min, const _Ty* max, _Ty* outMin, _Ty* outMax) const;
+        // The same for `count` boxes given by their centers and half extents:
+        //      center' = L * center + t, extent' = |L| * extent
+        void TransformBoxes(const _Ty* cx, const _Ty* cy, const _Ty* cz,
+            const _Ty* ex, const _Ty* ey, const _Ty* ez,
+            _Ty* outCX, _Ty* outCY, _Ty* outCZ,
+            _Ty* outEX, _Ty* outEY, _Ty* outEZ, const std::size_t count) const;
+
+        const std::string ToString() const;
+
+    private:
+        // the (3 x 4) row-major matrix applied to normals, its last column is zero
+        std::array<_Ty, 12> GetNormalMatrix() const;
+    };
+
+    // Projective transformation of the 3D space, e.g. a perspective projection;
+    // the whole homogeneous matrix is stored
+    template <typename _Ty>
+    class Projective3
+    {
+        static_assert(std::is_floating_point_v<_Ty>, "Template argument '_Ty' must be a floating point type!");
+
+    public:
+        using ElementType = _Ty;
+        using HomogeneousType = MatrixQ<_Ty, 4, StorageOrder::RowMajor>;
+
+    private:
+        HomogeneousType matrix;
+
+    public:
+        // identity
+        Projective3();
+        Projective3(const Projective3& other);
+        template <typename order>
+        explicit Projective3(const MatrixQ<_Ty, 4, order>& matrix);
+        explicit Projective3(const Transform3<_Ty>& transform);
+
+        Projective3& operator=(const Projective3& other);
+
+        // Access data
+
+        inline constexpr TransformKind GetKind() const;
+        inline const HomogeneousType& GetMatrix() const;
+        inline _Ty GetElement(const int row, const int column) const;
+
+        // Closed-form inverse through the (2 x 2) minors of the matrix
+        [[nodiscard]]
+        Projective3 Inverse() const;
+
+        const std::string ToString() const;
+    };
+
+    // Rotation of the 3D space as the quaternion
+    //      w + x i + y j + z k
+    // It is stored as (x, y, z, w), which is also the layout of the arrays
+    // handled by the batch conversions. A rotation is a unit quaternion;
+    // the conversions to matrices do not require the unit length though
+    template <typename _Ty>
+    class Quaternion
+    {
+        static_assert(std::is_floating_point_v<_Ty>, "Template argument '_Ty' must be a floating point type!");
+
+    public:
+        using ElementType = _Ty;
+        using data_t = std::array<_Ty, 4>;
+
+    private:
+        data_t data;
+
+    public:
+        // identity
+        Quaternion();
+        Quaternion(const _Ty w, const _Ty x, const _Ty y, const _Ty z);
+        template <typename order>
+        explicit Quaternion(const MatrixQ<_Ty, 3, order>& rotation);
+        // the upper-left (3 x 3) block of `rotation` is used
+        template <typename order>
+        explicit Quaternion(const MatrixQ<_Ty, 4, order>& rotation);
+
+        // rotation of `angle` radians around the unit axis (x, y, z)
+        static Quaternion AxisAngle(const _Ty x, const _Ty y, const _Ty z, const _Ty angle);
+
+        // Access data
+
+        inline const data_t& GetData() const;
+        inline data_t& GetData();
+        inline _Ty GetX() const;
+        inline _Ty GetY() const;
+        inline _Ty GetZ() const;
+        inline _Ty GetW() const;
+
+        inline _Ty Dot(const Quaternion& other) const;
+        inline _Ty Norm() const;
+
+        [[nodiscard]]
+        Quaternion Normalize() const;
+        [[nodiscard]]
+        Quaternion Conjugate() const;
+        [[nodiscard]]
+        Quaternion Inverse() const;
+
+        // Conversions
+
+        MatrixQ<_Ty, 3> ToMatrix3() const;
+        MatrixQ<_Ty, 4> ToMatrix4() const;
+        Transform3<_Ty> ToTransform() const;
+
+        // Rotate `count` vectors in batch, laid out as for `Transform3`;
+        // the quaternion is turned into a matrix once for the whole batch
+        void Rotate(const _Ty* xyz, _Ty* out, const std::size_t count) const;
+        void Rotate(const _Ty* x, const _Ty* y, const _Ty* z,
+            _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count) const;
+
+        const std::string ToString() const;
+    };
+
+    // Depth range of the clip space, deciding where the near plane lies
+    enum class ClipDepth
+    {
+        // OpenGL: -w <= z <= w
+        NegativeOneToOne,
+        // Direct3D, Vulkan: 0 <= z <= w
+        ZeroToOne,
+    };
+
+    // View volume bounded by six planes, each stored as (a, b, c, d)
+    // with a unit normal (a, b, c) pointing inside:
+    // the point p is on the inner side when a px + b py + c pz + d >= 0
+    template <typename _Ty>
+    class Frustum
+    {
+        static_assert(std::is_floating_point_v<_Ty>, "Template argument '_Ty' must be a floating point type!");
+
+    public:
+        using ElementType = _Ty;
+        using PlaneType = std::array<_Ty, 4>;
+
+        enum Side { Left, Right, Bottom, Top, Near, Far };
+
+    private:
+        // handed to the kernels as 24 consecutive entries
+        std::array<PlaneType, 6> planes;
+        static_assert(sizeof(std::array<PlaneType, 6>) == 24 * sizeof(_Ty), "Planes must be stored contiguously!");
+
+    public:
+        // Extract the planes from the rows of the projection-view matrix
+        // mapping column vectors to the clip space, clip = matrix * p
+        // @see: Gribb, Hartmann. Fast Extraction of Viewing Frustum Planes
+        //       from the World-View-Projection Matrix. 2001
+        template <typename order>
+        explicit Frustum(const MatrixQ<_Ty, 4, order>& matrix, const ClipDepth depth = ClipDepth::NegativeOneToOne);
+        explicit Frustum(const Projective3<_Ty>& projection, const ClipDepth depth = ClipDepth::NegativeOneToOne);
+
+        inline const PlaneType& GetPlane(const int side) const;
+
+        // Batch culling
+        // Bit (i % 32) of visible[i / 32] is set unless the i-th volume
+        // lies entirely outside one of the planes; the test is conservative,
+        // a volume close to an edge of the frustum may be kept.
+        // `visible` must hold (count + 31) / 32 words
+
+        // boxes given by their centers and half extents
+        void CullBoxes(const _Ty* cx, const _Ty* cy, const _Ty* cz,
+            const _Ty* ex, const _Ty* ey, const _Ty* ez,
+            std::uint32_t* visible, const std::size_t count) const;
+        void CullSpheres(const _Ty* cx, const _Ty* cy, const _Ty* cz, const _Ty* radii,
+            std::uint32_t* visible, const std::size_t count) const;
+    };
+
+    using Transform3f = Transform3<float>;
+    using Transform3d = Transform3<double>;
+    using Projective3f = Projective3<float>;
+    using Projective3d = Projective3<double>;
+    using Quaternionf = Quaternion<float>;
+    using Quaterniond = Quaternion<double>;
+    using Frustumf = Frustum<float>;
+    using Frustumd = Frustum<double>;
+
+    // Composition: `rhs` is applied first, then `lhs`;
+    // two affine transformations are composed by the (3 x 4) kernel
+    template <typename _Ty>
+    Transform3<_Ty> operator*(const Transform3<_Ty>& lhs, const Transform3<_Ty>& rhs);
+
+    template <typename _Ty>
+    Projective3<_Ty> operator*(const Projective3<_Ty>& lhs, const Projective3<_Ty>& rhs);
+
+    template <typename _Ty>
+    Projective3<_Ty> operator*(const Projective3<_Ty>& lhs, const Transform3<_Ty>& rhs);
+
+    template <typename _Ty>
+    Projective3<_Ty> operator*(const Transform3<_Ty>& lhs, const Projective3<_Ty>& rhs);
+
+    // Rotation by `rhs` first, then by `lhs`
+    template <typename _Ty>
+    Quaternion<_Ty> operator*(const Quaternion<_Ty>& lhs, const Quaternion<_Ty>& rhs);
+
+    // Interpolations along the shorter arc, `t` going from 0 (`from`) to 1 (`to`)
+
+    // normalized linear interpolation, cheap but not of constant angular velocity
+    template <typename _Ty>
+    Quaternion<_Ty> Nlerp(const Quaternion<_Ty>& from, const Quaternion<_Ty>& to, const _Ty t);
+
+    // spherical linear interpolation
+    template <typename _Ty>
+    Quaternion<_Ty> Slerp(const Quaternion<_Ty>& from, const Quaternion<_Ty>& to, const _Ty t);
+
+    // Batch conversions between `count` quaternions
+    // and row-major (3 x 3) rotation matrices stored one after another
+
+    template <typename _Ty>
+    void QuaternionsToMatrices(const Quaternion<_Ty>* quaternions, _Ty* matrices, const std::size_t count);
+
+    template <typename _Ty>
+    void MatricesToQuaternions(const _Ty* matrices, Quaternion<_Ty>* quaternions, const std::size_t count);
+}
+
+namespace detail
+{
+    // Class of the row-major (3 x 4) affine matrix `m`:
+    // the columns of its linear part are orthogonal to each other
+    // and of the same length for the rigid and uniform-scale classes
+    template <typename _Ty>
+    MatrixMath::TransformKind ClassifyAffine(const _Ty* m, const _Ty tolerance)
+    {
+        const auto dot = [m](const int i, const int j) {
+            return m[i] * m[j] + m[4 + i] * m[4 + j] + m[8 + i] * m[8 + j];
+        };
+
+        const _Ty scale{ dot(0, 0) };
+        const _Ty bound{ tolerance * scale };
+        if (!(scale > 0 && std::abs(dot(1, 1) - scale) <= bound && std::abs(dot(2, 2) - scale) <= bound
+            && std::abs(dot(0, 1)) <= bound && std::abs(dot(0, 2)) <= bound && std::abs(dot(1, 2)) <= bound))
+            return MatrixMath::TransformKind::Affine;
+        if (std::abs(scale - 1) <= tolerance)
+            return MatrixMath::TransformKind::Rigid;
+        return MatrixMath::TransformKind::UniformScale;
+    }
+}
+
+template <typename _Ty, typename order>
+MatrixMath::TransformKind
+MatrixMath::
+Classify(const MatrixQ<_Ty, 4, order>& matrix, const _Ty tolerance)
+{
+    if (std::abs(matrix.GetElement(3, 0)) > tolerance || std::abs(matrix.GetElement(3, 1)) > tolerance
+        || std::abs(matrix.GetElement(3, 2)) > tolerance || std::abs(matrix.GetElement(3, 3) - 1) > tolerance)
+        return TransformKind::Projective;
+
+    _Ty affine[12];
+    for (int row = 0; row < 3; row++)
+        for (int column = 0; column < 4; column++)
+            affine[row * 4 + column] = matrix.GetElement(row, column);
+    return detail::ClassifyAffine(affine, tolerance);
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>::
+Transform3()
+    : affine{
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+    }
+    , kind{ TransformKind::Rigid }
+{
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>::
+Transform3(const Transform3& other)
+    : affine(other.affine)
+    , kind{ other.kind }
+{
+}
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Transform3<_Ty>::
+Transform3(const Matrix<_Ty, 3, 4, order>& affine)
+{
+    for (int row = 0; row < 3; row++)
+        for (int column = 0; column < 4; column++)
+            this->affine.GetElement(row, column) = affine.GetElement(row, column);
+    this->kind = detail::ClassifyAffine(this->affine.GetData().data(), std::numeric_limits<_Ty>::epsilon() * 64);
+}
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Transform3<_Ty>::
+Transform3(const MatrixQ<_Ty, 4, order>& homogeneous)
+{
+    for (int row = 0; row < 3; row++)
+        for (int column = 0; column < 4; column++)
+            this->affine.GetElement(row, column) = homogeneous.GetElement(row, column);
+    this->kind = Classify(homogeneous);
+    assert(this->kind != TransformKind::Projective);
+}
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Transform3<_Ty>::
+Transform3(const MatrixQ<_Ty, 3, order>& linear, const Vector<_Ty, 3, order>& translation)
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+            this->affine.GetElement(row, column) = linear.GetElement(row, column);
+        this->affine.GetElement(row, 3) = translation.GetElement(row);
+    }
+    this->kind = detail::ClassifyAffine(this->affine.GetData().data(), std::numeric_limits<_Ty>::epsilon() * 64);
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>&
+MatrixMath::Transform3<_Ty>::
+operator=(const Transform3& other)
+{
+    // the buffer of `affine` is never shared, copy the entries only
+    std::copy(other.affine.GetData().begin(), other.affine.GetData().end(), this->affine.GetData().begin());
+    this->kind = other.kind;
+    return *this;
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>
+MatrixMath::Transform3<_Ty>::
+Translation(const _Ty x, const _Ty y, const _Ty z)
+{
+    return Transform3(AffineType{
+        1, 0, 0, x,
+        0, 1, 0, y,
+        0, 0, 1, z,
+    });
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>
+MatrixMath::Transform3<_Ty>::
+Scaling(const _Ty x, const _Ty y, const _Ty z)
+{
+    return Transform3(AffineType{
+        x, 0, 0, 0,
+        0, y, 0, 0,
+        0, 0, z, 0,
+    });
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>
+MatrixMath::Transform3<_Ty>::
+Rotation(const _Ty x, const _Ty y, const _Ty z, const _Ty angle)
+{
+    // Rodrigues' rotation formula
+    const _Ty c{ std::cos(angle) };
+    const _Ty s{ std::sin(angle) };
+    const _Ty t{ 1 - c };
+    return Transform3(AffineType{
+        t * x * x + c,      t * x * y - s * z,  t * x * z + s * y,  0,
+        t * x * y + s * z,  t * y * y + c,      t * y * z - s * x,  0,
+        t * x * z - s * y,  t * y * z + s * x,  t * z * z + c,      0,
+    });
+}
+
+template <typename _Ty>
+inline MatrixMath::TransformKind
+MatrixMath::Transform3<_Ty>::
+GetKind() const
+{
+    return this->kind;
+}
+
+template <typename _Ty>
+inline const typename MatrixMath::Transform3<_Ty>::AffineType&
+MatrixMath::Transform3<_Ty>::
+GetAffine() const
+{
+    return this->affine;
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Transform3<_Ty>::
+GetElement(const int row, const int column) const
+{
+    if (row == 3)
+        return column == 3 ? _Ty(1) : _Ty(0);
+    return this->affine.GetElement(row, column);
+}
+
+template <typename _Ty>
+typename MatrixMath::Transform3<_Ty>::HomogeneousType
+MatrixMath::Transform3<_Ty>::
+ToMatrix() const
+{
+    HomogeneousType result;
+    for (int row = 0; row < 4; row++)
+        for (int column = 0; column < 4; column++)
+            result.GetElement(row, column) = this->GetElement(row, column);
+    return result;
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>
+MatrixMath::Transform3<_Ty>::
+Inverse() const
+{
+    // the inverse of [ L | t ] is [ inverse(L) | -inverse(L) * t ]
+    const _Ty* m{ this->affine.GetData().data() };
+    Transform3 result;
+    _Ty* r{ result.affine.GetData().data() };
+
+    if (this->kind == TransformKind::Rigid)
+    {
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 3; column++)
+                r[row * 4 + column] = m[column * 4 + row];
+    }
+    else if (this->kind == TransformKind::UniformScale)
+    {
+        // L = s * R, hence inverse(L) = L^T / s^2
+        const _Ty inv{ 1 / (m[0] * m[0] + m[4] * m[4] + m[8] * m[8]) };
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 3; column++)
+                r[row * 4 + column] = m[column * 4 + row] * inv;
+    }
+    else
+    {
+        // inverse(L) is the transpose of the normal matrix
+        const std::array<_Ty, 12> normal{ this->GetNormalMatrix() };
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 3; column++)
+                r[row * 4 + column] = normal[column * 4 + row];
+    }
+
+    for (int row = 0; row < 3; row++)
+        r[row * 4 + 3] = -(r[row * 4 + 0] * m[3] + r[row * 4 + 1] * m[7] + r[row * 4 + 2] * m[11]);
+    result.kind = this->kind;
+    return result;
+}
+
+template <typename _Ty>
+void
+MatrixMath::Transform3<_Ty>::
+TransformPoints(const _Ty* xyz, _Ty* out, const std::size_t count) const
+{
+    detail::AffineTransformInterleaved(this->affine.GetData().data(), _Ty(1), xyz, out, count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::Transform3<_Ty>::
+TransformPoints(const _Ty* x, const _Ty* y, const _Ty* z,
+    _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count) const
+{
+    detail::AffineTransformSoA(this->affine.GetData().data(), _Ty(1), x, y, z, outX, outY, outZ, count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::Transform3<_Ty>::
+TransformNormals(const _Ty* xyz, _Ty* out, const std::size_t count) const
+{
+    const std::array<_Ty, 12> normal{ this->GetNormalMatrix() };
+    detail::AffineTransformInterleaved(normal.data(), _Ty(0), xyz, out, count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::Transform3<_Ty>::
+TransformNormals(const _Ty* x, const _Ty* y, const _Ty* z,
+    _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count) const
+{
+    const std::array<_Ty, 12> normal{ this->GetNormalMatrix() };
+    detail::AffineTransformSoA(normal.data(), _Ty(0), x, y, z, outX, outY, outZ, count);
+}
+
+template <typename _Ty>
+std::array<_Ty, 12>
+MatrixMath::Transform3<_Ty>::
+GetNormalMatrix() const
+{
+    const _Ty* m{ this->affine.GetData().data() };
+    std::array<_Ty, 12> result;
+
+    // inverse(L)^T is L itself for a rotation, L / s^2 for a scaled rotation
+    if (this->kind != TransformKind::Affine)
+    {
+        const _Ty inv{ this->kind == TransformKind::Rigid ? _Ty(1) : 1 / (m[0] * m[0] + m[4] * m[4] + m[8] * m[8]) };
+        for (int index = 0; index < 12; index++)
+            result[index] = index % 4 == 3 ? _Ty(0) : m[index] * inv;
+        return result;
+    }
+
+    // with a, b, c the rows of L, the rows of inverse(L)^T are
+    //      (b x c, c x a, a x b) / det(L)
+    const _Ty* a{ m + 0 };
+    const _Ty* b{ m + 4 };
+    const _Ty* c{ m + 8 };
+    const auto cross = [](const _Ty* u, const _Ty* v, _Ty* w) {
+        w[0] = u[1] * v[2] - u[2] * v[1];
+        w[1] = u[2] * v[0] - u[0] * v[2];
+        w[2] = u[0] * v[1] - u[1] * v[0];
+        w[3] = 0;
+    };
+
+    cross(b, c, result.data() + 0);
+    cross(c, a, result.data() + 4);
+    cross(a, b, result.data() + 8);
+
+    const _Ty det{ a[0] * result[0] + a[1] * result[1] + a[2] * result[2] };
+    assert(det != 0);
+    const _Ty inv{ 1 / det };
+    for (_Ty& entry : result)
+        entry *= inv;
+    return result;
+}
+
+template <typename _Ty>
+void
+MatrixMath::Transform3<_Ty>::
+TransformBox(const _Ty* min, const _Ty* max, _Ty* outMin, _Ty* outMax) const
+{
+    const _Ty* m{ this->affine.GetData().data() };
+    _Ty resultMin[3], resultMax[3];
+    for (int row = 0; row < 3; row++)
+    {
+        resultMin[row] = resultMax[row] = m[row * 4 + 3];
+        for (int column = 0; column < 3; column++)
+        {
+            const _Ty a{ m[row * 4 + column] * min[column] };
+            const _Ty b{ m[row * 4 + column] * max[column] };
+            resultMin[row] += std::min(a, b);
+            resultMax[row] += std::max(a, b);
+        }
+    }
+    std::copy(resultMin, resultMin + 3, outMin);
+    std::copy(resultMax, resultMax + 3, outMax);
+}
+
+template <typename _Ty>
+void
+MatrixMath::Transform3<_Ty>::
+TransformBoxes(const _Ty* cx, const _Ty* cy, const _Ty* cz,
+    const _Ty* ex, const _Ty* ey, const _Ty* ez,
+    _Ty* outCX, _Ty* outCY, _Ty* outCZ,
+    _Ty* outEX, _Ty* outEY, _Ty* outEZ, const std::size_t count) const
+{
+    const _Ty* m{ this->affine.GetData().data() };
+    std::array<_Ty, 12> magnitude;
+    for (int index = 0; index < 12; index++)
+        magnitude[index] = index % 4 == 3 ? _Ty(0) : std::abs(m[index]);
+
+    detail::AffineTransformSoA(m, _Ty(1), cx, cy, cz, outCX, outCY, outCZ, count);
+    detail::AffineTransformSoA(magnitude.data(), _Ty(0), ex, ey, ez, outEX, outEY, outEZ, count);
+}
+
+template <typename _Ty>
+const std::string
+MatrixMath::Transform3<_Ty>::
+ToString() const
+{
+    return this->affine.ToString();
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>
+MatrixMath::
+operator*(const Transform3<_Ty>& lhs, const Transform3<_Ty>& rhs)
+{
+    Transform3<_Ty> result;
+    detail::AffineCompose(lhs.affine.GetData().data(), rhs.affine.GetData().data(), result.affine.GetData().data());
+    result.kind = std::max(lhs.kind, rhs.kind);
+    return result;
+}
+
+// Projective3
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>::
+Projective3()
+    : matrix{
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, 1, 0,
+        0, 0, 0, 1,
+    }
+{
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>::
+Projective3(const Projective3& other)
+    : matrix(other.matrix)
+{
+}
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Projective3<_Ty>::
+Projective3(const MatrixQ<_Ty, 4, order>& matrix)
+{
+    for (int row = 0; row < 4; row++)
+        for (int column = 0; column < 4; column++)
+            this->matrix.GetElement(row, column) = matrix.GetElement(row, column);
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>::
+Projective3(const Transform3<_Ty>& transform)
+{
+    for (int row = 0; row < 4; row++)
+        for (int column = 0; column < 4; column++)
+            this->matrix.GetElement(row, column) = transform.GetElement(row, column);
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>&
+MatrixMath::Projective3<_Ty>::
+operator=(const Projective3& other)
+{
+    std::copy(other.matrix.GetData().begin(), other.matrix.GetData().end(), this->matrix.GetData().begin());
+    return *this;
+}
+
+template <typename _Ty>
+inline constexpr MatrixMath::TransformKind
+MatrixMath::Projective3<_Ty>::
+GetKind() const
+{
+    return TransformKind::Projective;
+}
+
+template <typename _Ty>
+inline const typename MatrixMath::Projective3<_Ty>::HomogeneousType&
+MatrixMath::Projective3<_Ty>::
+GetMatrix() const
+{
+    return this->matrix;
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Projective3<_Ty>::
+GetElement(const int row, const int column) const
+{
+    return this->matrix.GetElement(row, column);
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>
+MatrixMath::Projective3<_Ty>::
+Inverse() const
+{
+    // Laplace expansion along the (2 x 2) minors of the upper two rows (s)
+    // and of the lower two rows (c), every minor being computed once
+    const _Ty* a{ this->matrix.GetData().data() };
+
+    const _Ty s0{ a[0] * a[5] - a[4] * a[1] };
+    const _Ty s1{ a[0] * a[6] - a[4] * a[2] };
+    const _Ty s2{ a[0] * a[7] - a[4] * a[3] };
+    const _Ty s3{ a[1] * a[6] - a[5] * a[2] };
+    const _Ty s4{ a[1] * a[7] - a[5] * a[3] };
+    const _Ty s5{ a[2] * a[7] - a[6] * a[3] };
+
+    const _Ty c5{ a[10] * a[15] - a[14] * a[11] };
+    const _Ty c4{ a[9] * a[15] - a[13] * a[11] };
+    const _Ty c3{ a[9] * a[14] - a[13] * a[10] };
+    const _Ty c2{ a[8] * a[15] - a[12] * a[11] };
+    const _Ty c1{ a[8] * a[14] - a[12] * a[10] };
+    const _Ty c0{ a[8] * a[13] - a[12] * a[9] };
+
+    const _Ty det{ s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0 };
+    assert(det != 0);
+    const _Ty inv{ 1 / det };
+
+    Projective3 result;
+    _Ty* b{ result.matrix.GetData().data() };
+    b[0] = (a[5] * c5 - a[6] * c4 + a[7] * c3) * inv;
+    b[1] = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * inv;
+    b[2] = (a[13] * s5 - a[14] * s4 + a[15] * s3) * inv;
+    b[3] = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * inv;
+    b[4] = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * inv;
+    b[5] = (a[0] * c5 - a[2] * c2 + a[3] * c1) * inv;
+    b[6] = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv;
+    b[7] = (a[8] * s5 - a[10] * s2 + a[11] * s1) * inv;
+    b[8] = (a[4] * c4 - a[5] * c2 + a[7] * c0) * inv;
+    b[9] = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * inv;
+    b[10] = (a[12] * s4 - a[13] * s2 + a[15] * s0) * inv;
+    b[11] = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * inv;
+    b[12] = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * inv;
+    b[13] = (a[0] * c3 - a[1] * c1 + a[2] * c0) * inv;
+    b[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv;
+    b[15] = (a[8] * s3 - a[9] * s1 + a[10] * s0) * inv;
+    return result;
+}
+
+template <typename _Ty>
+const std::string
+MatrixMath::Projective3<_Ty>::
+ToString() const
+{
+    return this->matrix.ToString();
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>
+MatrixMath::
+operator*(const Projective3<_Ty>& lhs, const Projective3<_Ty>& rhs)
+{
+    return Projective3<_Ty>(lhs.GetMatrix() * rhs.GetMatrix());
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>
+MatrixMath::
+operator*(const Projective3<_Ty>& lhs, const Transform3<_Ty>& rhs)
+{
+    return Projective3<_Ty>(lhs.GetMatrix() * rhs.ToMatrix());
+}
+
+template <typename _Ty>
+MatrixMath::Projective3<_Ty>
+MatrixMath::
+operator*(const Transform3<_Ty>& lhs, const Projective3<_Ty>& rhs)
+{
+    return Projective3<_Ty>(lhs.ToMatrix() * rhs.GetMatrix());
+}
+
+// Quaternion
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>::
+Quaternion()
+    : data{ 0, 0, 0, 1 }
+{
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>::
+Quaternion(const _Ty w, const _Ty x, const _Ty y, const _Ty z)
+    : data{ x, y, z, w }
+{
+}
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Quaternion<_Ty>::
+Quaternion(const MatrixQ<_Ty, 3, order>& rotation)
+{
+    _Ty m[9];
+    for (int row = 0; row < 3; row++)
+        for (int column = 0; column < 3; column++)
+            m[row * 3 + column] = rotation.GetElement(row, column);
+    detail::RotationsToQuaternions(m, this->data.data(), 1);
+}
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Quaternion<_Ty>::
+Quaternion(const MatrixQ<_Ty, 4, order>& rotation)
+{
+    _Ty m[9];
+    for (int row = 0; row < 3; row++)
+        for (int column = 0; column < 3; column++)
+            m[row * 3 + column] = rotation.GetElement(row, column);
+    detail::RotationsToQuaternions(m, this->data.data(), 1);
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::Quaternion<_Ty>::
+AxisAngle(const _Ty x, const _Ty y, const _Ty z, const _Ty angle)
+{
+    const _Ty s{ std::sin(angle / 2) };
+    return Quaternion(std::cos(angle / 2), x * s, y * s, z * s);
+}
+
+template <typename _Ty>
+inline const typename MatrixMath::Quaternion<_Ty>::data_t&
+MatrixMath::Quaternion<_Ty>::
+GetData() const
+{
+    return this->data;
+}
+
+template <typename _Ty>
+inline typename MatrixMath::Quaternion<_Ty>::data_t&
+MatrixMath::Quaternion<_Ty>::
+GetData()
+{
+    return this->data;
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Quaternion<_Ty>::
+GetX() const
+{
+    return this->data[0];
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Quaternion<_Ty>::
+GetY() const
+{
+    return this->data[1];
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Quaternion<_Ty>::
+GetZ() const
+{
+    return this->data[2];
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Quaternion<_Ty>::
+GetW() const
+{
+    return this->data[3];
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Quaternion<_Ty>::
+Dot(const Quaternion& other) const
+{
+    return this->data[0] * other.data[0] + this->data[1] * other.data[1]
+        + this->data[2] * other.data[2] + this->data[3] * other.data[3];
+}
+
+template <typename _Ty>
+inline _Ty
+MatrixMath::Quaternion<_Ty>::
+Norm() const
+{
+    return std::sqrt(this->Dot(*this));
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::Quaternion<_Ty>::
+Normalize() const
+{
+    const _Ty inv{ 1 / this->Norm() };
+    return Quaternion(this->data[3] * inv, this->data[0] * inv, this->data[1] * inv, this->data[2] * inv);
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::Quaternion<_Ty>::
+Conjugate() const
+{
+    return Quaternion(this->data[3], -this->data[0], -this->data[1], -this->data[2]);
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::Quaternion<_Ty>::
+Inverse() const
+{
+    const _Ty inv{ 1 / this->Dot(*this) };
+    return Quaternion(this->data[3] * inv, -this->data[0] * inv, -this->data[1] * inv, -this->data[2] * inv);
+}
+
+template <typename _Ty>
+MatrixMath::MatrixQ<_Ty, 3>
+MatrixMath::Quaternion<_Ty>::
+ToMatrix3() const
+{
+    MatrixQ<_Ty, 3> result;
+    detail::QuaternionsToRotations(this->data.data(), result.GetData().data(), 1);
+    return result;
+}
+
+template <typename _Ty>
+MatrixMath::MatrixQ<_Ty, 4>
+MatrixMath::Quaternion<_Ty>::
+ToMatrix4() const
+{
+    _Ty m[9];
+    detail::QuaternionsToRotations(this->data.data(), m, 1);
+    return MatrixQ<_Ty, 4>{
+        m[0], m[1], m[2], 0,
+        m[3], m[4], m[5], 0,
+        m[6], m[7], m[8], 0,
+        0,    0,    0,    1,
+    };
+}
+
+template <typename _Ty>
+MatrixMath::Transform3<_Ty>
+MatrixMath::Quaternion<_Ty>::
+ToTransform() const
+{
+    _Ty m[9];
+    detail::QuaternionsToRotations(this->data.data(), m, 1);
+    return Transform3<_Ty>(Matrix<_Ty, 3, 4>{
+        m[0], m[1], m[2], 0,
+        m[3], m[4], m[5], 0,
+        m[6], m[7], m[8], 0,
+    });
+}
+
+template <typename _Ty>
+void
+MatrixMath::Quaternion<_Ty>::
+Rotate(const _Ty* xyz, _Ty* out, const std::size_t count) const
+{
+    _Ty m[12];
+    detail::QuaternionsToRotations(this->data.data(), m, 1);
+    // spread the (3 x 3) matrix over a (3 x 4) one, backwards to stay in place
+    for (int row = 2; row >= 0; row--)
+    {
+        m[row * 4 + 3] = 0;
+        for (int column = 2; column >= 0; column--)
+            m[row * 4 + column] = m[row * 3 + column];
+    }
+    detail::AffineTransformInterleaved(m, _Ty(0), xyz, out, count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::Quaternion<_Ty>::
+Rotate(const _Ty* x, const _Ty* y, const _Ty* z,
+    _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count) const
+{
+    _Ty m[12];
+    detail::QuaternionsToRotations(this->data.data(), m, 1);
+    for (int row = 2; row >= 0; row--)
+    {
+        m[row * 4 + 3] = 0;
+        for (int column = 2; column >= 0; column--)
+            m[row * 4 + column] = m[row * 3 + column];
+    }
+    detail::AffineTransformSoA(m, _Ty(0), x, y, z, outX, outY, outZ, count);
+}
+
+template <typename _Ty>
+const std::string
+MatrixMath::Quaternion<_Ty>::
+ToString() const
+{
+    // ( w, x, y, z ), a single row of the formatter
+    FormatOptions options{ FormatOptions::Pretty() };
+    options.rowPrefix = "( ";
+    options.columnSeparator = ", ";
+    options.rowSuffix = " )\n";
+    options.width = 0;
+
+    std::string text;
+    detail::FormatAppend(text, 1, 4,
+        [this](const int, const int column) -> const _Ty& { return this->data[(column + 3) % 4]; }, options);
+    return text;
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::
+operator*(const Quaternion<_Ty>& lhs, const Quaternion<_Ty>& rhs)
+{
+    Quaternion<_Ty> result;
+    detail::QuaternionMultiply(lhs.GetData().data(), rhs.GetData().data(), result.GetData().data());
+    return result;
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::
+Nlerp(const Quaternion<_Ty>& from, const Quaternion<_Ty>& to, const _Ty t)
+{
+    // q and -q are the same rotation, go towards the closer one
+    const _Ty u{ from.Dot(to) < 0 ? -t : t };
+    const _Ty v{ 1 - t };
+    return Quaternion<_Ty>(
+        v * from.GetW() + u * to.GetW(),
+        v * from.GetX() + u * to.GetX(),
+        v * from.GetY() + u * to.GetY(),
+        v * from.GetZ() + u * to.GetZ()).Normalize();
+}
+
+template <typename _Ty>
+MatrixMath::Quaternion<_Ty>
+MatrixMath::
+Slerp(const Quaternion<_Ty>& from, const Quaternion<_Ty>& to, const _Ty t)
+{
+    _Ty cosine{ from.Dot(to) };
+    const _Ty sign{ cosine < 0 ? _Ty(-1) : _Ty(1) };
+    cosine *= sign;
+
+    // sin(theta) vanishes for close rotations, where both interpolations agree
+    if (cosine > 1 - std::numeric_limits<_Ty>::epsilon() * 64)
+        return Nlerp(from, to, t);
+
+    const _Ty theta{ std::acos(cosine) };
+    const _Ty inv{ 1 / std::sin(theta) };
+    const _Ty v{ std::sin((1 - t) * theta) * inv };
+    const _Ty u{ std::sin(t * theta) * inv * sign };
+    return Quaternion<_Ty>(
+        v * from.GetW() + u * to.GetW(),
+        v * from.GetX() + u * to.GetX(),
+        v * from.GetY() + u * to.GetY(),
+        v * from.GetZ() + u * to.GetZ());
+}
+
+template <typename _Ty>
+void
+MatrixMath::
+QuaternionsToMatrices(const Quaternion<_Ty>* quaternions, _Ty* matrices, const std::size_t count)
+{
+    static_assert(sizeof(Quaternion<_Ty>) == 4 * sizeof(_Ty), "Quaternion must be made of its 4 entries only!");
+    detail::QuaternionsToRotations(reinterpret_cast<const _Ty*>(quaternions), matrices, count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::
+MatricesToQuaternions(const _Ty* matrices, Quaternion<_Ty>* quaternions, const std::size_t count)
+{
+    static_assert(sizeof(Quaternion<_Ty>) == 4 * sizeof(_Ty), "Quaternion must be made of its 4 entries only!");
+    detail::RotationsToQuaternions(matrices, reinterpret_cast<_Ty*>(quaternions), count);
+}
+
+// Frustum
+
+template <typename _Ty>
+template <typename order>
+MatrixMath::Frustum<_Ty>::
+Frustum(const MatrixQ<_Ty, 4, order>& matrix, const ClipDepth depth)
+{
+    // every clip plane compares a clip coordinate with w:
+    // -w <= x is the plane (row 3 + row 0), x <= w is (row 3 - row 0), etc.
+    const auto combine = [&matrix](const int row, const _Ty sign) {
+        PlaneType plane;
+        for (int column = 0; column < 4; column++)
+            plane[column] = (row < 0 ? _Ty(0) : sign * matrix.GetElement(row, column)) + matrix.GetElement(3, column);
+        return plane;
+    };
+
+    this->planes[Left] = combine(0, 1);
+    this->planes[Right] = combine(0, -1);
+    this->planes[Bottom] = combine(1, 1);
+    this->planes[Top] = combine(1, -1);
+    this->planes[Far] = combine(2, -1);
+    if (depth == ClipDepth::ZeroToOne)
+    {
+        // 0 <= z
+        for (int column = 0; column < 4; column++)
+            this->planes[Near][column] = matrix.GetElement(2, column);
+    }
+    else
+    {
+        this->planes[Near] = combine(2, 1);
+    }
+
+    for (PlaneType& plane : this->planes)
+    {
+        const _Ty inv{ 1 / std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]) };
+        for (_Ty& entry : plane)
+            entry *= inv;
+    }
+}
+
+template <typename _Ty>
+MatrixMath::Frustum<_Ty>::
+Frustum(const Projective3<_Ty>& projection, const ClipDepth depth)
+    : Frustum(projection.GetMatrix(), depth)
+{
+}
+
+template <typename _Ty>
+inline const typename MatrixMath::Frustum<_Ty>::PlaneType&
+MatrixMath::Frustum<_Ty>::
+GetPlane(const int side) const
+{
+    return this->planes[side];
+}
+
+template <typename _Ty>
+void
+MatrixMath::Frustum<_Ty>::
+CullBoxes(const _Ty* cx, const _Ty* cy, const _Ty* cz,
+    const _Ty* ex, const _Ty* ey, const _Ty* ez,
+    std::uint32_t* visible, const std::size_t count) const
+{
+    detail::CullBoxes(this->planes[0].data(), 6, cx, cy, cz, ex, ey, ez, visible, count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::Frustum<_Ty>::
+CullSpheres(const _Ty* cx, const _Ty* cy, const _Ty* cz, const _Ty* radii,
+    std::uint32_t* visible, const std::size_t count) const
+{
+    detail::CullSpheres(this->planes[0].data(), 6, cx, cy, cz, radii, visible, count);
 }
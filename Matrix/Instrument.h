@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <type_traits>
+#include <vector>
+
+// Define MATRIX_INSTRUMENT (e.g. -DMATRIX_INSTRUMENT=1) to count the buffer
+// allocations, copies, moves, aliases and destructions of the matrices;
+// otherwise the hooks are empty inline functions, and compile out completely
+#if !defined(MATRIX_INSTRUMENT)
+#   define MATRIX_INSTRUMENT 0
+#endif
+
+namespace MatrixMath
+{
+    enum class MatrixEvent : unsigned char
+    {
+        // a buffer of entries was allocated, `bytes` long
+        Allocate,
+        // the entries of another matrix were copied into the new buffer
+        Copy,
+        // the buffer was taken over from a moved-from matrix
+        Move,
+        // the buffer of another matrix, block or file was shared
+        Alias,
+        // a matrix was destroyed
+        Destroy,
+    };
+
+    struct MatrixCounters
+    {
+        std::uint64_t allocations{ 0 };
+        std::uint64_t bytes{ 0 };
+        std::uint64_t copies{ 0 };
+        std::uint64_t moves{ 0 };
+        std::uint64_t aliases{ 0 };
+        std::uint64_t destructions{ 0 };
+    };
+
+    struct TypeCounters
+    {
+        // e.g. "float[3x3]", "double[4x1, column-major]"
+        std::string type;
+        MatrixCounters counters;
+    };
+
+    // Called on the thread of every event, after the counters were updated
+    using InstrumentCallback = void (*)(const MatrixEvent event, const char* type, const std::size_t bytes, void* context);
+
+    constexpr bool IsInstrumented{ MATRIX_INSTRUMENT != 0 };
+
+    // The counters of the matrix types with any event, summed over all
+    // the threads, including the exited ones; empty if not instrumented
+    std::vector<TypeCounters> SnapshotCounters();
+    // Zero the counters; the events of the other threads meanwhile may be lost
+    void ResetCounters();
+    // nullptr to remove it
+    void SetInstrumentCallback(const InstrumentCallback callback, void* context = nullptr);
+}
+
+namespace detail
+{
+#if MATRIX_INSTRUMENT
+    constexpr int InstrumentEvents{ 5 };
+    // types beyond this share the last counters, named "(other)"
+    constexpr int MaxInstrumentedTypes{ 256 };
+
+    // The counters of every type, by event, then the bytes allocated
+    using InstrumentSlots = std::array<std::array<std::uint64_t, InstrumentEvents + 1>, MaxInstrumentedTypes>;
+
+    // Written by its thread only, with plain relaxed loads and stores
+    // instead of read-modify-write operations, read by snapshots
+    struct InstrumentThread
+    {
+        std::array<std::array<std::atomic<std::uint64_t>, InstrumentEvents + 1>, MaxInstrumentedTypes> slots{};
+    };
+
+    struct InstrumentHook
+    {
+        MatrixMath::InstrumentCallback callback;
+        void* context;
+    };
+
+    // Never destroyed, so that the matrices destroyed at exit can still report
+    struct InstrumentRegistry
+    {
+        std::mutex mutex;
+        std::vector<std::string> types;
+        std::vector<InstrumentThread*> threads;
+        // the counters of the exited threads
+        InstrumentSlots retired{};
+        std::atomic<const InstrumentHook*> hook{ nullptr };
+        std::vector<const InstrumentHook*> hooks;
+
+        static InstrumentRegistry& Get()
+        {
+            static InstrumentRegistry* pRegistry{ new InstrumentRegistry };
+            return *pRegistry;
+        }
+
+        int Register(const std::string& type)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int id = 0; id < static_cast<int>(types.size()); id++)
+                if (types[id] == type)
+                    return id;
+            if (static_cast<int>(types.size()) == MaxInstrumentedTypes - 1)
+                types.push_back("(other)");
+            if (static_cast<int>(types.size()) == MaxInstrumentedTypes)
+                return MaxInstrumentedTypes - 1;
+            types.push_back(type);
+            return static_cast<int>(types.size()) - 1;
+        }
+    };
+
+    // The counters of this thread, trivially destructible so that
+    // reading it needs no initialization check
+    inline thread_local InstrumentThread* pInstrumentThread{ nullptr };
+
+    // Registers the counters of this thread on first use,
+    // and merges them into the retired ones when it exits
+    class InstrumentThreadOwner
+    {
+    private:
+        InstrumentThread* pThread{ nullptr };
+        bool isExited{ false };
+
+    public:
+        ~InstrumentThreadOwner()
+        {
+            InstrumentRegistry& registry{ InstrumentRegistry::Get() };
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (pThread != nullptr)
+            {
+                for (int type = 0; type < MaxInstrumentedTypes; type++)
+                    for (int slot = 0; slot <= InstrumentEvents; slot++)
+                        registry.retired[type][slot] += pThread->slots[type][slot].load(std::memory_order_relaxed);
+                registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), pThread));
+                delete pThread;
+                pThread = nullptr;
+            }
+            pInstrumentThread = nullptr;
+            isExited = true;
+        }
+
+        // nullptr once the thread is exiting
+        InstrumentThread* Get()
+        {
+            if (pThread == nullptr && !isExited)
+            {
+                pThread = new InstrumentThread;
+                InstrumentRegistry& registry{ InstrumentRegistry::Get() };
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.threads.push_back(pThread);
+            }
+            return pInstrumentThread = pThread;
+        }
+    };
+
+    inline InstrumentThread* AttachInstrumentThread()
+    {
+        thread_local InstrumentThreadOwner owner;
+        return owner.Get();
+    }
+
+    inline void RecordEvent(const int type, const char* name, const MatrixMath::MatrixEvent event, const std::size_t bytes)
+    {
+        const int slot{ static_cast<int>(event) };
+        InstrumentThread* pThread{ pInstrumentThread };
+        if (pThread == nullptr)
+            pThread = AttachInstrumentThread();
+
+        if (pThread != nullptr)
+        {
+            auto& counters{ pThread->slots[type] };
+            counters[slot].store(counters[slot].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (bytes != 0)
+                counters[InstrumentEvents].store(counters[InstrumentEvents].load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+        }
+        else
+        {
+            // matrices destroyed after the counters of their thread
+            InstrumentRegistry& registry{ InstrumentRegistry::Get() };
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.retired[type][slot]++;
+            registry.retired[type][InstrumentEvents] += bytes;
+        }
+
+        static const std::atomic<const InstrumentHook*>& hook{ InstrumentRegistry::Get().hook };
+        if (const InstrumentHook* pHook = hook.load(std::memory_order_acquire))
+            pHook->callback(event, name, bytes, pHook->context);
+    }
+
+    template <typename _Ty>
+    std::string InstrumentElementName()
+    {
+        if constexpr (std::is_same_v<_Ty, float>)
+            return "float";
+        else if constexpr (std::is_same_v<_Ty, double>)
+            return "double";
+        else if constexpr (std::is_same_v<_Ty, int>)
+            return "int";
+        else if constexpr (std::is_same_v<_Ty, long long>)
+            return "long long";
+        else
+            return typeid(_Ty).name();
+    }
+
+    // Local statics, so that matrices constructed at static initialization can report
+    template <typename _Ty, int Height, int Width, typename order>
+    struct InstrumentedType
+    {
+        static const std::string& Name()
+        {
+            static const std::string name{ InstrumentElementName<_Ty>() + "[" + std::to_string(Height) + "x"
+                + std::to_string(Width) + (order::IsRowMajor() ? "]" : ", column-major]") };
+            return name;
+        }
+
+        static int Id()
+        {
+            static const int id{ InstrumentRegistry::Get().Register(Name()) };
+            return id;
+        }
+    };
+#endif
+
+    // Report an event of a (Height x Width) matrix of `_Ty` stored in `order`
+    template <typename _Ty, int Height, int Width, typename order>
+    inline void Instrument(const MatrixMath::MatrixEvent event, const std::size_t bytes = 0)
+    {
+#if MATRIX_INSTRUMENT
+        using Type = InstrumentedType<_Ty, Height, Width, order>;
+        RecordEvent(Type::Id(), Type::Name().c_str(), event, bytes);
+#else
+        (void)event;
+        (void)bytes;
+#endif
+    }
+}
+
+
+inline std::vector<MatrixMath::TypeCounters>
+MatrixMath::
+SnapshotCounters()
+{
+    std::vector<TypeCounters> result;
+#if MATRIX_INSTRUMENT
+    detail::InstrumentRegistry& registry{ detail::InstrumentRegistry::Get() };
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int type = 0; type < static_cast<int>(registry.types.size()); type++)
+    {
+        std::array<std::uint64_t, detail::InstrumentEvents + 1> sums{ registry.retired[type] };
+        for (const detail::InstrumentThread* pThread : registry.threads)
+            for (int slot = 0; slot <= detail::InstrumentEvents; slot++)
+                sums[slot] += pThread->slots[type][slot].load(std::memory_order_relaxed);
+
+        TypeCounters counters;
+        counters.type = registry.types[type];
+        counters.counters.allocations = sums[static_cast<int>(MatrixEvent::Allocate)];
+        counters.counters.copies = sums[static_cast<int>(MatrixEvent::Copy)];
+        counters.counters.moves = sums[static_cast<int>(MatrixEvent::Move)];
+        counters.counters.aliases = sums[static_cast<int>(MatrixEvent::Alias)];
+        counters.counters.destructions = sums[static_cast<int>(MatrixEvent::Destroy)];
+        counters.counters.bytes = sums[detail::InstrumentEvents];
+        if (counters.counters.allocations + counters.counters.copies + counters.counters.moves
+            + counters.counters.aliases + counters.counters.destructions > 0)
+            result.push_back(std::move(counters));
+    }
+#endif
+    return result;
+}
+
+inline void
+MatrixMath::
+ResetCounters()
+{
+#if MATRIX_INSTRUMENT
+    detail::InstrumentRegistry& registry{ detail::InstrumentRegistry::Get() };
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired = {};
+    for (detail::InstrumentThread* pThread : registry.threads)
+        for (auto& counters : pThread->slots)
+            for (auto& counter : counters)
+                counter.store(0, std::memory_order_relaxed);
+#endif
+}
+
+inline void
+MatrixMath::
+SetInstrumentCallback(const InstrumentCallback callback, void* context)
+{
+#if MATRIX_INSTRUMENT
+    detail::InstrumentRegistry& registry{ detail::InstrumentRegistry::Get() };
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const detail::InstrumentHook* pHook{ nullptr };
+    if (callback != nullptr)
+    {
+        // kept alive, since another thread may be calling the previous one
+        registry.hooks.push_back(new detail::InstrumentHook{ callback, context });
+        pHook = registry.hooks.back();
+    }
+    registry.hook.store(pHook, std::memory_order_release);
+#else
+    (void)callback;
+    (void)context;
+#endif
+}
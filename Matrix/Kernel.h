@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "Cpu.h"
+#include "Tuning.h"
+
+// Low-level kernels shared by the algorithms of MatrixMath.
+// They work on raw buffers and know nothing about Matrix itself.
+//
+// Each kernel is written once in KernelLevel.h over the packs of an
+// instruction set level, and compiled for every level (see MATRIX_DISPATCH
+// in Cpu.h); the functions below call the one of the level in use out of
+// a table holding every level. The kernels working on a single small
+// matrix, for which the indirect call would cost more than the wider
+// packs save, run the level the compiler targets.
+
+#if MATRIX_DISPATCH || MATRIX_BASELINE_LEVEL > 0
+#   include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace detail
+{
+    // `count` vectors of N entries stored one after another (AoS)
+    template <typename _Ty, int N>
+    struct InterleavedVectors
+    {
+        using ElementType = std::remove_const_t<_Ty>;
+
+        _Ty* data;
+    };
+
+    // `count` vectors of N entries stored as N arrays, one per entry (SoA)
+    template <typename _Ty, int N>
+    struct SeparateVectors
+    {
+        using ElementType = std::remove_const_t<_Ty>;
+
+        _Ty* components[N];
+
+        explicit SeparateVectors(_Ty* const (&components)[N])
+        {
+            std::copy(components, components + N, this->components);
+        }
+    };
+}
+
+#if MATRIX_DISPATCH
+#   define MATRIX_KERNEL_LEVEL 0
+#   define MATRIX_KERNEL_NAMESPACE scalar
+#   include "KernelLevel.h"
+#   define MATRIX_KERNEL_LEVEL 1
+#   define MATRIX_KERNEL_NAMESPACE sse2
+#   include "KernelLevel.h"
+#   define MATRIX_KERNEL_LEVEL 2
+#   define MATRIX_KERNEL_NAMESPACE sse42
+#   include "KernelLevel.h"
+#   define MATRIX_KERNEL_LEVEL 3
+#   define MATRIX_KERNEL_NAMESPACE avx2
+#   include "KernelLevel.h"
+#   define MATRIX_KERNEL_LEVEL 4
+#   define MATRIX_KERNEL_NAMESPACE avx512
+#   include "KernelLevel.h"
+#else
+#   define MATRIX_KERNEL_LEVEL MATRIX_BASELINE_LEVEL
+#   define MATRIX_KERNEL_NAMESPACE compiled
+#   include "KernelLevel.h"
+#endif
+
+// The kernels of every level, in the order of IsaLevel
+#define MATRIX_KERNEL_TABLE(...) { &::detail::scalar::__VA_ARGS__, &::detail::sse2::__VA_ARGS__, \
+    &::detail::sse42::__VA_ARGS__, &::detail::avx2::__VA_ARGS__, &::detail::avx512::__VA_ARGS__ }
+
+namespace detail
+{
+#if !MATRIX_DISPATCH
+    // every level runs the kernels of the level the compiler targets
+    namespace scalar = compiled;
+    namespace sse2 = compiled;
+    namespace sse42 = compiled;
+    namespace avx2 = compiled;
+    namespace avx512 = compiled;
+#elif MATRIX_BASELINE_LEVEL == 4
+    namespace compiled = avx512;
+#elif MATRIX_BASELINE_LEVEL == 3
+    namespace compiled = avx2;
+#elif MATRIX_BASELINE_LEVEL == 2
+    namespace compiled = sse42;
+#elif MATRIX_BASELINE_LEVEL == 1
+    namespace compiled = sse2;
+#else
+    namespace compiled = scalar;
+#endif
+
+    // called on single matrices and quaternions
+    using compiled::ScalarPack;
+    using compiled::DotProduct;
+    using compiled::AffineCompose;
+    using compiled::QuaternionMultiply;
+    using compiled::LowestSetBit;
+
+    // Matrices of fewer entries are not worth the indirect call
+    constexpr int MinDispatchedEntries{ 64 };
+
+    // The kernel of the level in use, out of one per IsaLevel
+    template <typename _Fn>
+    inline _Fn Dispatched(const _Fn (&kernels)[MatrixMath::IsaLevelCount])
+    {
+        return kernels[CurrentIsaLevel()];
+    }
+
+    template <typename _Ty>
+    void TransposeBlock(const _Ty* src, const int srcStride, _Ty* dst, const int dstStride,
+        const int rows, const int columns)
+    {
+        if (rows <= MatrixMath::MinTransposeLeafSize && columns <= MatrixMath::MinTransposeLeafSize)
+        {
+            compiled::TransposeLeaf(src, srcStride, dst, dstStride, rows, columns);
+            return;
+        }
+        static constexpr decltype(&compiled::TransposeBlock<_Ty>) kernels[] MATRIX_KERNEL_TABLE(TransposeBlock<_Ty>);
+        Dispatched(kernels)(src, srcStride, dst, dstStride, rows, columns, 0);
+    }
+
+    template <typename _Ty>
+    void TransposeSquareInPlace(_Ty* data, const int stride, const int n)
+    {
+        if (n <= MatrixMath::MinTransposeLeafSize)
+        {
+            compiled::TransposeSquareInPlace(data, stride, n, MatrixMath::MinTransposeLeafSize);
+            return;
+        }
+        static constexpr decltype(&compiled::TransposeSquareInPlace<_Ty>) kernels[] MATRIX_KERNEL_TABLE(TransposeSquareInPlace<_Ty>);
+        Dispatched(kernels)(data, stride, n, 0);
+    }
+
+    template <typename _Ty>
+    void MultiplyAddBlock(const _Ty* a, const int lda, const _Ty* b, const int ldb,
+        _Ty* c, const int ldc, const int m, const int n, const int k)
+    {
+        static constexpr decltype(&compiled::MultiplyAddBlock<_Ty>) kernels[] MATRIX_KERNEL_TABLE(MultiplyAddBlock<_Ty>);
+        Dispatched(kernels)(a, lda, b, ldb, c, ldc, m, n, k);
+    }
+
+    template <typename _Ty>
+    void AddEntries(_Ty* lhs, const _Ty* rhs, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::AddEntries<_Ty>) kernels[] MATRIX_KERNEL_TABLE(AddEntries<_Ty>);
+        Dispatched(kernels)(lhs, rhs, count);
+    }
+
+    template <typename _Ty>
+    void SubtractEntries(_Ty* lhs, const _Ty* rhs, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::SubtractEntries<_Ty>) kernels[] MATRIX_KERNEL_TABLE(SubtractEntries<_Ty>);
+        Dispatched(kernels)(lhs, rhs, count);
+    }
+
+    template <typename _Ty>
+    void MultiplyEntries(_Ty* lhs, const _Ty factor, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::MultiplyEntries<_Ty>) kernels[] MATRIX_KERNEL_TABLE(MultiplyEntries<_Ty>);
+        Dispatched(kernels)(lhs, factor, count);
+    }
+
+    template <typename _Ty>
+    void DivideEntries(_Ty* lhs, const _Ty divisor, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::DivideEntries<_Ty>) kernels[] MATRIX_KERNEL_TABLE(DivideEntries<_Ty>);
+        Dispatched(kernels)(lhs, divisor, count);
+    }
+
+    template <typename _Ty>
+    void EliminateColumn(_Ty* data, const int n, const int pivot, const int* rows, const int count, const int k)
+    {
+        static constexpr decltype(&compiled::EliminateColumn<_Ty>) kernels[] MATRIX_KERNEL_TABLE(EliminateColumn<_Ty>);
+        Dispatched(kernels)(data, n, pivot, rows, count, k);
+    }
+
+    template <typename _Ty>
+    void AffineTransformSoA(const _Ty* m, const _Ty w,
+        const _Ty* x, const _Ty* y, const _Ty* z,
+        _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::AffineTransformSoA<_Ty>) kernels[] MATRIX_KERNEL_TABLE(AffineTransformSoA<_Ty>);
+        Dispatched(kernels)(m, w, x, y, z, outX, outY, outZ, count);
+    }
+
+    template <typename _Ty>
+    void AffineTransformInterleaved(const _Ty* m, const _Ty w,
+        const _Ty* xyz, _Ty* out, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::AffineTransformInterleaved<_Ty>) kernels[] MATRIX_KERNEL_TABLE(AffineTransformInterleaved<_Ty>);
+        Dispatched(kernels)(m, w, xyz, out, count);
+    }
+
+    template <typename _Ty>
+    void QuaternionsToRotations(const _Ty* quaternions, _Ty* matrices, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::QuaternionsToRotations<_Ty>) kernels[] MATRIX_KERNEL_TABLE(QuaternionsToRotations<_Ty>);
+        Dispatched(kernels)(quaternions, matrices, count);
+    }
+
+    template <typename _Ty>
+    void RotationsToQuaternions(const _Ty* matrices, _Ty* quaternions, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::RotationsToQuaternions<_Ty>) kernels[] MATRIX_KERNEL_TABLE(RotationsToQuaternions<_Ty>);
+        Dispatched(kernels)(matrices, quaternions, count);
+    }
+
+    template <typename _Ty>
+    void CullBoxes(const _Ty* planes, const int planeCount,
+        const _Ty* cx, const _Ty* cy, const _Ty* cz,
+        const _Ty* ex, const _Ty* ey, const _Ty* ez,
+        std::uint32_t* visible, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::CullBoxes<_Ty>) kernels[] MATRIX_KERNEL_TABLE(CullBoxes<_Ty>);
+        Dispatched(kernels)(planes, planeCount, cx, cy, cz, ex, ey, ez, visible, count);
+    }
+
+    template <typename _Ty>
+    void CullSpheres(const _Ty* planes, const int planeCount,
+        const _Ty* cx, const _Ty* cy, const _Ty* cz, const _Ty* radii,
+        std::uint32_t* visible, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::CullSpheres<_Ty>) kernels[] MATRIX_KERNEL_TABLE(CullSpheres<_Ty>);
+        Dispatched(kernels)(planes, planeCount, cx, cy, cz, radii, visible, count);
+    }
+
+    template <int N, typename _In>
+    void BatchDot(const _In& lhs, const _In& rhs, typename _In::ElementType* out, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::BatchDot<N, _In>) kernels[] MATRIX_KERNEL_TABLE(BatchDot<N, _In>);
+        Dispatched(kernels)(lhs, rhs, out, count);
+    }
+
+    template <int N, bool Root, typename _In>
+    void BatchNorm(const _In& in, typename _In::ElementType* out, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::BatchNorm<N, Root, _In>) kernels[] MATRIX_KERNEL_TABLE(BatchNorm<N, Root, _In>);
+        Dispatched(kernels)(in, out, count);
+    }
+
+    template <int N, bool Fast, typename _In, typename _Out>
+    void BatchNormalize(const _In& in, const _Out& out, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::BatchNormalize<N, Fast, _In, _Out>) kernels[]
+            MATRIX_KERNEL_TABLE(BatchNormalize<N, Fast, _In, _Out>);
+        Dispatched(kernels)(in, out, count);
+    }
+
+    template <typename _In, typename _Out>
+    void BatchCross(const _In& lhs, const _In& rhs, const _Out& out, const std::size_t count)
+    {
+        static constexpr decltype(&compiled::BatchCross<_In, _Out>) kernels[] MATRIX_KERNEL_TABLE(BatchCross<_In, _Out>);
+        Dispatched(kernels)(lhs, rhs, out, count);
+    }
+
+    inline const char* FindByte(const char* first, const char* last, const char byte)
+    {
+        static constexpr decltype(&compiled::FindByte) kernels[] MATRIX_KERNEL_TABLE(FindByte);
+        return Dispatched(kernels)(first, last, byte);
+    }
+
+    inline std::uint32_t Crc32c(const void* data, std::size_t size, std::uint32_t crc = 0)
+    {
+        static constexpr decltype(&compiled::Crc32c) kernels[] MATRIX_KERNEL_TABLE(Crc32c);
+        return Dispatched(kernels)(data, size, crc);
+    }
+}
@@ -0,0 +1,1718 @@
+// The kernels of one instruction set level, included by Kernel.h once
+// per level, hence without include guard: MATRIX_KERNEL_LEVEL (an IsaLevel)
+// selects the packs, MATRIX_KERNEL_NAMESPACE the namespace under detail.
+// The levels above the one the compiler targets are compiled for their
+// instruction set through the target pragmas, and only run when
+// the processor supports it
+
+#if !defined(MATRIX_KERNEL_LEVEL) || !defined(MATRIX_KERNEL_NAMESPACE)
+#   error "KernelLevel.h is included by Kernel.h only"
+#endif
+
+#define MATRIX_KERNEL_SSE2 (MATRIX_KERNEL_LEVEL >= 1)
+#define MATRIX_KERNEL_SSE42 (MATRIX_KERNEL_LEVEL >= 2)
+#define MATRIX_KERNEL_AVX (MATRIX_KERNEL_LEVEL >= 3)
+#define MATRIX_KERNEL_AVX2 (MATRIX_KERNEL_LEVEL >= 3)
+#define MATRIX_KERNEL_FMA (MATRIX_KERNEL_LEVEL >= 3)
+#define MATRIX_KERNEL_AVX512 (MATRIX_KERNEL_LEVEL >= 4)
+
+// MSVC accepts the intrinsics of every level anyway
+#if MATRIX_KERNEL_LEVEL > MATRIX_BASELINE_LEVEL && !defined(_MSC_VER)
+#   define MATRIX_KERNEL_TARGETED 1
+#   if defined(__clang__)
+#       if MATRIX_KERNEL_LEVEL == 1
+#           pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#       elif MATRIX_KERNEL_LEVEL == 2
+#           pragma clang attribute push (__attribute__((target("sse4.2"))), apply_to = function)
+#       elif MATRIX_KERNEL_LEVEL == 3
+#           pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#       else
+#           pragma clang attribute push (__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#       endif
+#   else
+#       pragma GCC push_options
+#       if MATRIX_KERNEL_LEVEL == 1
+#           pragma GCC target("sse2")
+#       elif MATRIX_KERNEL_LEVEL == 2
+#           pragma GCC target("sse4.2")
+#       elif MATRIX_KERNEL_LEVEL == 3
+#           pragma GCC target("avx2,fma")
+#       else
+#           pragma GCC target("avx512f,avx2,fma")
+#       endif
+#   endif
+#endif
+
+namespace detail::MATRIX_KERNEL_NAMESPACE
+{
+    // Transpose a small tile of fixed size held in registers
+    template <typename _Ty>
+    struct TransposeMicroKernel
+    {
+        // the edge length of the tile; 1 means no register kernel available
+        constexpr static int Size{ 1 };
+
+        inline static void run(const _Ty* src, const int, _Ty* dst, const int)
+        {
+            *dst = *src;
+        }
+    };
+
+#if MATRIX_KERNEL_AVX
+    template <>
+    struct TransposeMicroKernel<float>
+    {
+        constexpr static int Size{ 8 };
+
+        inline static void run(const float* src, const int srcStride, float* dst, const int dstStride)
+        {
+            const __m256 r0{ _mm256_loadu_ps(src + 0 * srcStride) };
+            const __m256 r1{ _mm256_loadu_ps(src + 1 * srcStride) };
+            const __m256 r2{ _mm256_loadu_ps(src + 2 * srcStride) };
+            const __m256 r3{ _mm256_loadu_ps(src + 3 * srcStride) };
+            const __m256 r4{ _mm256_loadu_ps(src + 4 * srcStride) };
+            const __m256 r5{ _mm256_loadu_ps(src + 5 * srcStride) };
+            const __m256 r6{ _mm256_loadu_ps(src + 6 * srcStride) };
+            const __m256 r7{ _mm256_loadu_ps(src + 7 * srcStride) };
+
+            const __m256 t0{ _mm256_unpacklo_ps(r0, r1) };
+            const __m256 t1{ _mm256_unpackhi_ps(r0, r1) };
+            const __m256 t2{ _mm256_unpacklo_ps(r2, r3) };
+            const __m256 t3{ _mm256_unpackhi_ps(r2, r3) };
+            const __m256 t4{ _mm256_unpacklo_ps(r4, r5) };
+            const __m256 t5{ _mm256_unpackhi_ps(r4, r5) };
+            const __m256 t6{ _mm256_unpacklo_ps(r6, r7) };
+            const __m256 t7{ _mm256_unpackhi_ps(r6, r7) };
+
+            const __m256 s0{ _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)) };
+            const __m256 s1{ _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)) };
+            const __m256 s2{ _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)) };
+            const __m256 s3{ _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)) };
+            const __m256 s4{ _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)) };
+            const __m256 s5{ _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2)) };
+            const __m256 s6{ _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)) };
+            const __m256 s7{ _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2)) };
+
+            _mm256_storeu_ps(dst + 0 * dstStride, _mm256_permute2f128_ps(s0, s4, 0x20));
+            _mm256_storeu_ps(dst + 1 * dstStride, _mm256_permute2f128_ps(s1, s5, 0x20));
+            _mm256_storeu_ps(dst + 2 * dstStride, _mm256_permute2f128_ps(s2, s6, 0x20));
+            _mm256_storeu_ps(dst + 3 * dstStride, _mm256_permute2f128_ps(s3, s7, 0x20));
+            _mm256_storeu_ps(dst + 4 * dstStride, _mm256_permute2f128_ps(s0, s4, 0x31));
+            _mm256_storeu_ps(dst + 5 * dstStride, _mm256_permute2f128_ps(s1, s5, 0x31));
+            _mm256_storeu_ps(dst + 6 * dstStride, _mm256_permute2f128_ps(s2, s6, 0x31));
+            _mm256_storeu_ps(dst + 7 * dstStride, _mm256_permute2f128_ps(s3, s7, 0x31));
+        }
+    };
+#elif MATRIX_KERNEL_SSE2
+    template <>
+    struct TransposeMicroKernel<float>
+    {
+        constexpr static int Size{ 4 };
+
+        inline static void run(const float* src, const int srcStride, float* dst, const int dstStride)
+        {
+            __m128 r0{ _mm_loadu_ps(src + 0 * srcStride) };
+            __m128 r1{ _mm_loadu_ps(src + 1 * srcStride) };
+            __m128 r2{ _mm_loadu_ps(src + 2 * srcStride) };
+            __m128 r3{ _mm_loadu_ps(src + 3 * srcStride) };
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(dst + 0 * dstStride, r0);
+            _mm_storeu_ps(dst + 1 * dstStride, r1);
+            _mm_storeu_ps(dst + 2 * dstStride, r2);
+            _mm_storeu_ps(dst + 3 * dstStride, r3);
+        }
+    };
+#endif
+
+#if MATRIX_KERNEL_AVX
+    template <>
+    struct TransposeMicroKernel<double>
+    {
+        constexpr static int Size{ 4 };
+
+        inline static void run(const double* src, const int srcStride, double* dst, const int dstStride)
+        {
+            const __m256d r0{ _mm256_loadu_pd(src + 0 * srcStride) };
+            const __m256d r1{ _mm256_loadu_pd(src + 1 * srcStride) };
+            const __m256d r2{ _mm256_loadu_pd(src + 2 * srcStride) };
+            const __m256d r3{ _mm256_loadu_pd(src + 3 * srcStride) };
+
+            const __m256d t0{ _mm256_unpacklo_pd(r0, r1) };
+            const __m256d t1{ _mm256_unpackhi_pd(r0, r1) };
+            const __m256d t2{ _mm256_unpacklo_pd(r2, r3) };
+            const __m256d t3{ _mm256_unpackhi_pd(r2, r3) };
+
+            _mm256_storeu_pd(dst + 0 * dstStride, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(dst + 1 * dstStride, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(dst + 2 * dstStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(dst + 3 * dstStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+    };
+#elif MATRIX_KERNEL_SSE2
+    template <>
+    struct TransposeMicroKernel<double>
+    {
+        constexpr static int Size{ 2 };
+
+        inline static void run(const double* src, const int srcStride, double* dst, const int dstStride)
+        {
+            const __m128d r0{ _mm_loadu_pd(src + 0 * srcStride) };
+            const __m128d r1{ _mm_loadu_pd(src + 1 * srcStride) };
+            _mm_storeu_pd(dst + 0 * dstStride, _mm_unpacklo_pd(r0, r1));
+            _mm_storeu_pd(dst + 1 * dstStride, _mm_unpackhi_pd(r0, r1));
+        }
+    };
+#endif
+
+    // Transpose a leaf of the recursion:
+    //      dst[column * dstStride + row] = src[row * srcStride + column]
+    // using the register kernel for every full tile
+    // and a scalar loop for the ragged edges
+    template <typename _Ty>
+    void TransposeLeaf(const _Ty* src, const int srcStride, _Ty* dst, const int dstStride,
+        const int rows, const int columns)
+    {
+        using Kernel = TransposeMicroKernel<_Ty>;
+        constexpr int K{ Kernel::Size };
+
+        const int fullRows{ K > 1 ? rows - rows % K : 0 };
+        const int fullColumns{ K > 1 ? columns - columns % K : 0 };
+
+        for (int row = 0; row < fullRows; row += K)
+            for (int column = 0; column < fullColumns; column += K)
+                Kernel::run(src + row * srcStride + column, srcStride,
+                    dst + column * dstStride + row, dstStride);
+
+        // right edge
+        for (int row = 0; row < fullRows; row++)
+            for (int column = fullColumns; column < columns; column++)
+                dst[column * dstStride + row] = src[row * srcStride + column];
+
+        // bottom edge
+        for (int row = fullRows; row < rows; row++)
+            for (int column = 0; column < columns; column++)
+                dst[column * dstStride + row] = src[row * srcStride + column];
+    }
+
+    // Cache-oblivious out-of-place transposition of a (rows x columns) block
+    // stored row by row with `srcStride` into a (columns x rows) block
+    // stored row by row with `dstStride`;
+    // the longer side is halved until the block fits into a leaf of
+    // `leafSize`, the tuned one if 0, which in both source and destination
+    // is expected to fit into L1 cache
+    // @see: Frigo, Leiserson, Prokop, Ramachandran. Cache-Oblivious Algorithms. 1999
+    template <typename _Ty>
+    void TransposeBlock(const _Ty* src, const int srcStride, _Ty* dst, const int dstStride,
+        const int rows, const int columns, int leafSize = 0)
+    {
+        if (rows <= MatrixMath::MinTransposeLeafSize && columns <= MatrixMath::MinTransposeLeafSize)
+        {
+            TransposeLeaf(src, srcStride, dst, dstStride, rows, columns);
+            return;
+        }
+        if (leafSize == 0)
+            leafSize = MatrixMath::GetTuning().transposeLeaf;
+
+        if (rows <= leafSize && columns <= leafSize)
+        {
+            TransposeLeaf(src, srcStride, dst, dstStride, rows, columns);
+        }
+        else if (rows >= columns)
+        {
+            const int half{ rows / 2 };
+            TransposeBlock(src, srcStride, dst, dstStride, half, columns, leafSize);
+            TransposeBlock(src + half * srcStride, srcStride, dst + half, dstStride, rows - half, columns, leafSize);
+        }
+        else
+        {
+            const int half{ columns / 2 };
+            TransposeBlock(src, srcStride, dst, dstStride, rows, half, leafSize);
+            TransposeBlock(src + half, srcStride, dst + half * dstStride, dstStride, rows, columns - half, leafSize);
+        }
+    }
+
+    // Exchange the block A (rows x columns) with the transposition
+    // of the block B (columns x rows), both of them being stored
+    // row by row with `stride` in the same buffer:
+    //      swap(A[row][column], B[column][row])
+    // with leaves of `leafSize`, as TransposeBlock
+    template <typename _Ty>
+    void TransposeSwapBlock(_Ty* a, _Ty* b, const int stride, const int rows, const int columns, const int leafSize)
+    {
+        if (rows <= leafSize && columns <= leafSize)
+        {
+            using Kernel = TransposeMicroKernel<_Ty>;
+            constexpr int K{ Kernel::Size };
+
+            const int fullRows{ K > 1 ? rows - rows % K : 0 };
+            const int fullColumns{ K > 1 ? columns - columns % K : 0 };
+
+            for (int row = 0; row < fullRows; row += K)
+            {
+                for (int column = 0; column < fullColumns; column += K)
+                {
+                    _Ty* pa{ a + row * stride + column };
+                    _Ty* pb{ b + column * stride + row };
+                    alignas(64) _Ty ta[K * K];
+                    alignas(64) _Ty tb[K * K];
+                    Kernel::run(pa, stride, ta, K);
+                    Kernel::run(pb, stride, tb, K);
+                    for (int k = 0; k < K; k++)
+                    {
+                        std::copy(tb + k * K, tb + k * K + K, pa + k * stride);
+                        std::copy(ta + k * K, ta + k * K + K, pb + k * stride);
+                    }
+                }
+            }
+
+            for (int row = 0; row < fullRows; row++)
+                for (int column = fullColumns; column < columns; column++)
+                    std::swap(a[row * stride + column], b[column * stride + row]);
+
+            for (int row = fullRows; row < rows; row++)
+                for (int column = 0; column < columns; column++)
+                    std::swap(a[row * stride + column], b[column * stride + row]);
+        }
+        else if (rows >= columns)
+        {
+            const int half{ rows / 2 };
+            TransposeSwapBlock(a, b, stride, half, columns, leafSize);
+            TransposeSwapBlock(a + half * stride, b + half, stride, rows - half, columns, leafSize);
+        }
+        else
+        {
+            const int half{ columns / 2 };
+            TransposeSwapBlock(a, b, stride, rows, half, leafSize);
+            TransposeSwapBlock(a + half, b + half * stride, stride, rows, columns - half, leafSize);
+        }
+    }
+
+    // Cache-oblivious in-place transposition of a (n x n) block
+    // stored row by row with `stride`; nothing is allocated.
+    // Leaves of `leafSize`, the tuned one if 0, as TransposeBlock
+    template <typename _Ty>
+    void TransposeSquareInPlace(_Ty* data, const int stride, const int n, int leafSize = 0)
+    {
+        if (leafSize == 0 && n > MatrixMath::MinTransposeLeafSize)
+            leafSize = MatrixMath::GetTuning().transposeLeaf;
+
+        if (n <= std::max(leafSize, MatrixMath::MinTransposeLeafSize))
+        {
+            for (int row = 0; row < n; row++)
+                for (int column = row + 1; column < n; column++)
+                    std::swap(data[row * stride + column], data[column * stride + row]);
+        }
+        else
+        {
+            const int half{ n / 2 };
+            // the two diagonal blocks are transposed on their own,
+            // the two off-diagonal blocks are transposed into each other
+            TransposeSquareInPlace(data, stride, half, leafSize);
+            TransposeSquareInPlace(data + half * stride + half, stride, n - half, leafSize);
+            TransposeSwapBlock(data + half, data + half * stride, stride, half, n - half, leafSize);
+        }
+    }
+
+    // SIMD registers wrapped behind one interface,
+    // so that an arithmetic kernel is written once for every width;
+    // `Size` is the number of lanes, `load3`/`store3` convert
+    // `Size` interleaved (x, y, z) triples from/to three registers
+    template <typename _Ty>
+    struct ScalarPack
+    {
+        using ElementType = _Ty;
+        using Type = _Ty;
+        constexpr static int Size{ 1 };
+
+        inline static Type load(const _Ty* p) { return *p; }
+        inline static void store(_Ty* p, const Type v) { *p = v; }
+        inline static Type broadcast(const _Ty v) { return v; }
+        inline static Type add(const Type a, const Type b) { return a + b; }
+        inline static Type sub(const Type a, const Type b) { return a - b; }
+        inline static Type mul(const Type a, const Type b) { return a * b; }
+        inline static Type div(const Type a, const Type b) { return a / b; }
+        inline static Type sqrt(const Type a) { return std::sqrt(a); }
+        // a > b ? x : y
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y) { return a > b ? x : y; }
+        // bit k is set when a > b in lane k
+        inline static int greaterMask(const Type a, const Type b) { return a > b ? 1 : 0; }
+        // sum of the lanes
+        inline static _Ty reduce(const Type a) { return a; }
+
+        // fast approximation of 1 / sqrt(a): the hardware estimate refined
+        // by one Newton-Raphson step where there is one, the exact value otherwise
+        inline static Type rsqrt(const Type a)
+        {
+#if MATRIX_KERNEL_SSE2
+            if constexpr (std::is_same_v<_Ty, float>)
+            {
+                const __m128 x{ _mm_set_ss(a) };
+                const __m128 y{ _mm_rsqrt_ss(x) };
+                // y (1.5 - 0.5 x y^2)
+                const __m128 half{ _mm_mul_ss(_mm_set_ss(0.5f), x) };
+                return _mm_cvtss_f32(_mm_mul_ss(y, _mm_sub_ss(_mm_set_ss(1.5f), _mm_mul_ss(half, _mm_mul_ss(y, y)))));
+            }
+#endif
+            return 1 / std::sqrt(a);
+        }
+        // a * b + c
+        inline static Type madd(const Type a, const Type b, const Type c) { return a * b + c; }
+
+        inline static void load3(const _Ty* p, Type& x, Type& y, Type& z)
+        {
+            x = p[0];
+            y = p[1];
+            z = p[2];
+        }
+
+        inline static void store3(_Ty* p, const Type x, const Type y, const Type z)
+        {
+            p[0] = x;
+            p[1] = y;
+            p[2] = z;
+        }
+    };
+
+#if MATRIX_KERNEL_SSE2
+    struct PackF4
+    {
+        using ElementType = float;
+        using Type = __m128;
+        constexpr static int Size{ 4 };
+
+        inline static Type load(const float* p) { return _mm_loadu_ps(p); }
+        inline static void store(float* p, const Type v) { _mm_storeu_ps(p, v); }
+        inline static Type broadcast(const float v) { return _mm_set1_ps(v); }
+        inline static Type add(const Type a, const Type b) { return _mm_add_ps(a, b); }
+        inline static Type sub(const Type a, const Type b) { return _mm_sub_ps(a, b); }
+        inline static Type mul(const Type a, const Type b) { return _mm_mul_ps(a, b); }
+        inline static Type div(const Type a, const Type b) { return _mm_div_ps(a, b); }
+        inline static Type sqrt(const Type a) { return _mm_sqrt_ps(a); }
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y)
+        {
+            const __m128 mask{ _mm_cmpgt_ps(a, b) };
+            return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+        }
+        inline static int greaterMask(const Type a, const Type b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+
+        inline static float reduce(const Type a)
+        {
+            const __m128 s{ _mm_add_ps(a, _mm_movehl_ps(a, a)) };
+            return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+        }
+
+        inline static Type rsqrt(const Type a)
+        {
+            const __m128 y{ _mm_rsqrt_ps(a) };
+            const __m128 half{ _mm_mul_ps(_mm_set1_ps(0.5f), a) };
+            return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(half, _mm_mul_ps(y, y))));
+        }
+#if MATRIX_KERNEL_FMA
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm_fmadd_ps(a, b, c); }
+#else
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+
+        // rows <=> columns of the (4 x 4) matrix held by r0, r1, r2, r3
+        inline static void transpose4(Type& r0, Type& r1, Type& r2, Type& r3)
+        {
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        }
+
+        // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+        //      => x0 x1 x2 x3 | y0 y1 y2 y3 | z0 z1 z2 z3
+        inline static void load3(const float* p, Type& x, Type& y, Type& z)
+        {
+            const __m128 m03{ _mm_loadu_ps(p + 0) };
+            const __m128 m14{ _mm_loadu_ps(p + 4) };
+            const __m128 m25{ _mm_loadu_ps(p + 8) };
+            deinterleave(m03, m14, m25, x, y, z);
+        }
+
+        inline static void store3(float* p, const Type x, const Type y, const Type z)
+        {
+            __m128 m03, m14, m25;
+            interleave(x, y, z, m03, m14, m25);
+            _mm_storeu_ps(p + 0, m03);
+            _mm_storeu_ps(p + 4, m14);
+            _mm_storeu_ps(p + 8, m25);
+        }
+
+        // the shuffles stay inside 128-bit lanes,
+        // hence they are shared by the 256-bit pack
+        inline static void deinterleave(const __m128 m03, const __m128 m14, const __m128 m25, __m128& x, __m128& y, __m128& z)
+        {
+            const __m128 xy{ _mm_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2)) };
+            const __m128 yz{ _mm_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1)) };
+            x = _mm_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+            y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            z = _mm_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        inline static void interleave(const __m128 x, const __m128 y, const __m128 z, __m128& m03, __m128& m14, __m128& m25)
+        {
+            const __m128 xy{ _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)) };
+            const __m128 yz{ _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1)) };
+            const __m128 zx{ _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0)) };
+            m03 = _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+            m14 = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            m25 = _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+#if MATRIX_KERNEL_AVX
+        inline static void deinterleave(const __m256 m03, const __m256 m14, const __m256 m25, __m256& x, __m256& y, __m256& z)
+        {
+            const __m256 xy{ _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2)) };
+            const __m256 yz{ _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1)) };
+            x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+            y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        inline static void interleave(const __m256 x, const __m256 y, const __m256 z, __m256& m03, __m256& m14, __m256& m25)
+        {
+            const __m256 xy{ _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)) };
+            const __m256 yz{ _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1)) };
+            const __m256 zx{ _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0)) };
+            m03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+            m14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            m25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+#endif
+    };
+
+    struct PackD2
+    {
+        using ElementType = double;
+        using Type = __m128d;
+        constexpr static int Size{ 2 };
+
+        inline static Type load(const double* p) { return _mm_loadu_pd(p); }
+        inline static void store(double* p, const Type v) { _mm_storeu_pd(p, v); }
+        inline static Type broadcast(const double v) { return _mm_set1_pd(v); }
+        inline static Type add(const Type a, const Type b) { return _mm_add_pd(a, b); }
+        inline static Type sub(const Type a, const Type b) { return _mm_sub_pd(a, b); }
+        inline static Type mul(const Type a, const Type b) { return _mm_mul_pd(a, b); }
+        inline static Type div(const Type a, const Type b) { return _mm_div_pd(a, b); }
+        inline static Type sqrt(const Type a) { return _mm_sqrt_pd(a); }
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y)
+        {
+            const __m128d mask{ _mm_cmpgt_pd(a, b) };
+            return _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, y));
+        }
+        inline static int greaterMask(const Type a, const Type b) { return _mm_movemask_pd(_mm_cmpgt_pd(a, b)); }
+
+        inline static double reduce(const Type a)
+        {
+            return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+        }
+
+        // no estimate for double
+        inline static Type rsqrt(const Type a) { return _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a)); }
+#if MATRIX_KERNEL_FMA
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm_fmadd_pd(a, b, c); }
+#else
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+#endif
+
+        // x0 y0 | z0 x1 | y1 z1  =>  x0 x1 | y0 y1 | z0 z1
+        inline static void load3(const double* p, Type& x, Type& y, Type& z)
+        {
+            const __m128d a{ _mm_loadu_pd(p + 0) };
+            const __m128d b{ _mm_loadu_pd(p + 2) };
+            const __m128d c{ _mm_loadu_pd(p + 4) };
+            x = _mm_shuffle_pd(a, b, 2);
+            y = _mm_shuffle_pd(a, c, 1);
+            z = _mm_shuffle_pd(b, c, 2);
+        }
+
+        inline static void store3(double* p, const Type x, const Type y, const Type z)
+        {
+            _mm_storeu_pd(p + 0, _mm_shuffle_pd(x, y, 0));
+            _mm_storeu_pd(p + 2, _mm_shuffle_pd(z, x, 2));
+            _mm_storeu_pd(p + 4, _mm_shuffle_pd(y, z, 3));
+        }
+    };
+#endif
+
+#if MATRIX_KERNEL_AVX
+    struct PackF8
+    {
+        using ElementType = float;
+        using Type = __m256;
+        constexpr static int Size{ 8 };
+
+        inline static Type load(const float* p) { return _mm256_loadu_ps(p); }
+        inline static void store(float* p, const Type v) { _mm256_storeu_ps(p, v); }
+        inline static Type broadcast(const float v) { return _mm256_set1_ps(v); }
+        inline static Type add(const Type a, const Type b) { return _mm256_add_ps(a, b); }
+        inline static Type sub(const Type a, const Type b) { return _mm256_sub_ps(a, b); }
+        inline static Type mul(const Type a, const Type b) { return _mm256_mul_ps(a, b); }
+        inline static Type div(const Type a, const Type b) { return _mm256_div_ps(a, b); }
+        inline static Type sqrt(const Type a) { return _mm256_sqrt_ps(a); }
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y)
+        {
+            return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+        }
+        inline static int greaterMask(const Type a, const Type b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+
+        inline static float reduce(const Type a)
+        {
+            return PackF4::reduce(_mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+        }
+
+        inline static Type rsqrt(const Type a)
+        {
+            const __m256 y{ _mm256_rsqrt_ps(a) };
+            const __m256 half{ _mm256_mul_ps(_mm256_set1_ps(0.5f), a) };
+            return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(half, _mm256_mul_ps(y, y))));
+        }
+#if MATRIX_KERNEL_FMA
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+
+        // two groups of four triples, one in each 128-bit lane
+        inline static void load3(const float* p, Type& x, Type& y, Type& z)
+        {
+            const __m256 m03{ _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 0)), _mm_loadu_ps(p + 12), 1) };
+            const __m256 m14{ _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1) };
+            const __m256 m25{ _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1) };
+            PackF4::deinterleave(m03, m14, m25, x, y, z);
+        }
+
+        inline static void store3(float* p, const Type x, const Type y, const Type z)
+        {
+            __m256 m03, m14, m25;
+            PackF4::interleave(x, y, z, m03, m14, m25);
+            _mm_storeu_ps(p + 0, _mm256_castps256_ps128(m03));
+            _mm_storeu_ps(p + 4, _mm256_castps256_ps128(m14));
+            _mm_storeu_ps(p + 8, _mm256_castps256_ps128(m25));
+            _mm_storeu_ps(p + 12, _mm256_extractf128_ps(m03, 1));
+            _mm_storeu_ps(p + 16, _mm256_extractf128_ps(m14, 1));
+            _mm_storeu_ps(p + 20, _mm256_extractf128_ps(m25, 1));
+        }
+    };
+
+    struct PackD4
+    {
+        using ElementType = double;
+        using Type = __m256d;
+        constexpr static int Size{ 4 };
+
+        inline static Type load(const double* p) { return _mm256_loadu_pd(p); }
+        inline static void store(double* p, const Type v) { _mm256_storeu_pd(p, v); }
+        inline static Type broadcast(const double v) { return _mm256_set1_pd(v); }
+        inline static Type add(const Type a, const Type b) { return _mm256_add_pd(a, b); }
+        inline static Type sub(const Type a, const Type b) { return _mm256_sub_pd(a, b); }
+        inline static Type mul(const Type a, const Type b) { return _mm256_mul_pd(a, b); }
+        inline static Type div(const Type a, const Type b) { return _mm256_div_pd(a, b); }
+        inline static Type sqrt(const Type a) { return _mm256_sqrt_pd(a); }
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y)
+        {
+            return _mm256_blendv_pd(y, x, _mm256_cmp_pd(a, b, _CMP_GT_OQ));
+        }
+        inline static int greaterMask(const Type a, const Type b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+
+        inline static double reduce(const Type a)
+        {
+            return PackD2::reduce(_mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1)));
+        }
+
+        inline static Type rsqrt(const Type a) { return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a)); }
+
+        inline static void transpose4(Type& r0, Type& r1, Type& r2, Type& r3)
+        {
+            const __m256d t0{ _mm256_unpacklo_pd(r0, r1) };
+            const __m256d t1{ _mm256_unpackhi_pd(r0, r1) };
+            const __m256d t2{ _mm256_unpacklo_pd(r2, r3) };
+            const __m256d t3{ _mm256_unpackhi_pd(r2, r3) };
+            r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+            r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+            r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+            r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+        }
+#if MATRIX_KERNEL_FMA
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+    };
+#endif
+
+#if MATRIX_KERNEL_AVX512
+    struct PackF16
+    {
+        using ElementType = float;
+        using Type = __m512;
+        constexpr static int Size{ 16 };
+
+        inline static Type load(const float* p) { return _mm512_loadu_ps(p); }
+        inline static void store(float* p, const Type v) { _mm512_storeu_ps(p, v); }
+        inline static Type broadcast(const float v) { return _mm512_set1_ps(v); }
+        inline static Type add(const Type a, const Type b) { return _mm512_add_ps(a, b); }
+        inline static Type sub(const Type a, const Type b) { return _mm512_sub_ps(a, b); }
+        inline static Type mul(const Type a, const Type b) { return _mm512_mul_ps(a, b); }
+        inline static Type div(const Type a, const Type b) { return _mm512_div_ps(a, b); }
+        inline static Type sqrt(const Type a) { return _mm512_sqrt_ps(a); }
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y)
+        {
+            return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), y, x);
+        }
+        inline static int greaterMask(const Type a, const Type b) { return static_cast<int>(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)); }
+        inline static float reduce(const Type a) { return _mm512_reduce_add_ps(a); }
+
+        // 14-bit estimate, one Newton-Raphson step
+        inline static Type rsqrt(const Type a)
+        {
+            const __m512 y{ _mm512_rsqrt14_ps(a) };
+            const __m512 half{ _mm512_mul_ps(_mm512_set1_ps(0.5f), a) };
+            return _mm512_mul_ps(y, _mm512_fnmadd_ps(half, _mm512_mul_ps(y, y), _mm512_set1_ps(1.5f)));
+        }
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm512_fmadd_ps(a, b, c); }
+    };
+
+    struct PackD8
+    {
+        using ElementType = double;
+        using Type = __m512d;
+        constexpr static int Size{ 8 };
+
+        inline static Type load(const double* p) { return _mm512_loadu_pd(p); }
+        inline static void store(double* p, const Type v) { _mm512_storeu_pd(p, v); }
+        inline static Type broadcast(const double v) { return _mm512_set1_pd(v); }
+        inline static Type add(const Type a, const Type b) { return _mm512_add_pd(a, b); }
+        inline static Type sub(const Type a, const Type b) { return _mm512_sub_pd(a, b); }
+        inline static Type mul(const Type a, const Type b) { return _mm512_mul_pd(a, b); }
+        inline static Type div(const Type a, const Type b) { return _mm512_div_pd(a, b); }
+        inline static Type sqrt(const Type a) { return _mm512_sqrt_pd(a); }
+        inline static Type selectGreater(const Type a, const Type b, const Type x, const Type y)
+        {
+            return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), y, x);
+        }
+        inline static int greaterMask(const Type a, const Type b) { return static_cast<int>(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)); }
+        inline static double reduce(const Type a) { return _mm512_reduce_add_pd(a); }
+
+        // 14-bit estimate, two Newton-Raphson steps
+        inline static Type rsqrt(const Type a)
+        {
+            const __m512d half{ _mm512_mul_pd(_mm512_set1_pd(0.5), a) };
+            const __m512d threeHalves{ _mm512_set1_pd(1.5) };
+            __m512d y{ _mm512_rsqrt14_pd(a) };
+            y = _mm512_mul_pd(y, _mm512_fnmadd_pd(half, _mm512_mul_pd(y, y), threeHalves));
+            y = _mm512_mul_pd(y, _mm512_fnmadd_pd(half, _mm512_mul_pd(y, y), threeHalves));
+            return y;
+        }
+        inline static Type madd(const Type a, const Type b, const Type c) { return _mm512_fmadd_pd(a, b, c); }
+    };
+#endif
+
+    // The widest pack available for the element type
+    template <typename _Ty>
+    struct WidestPack
+    {
+        using Type = ScalarPack<_Ty>;
+    };
+
+    // The widest pack providing `load3`/`store3` for the element type
+    template <typename _Ty>
+    struct InterleavedPack
+    {
+        using Type = ScalarPack<_Ty>;
+    };
+
+#if MATRIX_KERNEL_AVX512
+    template <> struct WidestPack<float> { using Type = PackF16; };
+    template <> struct WidestPack<double> { using Type = PackD8; };
+#elif MATRIX_KERNEL_AVX
+    template <> struct WidestPack<float> { using Type = PackF8; };
+    template <> struct WidestPack<double> { using Type = PackD4; };
+#elif MATRIX_KERNEL_SSE2
+    template <> struct WidestPack<float> { using Type = PackF4; };
+    template <> struct WidestPack<double> { using Type = PackD2; };
+#endif
+
+    // A pack of exactly 4 lanes, holding one row of a (3 x 4) matrix
+    // or one quaternion, and providing `transpose4`
+    template <typename _Ty>
+    struct QuadPack
+    {
+        using Type = ScalarPack<_Ty>;
+    };
+
+#if MATRIX_KERNEL_SSE2
+    template <> struct QuadPack<float> { using Type = PackF4; };
+#endif
+#if MATRIX_KERNEL_AVX
+    template <> struct QuadPack<double> { using Type = PackD4; };
+#endif
+
+#if MATRIX_KERNEL_AVX
+    template <> struct InterleavedPack<float> { using Type = PackF8; };
+#elif MATRIX_KERNEL_SSE2
+    template <> struct InterleavedPack<float> { using Type = PackF4; };
+#endif
+#if MATRIX_KERNEL_SSE2
+    template <> struct InterleavedPack<double> { using Type = PackD2; };
+#endif
+
+    // Broadcast the coefficients of a row-major (3 x 4) affine matrix,
+    // the last column being scaled by w:
+    // w is 1 to transform points and 0 to transform directions
+    template <typename Pack>
+    inline void BroadcastAffine(const typename Pack::ElementType* m, const typename Pack::ElementType w,
+        typename Pack::Type (&coefficients)[12])
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            coefficients[row * 4 + 0] = Pack::broadcast(m[row * 4 + 0]);
+            coefficients[row * 4 + 1] = Pack::broadcast(m[row * 4 + 1]);
+            coefficients[row * 4 + 2] = Pack::broadcast(m[row * 4 + 2]);
+            coefficients[row * 4 + 3] = Pack::broadcast(m[row * 4 + 3] * w);
+        }
+    }
+
+    // (x, y, z) = m * (x, y, z, w) on `Pack::Size` vectors at once
+    template <typename Pack>
+    inline void AffineMicroKernel(const typename Pack::Type (&m)[12],
+        typename Pack::Type& x, typename Pack::Type& y, typename Pack::Type& z)
+    {
+        const typename Pack::Type ox{ Pack::madd(m[0], x, Pack::madd(m[1], y, Pack::madd(m[2], z, m[3]))) };
+        const typename Pack::Type oy{ Pack::madd(m[4], x, Pack::madd(m[5], y, Pack::madd(m[6], z, m[7]))) };
+        const typename Pack::Type oz{ Pack::madd(m[8], x, Pack::madd(m[9], y, Pack::madd(m[10], z, m[11]))) };
+        x = ox;
+        y = oy;
+        z = oz;
+    }
+
+    // Apply the row-major (3 x 4) affine matrix `m` to `count` vectors
+    // whose coordinates are stored in three separate arrays;
+    // every element is read and written exactly once,
+    // so the output arrays may be the input arrays themselves
+    template <typename _Ty>
+    void AffineTransformSoA(const _Ty* m, const _Ty w,
+        const _Ty* x, const _Ty* y, const _Ty* z,
+        _Ty* outX, _Ty* outY, _Ty* outZ, const std::size_t count)
+    {
+        using Pack = typename WidestPack<_Ty>::Type;
+
+        std::size_t index{ 0 };
+        if constexpr (Pack::Size > 1)
+        {
+            typename Pack::Type coefficients[12];
+            BroadcastAffine<Pack>(m, w, coefficients);
+            for (; index + Pack::Size <= count; index += Pack::Size)
+            {
+                typename Pack::Type vx{ Pack::load(x + index) };
+                typename Pack::Type vy{ Pack::load(y + index) };
+                typename Pack::Type vz{ Pack::load(z + index) };
+                AffineMicroKernel<Pack>(coefficients, vx, vy, vz);
+                Pack::store(outX + index, vx);
+                Pack::store(outY + index, vy);
+                Pack::store(outZ + index, vz);
+            }
+        }
+
+        // remainder
+        _Ty coefficients[12];
+        BroadcastAffine<ScalarPack<_Ty>>(m, w, coefficients);
+        for (; index < count; index++)
+        {
+            _Ty vx{ x[index] }, vy{ y[index] }, vz{ z[index] };
+            AffineMicroKernel<ScalarPack<_Ty>>(coefficients, vx, vy, vz);
+            outX[index] = vx;
+            outY[index] = vy;
+            outZ[index] = vz;
+        }
+    }
+
+    // Apply the row-major (3 x 4) affine matrix `m` to `count` vectors
+    // stored as interleaved (x, y, z) triples;
+    // `out` may be `xyz` itself
+    template <typename _Ty>
+    void AffineTransformInterleaved(const _Ty* m, const _Ty w,
+        const _Ty* xyz, _Ty* out, const std::size_t count)
+    {
+        using Pack = typename InterleavedPack<_Ty>::Type;
+
+        std::size_t index{ 0 };
+        if constexpr (Pack::Size > 1)
+        {
+            typename Pack::Type coefficients[12];
+            BroadcastAffine<Pack>(m, w, coefficients);
+            for (; index + Pack::Size <= count; index += Pack::Size)
+            {
+                typename Pack::Type vx, vy, vz;
+                Pack::load3(xyz + index * 3, vx, vy, vz);
+                AffineMicroKernel<Pack>(coefficients, vx, vy, vz);
+                Pack::store3(out + index * 3, vx, vy, vz);
+            }
+        }
+
+        // remainder
+        _Ty coefficients[12];
+        BroadcastAffine<ScalarPack<_Ty>>(m, w, coefficients);
+        for (; index < count; index++)
+        {
+            _Ty vx, vy, vz;
+            ScalarPack<_Ty>::load3(xyz + index * 3, vx, vy, vz);
+            AffineMicroKernel<ScalarPack<_Ty>>(coefficients, vx, vy, vz);
+            ScalarPack<_Ty>::store3(out + index * 3, vx, vy, vz);
+        }
+    }
+
+    // c = a * b for row-major (3 x 4) affine matrices,
+    // the implicit last row (0, 0, 0, 1) of both being taken into account:
+    //      row i of c = a[i][0] * b0 + a[i][1] * b1 + a[i][2] * b2 + (0, 0, 0, a[i][3])
+    // `c` may be `a` or `b`
+    template <typename _Ty>
+    void AffineCompose(const _Ty* a, const _Ty* b, _Ty* c)
+    {
+        using Pack = typename QuadPack<_Ty>::Type;
+
+        if constexpr (Pack::Size == 4)
+        {
+            const typename Pack::Type b0{ Pack::load(b + 0) };
+            const typename Pack::Type b1{ Pack::load(b + 4) };
+            const typename Pack::Type b2{ Pack::load(b + 8) };
+            const _Ty unit[4]{ 0, 0, 0, 1 };
+            const typename Pack::Type e3{ Pack::load(unit) };
+            for (int row = 0; row < 3; row++)
+            {
+                const _Ty* r{ a + row * 4 };
+                const typename Pack::Type result{
+                    Pack::madd(Pack::broadcast(r[0]), b0,
+                    Pack::madd(Pack::broadcast(r[1]), b1,
+                    Pack::madd(Pack::broadcast(r[2]), b2,
+                    Pack::mul(Pack::broadcast(r[3]), e3)))) };
+                Pack::store(c + row * 4, result);
+            }
+        }
+        else
+        {
+            _Ty result[12];
+            for (int row = 0; row < 3; row++)
+            {
+                const _Ty* r{ a + row * 4 };
+                for (int column = 0; column < 4; column++)
+                    result[row * 4 + column] = r[0] * b[column] + r[1] * b[4 + column] + r[2] * b[8 + column];
+                result[row * 4 + 3] += r[3];
+            }
+            std::copy(result, result + 12, c);
+        }
+    }
+
+    // Hamilton product c = a * b of quaternions stored as (x, y, z, w);
+    // as a sum over the components of a:
+    //      c = w1 * ( x2,  y2,  z2,  w2)
+    //        + x1 * ( w2, -z2,  y2, -x2)
+    //        + y1 * ( z2,  w2, -x2, -y2)
+    //        + z1 * (-y2,  x2,  w2, -z2)
+    template <typename _Ty>
+    inline void QuaternionMultiply(const _Ty* a, const _Ty* b, _Ty* c)
+    {
+        const _Ty x{ a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1] };
+        const _Ty y{ a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0] };
+        const _Ty z{ a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3] };
+        const _Ty w{ a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2] };
+        c[0] = x;
+        c[1] = y;
+        c[2] = z;
+        c[3] = w;
+    }
+
+#if MATRIX_KERNEL_SSE2
+    template <>
+    inline void QuaternionMultiply<float>(const float* a, const float* b, float* c)
+    {
+        const __m128 q1{ _mm_loadu_ps(a) };
+        const __m128 q2{ _mm_loadu_ps(b) };
+        const __m128 signX{ _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f) };
+        const __m128 signY{ _mm_setr_ps(1.0f, 1.0f, -1.0f, -1.0f) };
+        const __m128 signZ{ _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f) };
+
+        __m128 result{ _mm_mul_ps(_mm_shuffle_ps(q1, q1, _MM_SHUFFLE(3, 3, 3, 3)), q2) };
+        result = PackF4::madd(_mm_shuffle_ps(q1, q1, _MM_SHUFFLE(0, 0, 0, 0)),
+            _mm_mul_ps(_mm_shuffle_ps(q2, q2, _MM_SHUFFLE(0, 1, 2, 3)), signX), result);
+        result = PackF4::madd(_mm_shuffle_ps(q1, q1, _MM_SHUFFLE(1, 1, 1, 1)),
+            _mm_mul_ps(_mm_shuffle_ps(q2, q2, _MM_SHUFFLE(1, 0, 3, 2)), signY), result);
+        result = PackF4::madd(_mm_shuffle_ps(q1, q1, _MM_SHUFFLE(2, 2, 2, 2)),
+            _mm_mul_ps(_mm_shuffle_ps(q2, q2, _MM_SHUFFLE(2, 3, 0, 1)), signZ), result);
+        _mm_storeu_ps(c, result);
+    }
+#endif
+
+    // Rotation matrix of the quaternion (x, y, z, w),
+    // which does not need to be of unit length
+    template <typename Pack>
+    inline void QuaternionMicroKernel(
+        const typename Pack::Type x, const typename Pack::Type y,
+        const typename Pack::Type z, const typename Pack::Type w,
+        typename Pack::Type (&m)[9])
+    {
+        using Type = typename Pack::Type;
+        const Type one{ Pack::broadcast(1) };
+        const Type norm{ Pack::madd(x, x, Pack::madd(y, y, Pack::madd(z, z, Pack::mul(w, w)))) };
+        const Type s{ Pack::div(Pack::broadcast(2), norm) };
+
+        const Type xs{ Pack::mul(x, s) }, ys{ Pack::mul(y, s) }, zs{ Pack::mul(z, s) };
+        const Type wx{ Pack::mul(w, xs) }, wy{ Pack::mul(w, ys) }, wz{ Pack::mul(w, zs) };
+        const Type xx{ Pack::mul(x, xs) }, xy{ Pack::mul(x, ys) }, xz{ Pack::mul(x, zs) };
+        const Type yy{ Pack::mul(y, ys) }, yz{ Pack::mul(y, zs) }, zz{ Pack::mul(z, zs) };
+
+        m[0] = Pack::sub(one, Pack::add(yy, zz));
+        m[1] = Pack::sub(xy, wz);
+        m[2] = Pack::add(xz, wy);
+        m[3] = Pack::add(xy, wz);
+        m[4] = Pack::sub(one, Pack::add(xx, zz));
+        m[5] = Pack::sub(yz, wx);
+        m[6] = Pack::sub(xz, wy);
+        m[7] = Pack::add(yz, wx);
+        m[8] = Pack::sub(one, Pack::add(xx, yy));
+    }
+
+    // Quaternion (x, y, z, w) of the rotation matrix m, without branches:
+    // the largest of |x|, |y|, |z|, |w| is found from the diagonal,
+    // the three others from the off-diagonal entries
+    // @see: Shepperd. Quaternion from Rotation Matrix. 1978
+    template <typename Pack>
+    inline void RotationMicroKernel(const typename Pack::Type (&m)[9],
+        typename Pack::Type& x, typename Pack::Type& y,
+        typename Pack::Type& z, typename Pack::Type& w)
+    {
+        using Type = typename Pack::Type;
+        const Type one{ Pack::broadcast(1) };
+        const Type tw{ Pack::add(one, Pack::add(m[0], Pack::add(m[4], m[8]))) };
+        const Type tx{ Pack::add(one, Pack::sub(m[0], Pack::add(m[4], m[8]))) };
+        const Type ty{ Pack::add(one, Pack::sub(Pack::sub(m[4], m[0]), m[8])) };
+        const Type tz{ Pack::add(one, Pack::sub(Pack::sub(m[8], m[0]), m[4])) };
+
+        const Type s21{ Pack::add(m[7], m[5]) }, d21{ Pack::sub(m[7], m[5]) };
+        const Type s02{ Pack::add(m[2], m[6]) }, d02{ Pack::sub(m[2], m[6]) };
+        const Type s10{ Pack::add(m[3], m[1]) }, d10{ Pack::sub(m[3], m[1]) };
+
+        // start with w being the largest, then challenge it by x, y and z
+        Type t{ tw };
+        x = d21;
+        y = d02;
+        z = d10;
+        w = tw;
+
+        x = Pack::selectGreater(tx, t, tx, x);
+        y = Pack::selectGreater(tx, t, s10, y);
+        z = Pack::selectGreater(tx, t, s02, z);
+        w = Pack::selectGreater(tx, t, d21, w);
+        t = Pack::selectGreater(tx, t, tx, t);
+
+        x = Pack::selectGreater(ty, t, s10, x);
+        y = Pack::selectGreater(ty, t, ty, y);
+        z = Pack::selectGreater(ty, t, s21, z);
+        w = Pack::selectGreater(ty, t, d02, w);
+        t = Pack::selectGreater(ty, t, ty, t);
+
+        x = Pack::selectGreater(tz, t, s02, x);
+        y = Pack::selectGreater(tz, t, s21, y);
+        z = Pack::selectGreater(tz, t, tz, z);
+        w = Pack::selectGreater(tz, t, d10, w);
+        t = Pack::selectGreater(tz, t, tz, t);
+
+        const Type scale{ Pack::div(Pack::broadcast(0.5), Pack::sqrt(t)) };
+        x = Pack::mul(x, scale);
+        y = Pack::mul(y, scale);
+        z = Pack::mul(z, scale);
+        w = Pack::mul(w, scale);
+    }
+
+    // Convert `count` quaternions stored as (x, y, z, w)
+    // into row-major (3 x 3) rotation matrices stored one after another;
+    // four quaternions are transposed into registers at once
+    template <typename _Ty>
+    void QuaternionsToRotations(const _Ty* quaternions, _Ty* matrices, const std::size_t count)
+    {
+        using Pack = typename QuadPack<_Ty>::Type;
+
+        std::size_t index{ 0 };
+        if constexpr (Pack::Size == 4)
+        {
+            for (; index + 4 <= count; index += 4)
+            {
+                const _Ty* q{ quaternions + index * 4 };
+                typename Pack::Type x{ Pack::load(q + 0) };
+                typename Pack::Type y{ Pack::load(q + 4) };
+                typename Pack::Type z{ Pack::load(q + 8) };
+                typename Pack::Type w{ Pack::load(q + 12) };
+                Pack::transpose4(x, y, z, w);
+
+                typename Pack::Type m[9];
+                QuaternionMicroKernel<Pack>(x, y, z, w, m);
+
+                // entries 0 - 3 and 4 - 7 of every matrix come out of two transpositions
+                Pack::transpose4(m[0], m[1], m[2], m[3]);
+                Pack::transpose4(m[4], m[5], m[6], m[7]);
+                alignas(64) _Ty last[4];
+                Pack::store(last, m[8]);
+
+                _Ty* out{ matrices + index * 9 };
+                for (int k = 0; k < 4; k++)
+                {
+                    Pack::store(out + k * 9, m[k]);
+                    Pack::store(out + k * 9 + 4, m[4 + k]);
+                    out[k * 9 + 8] = last[k];
+                }
+            }
+        }
+
+        // remainder
+        for (; index < count; index++)
+        {
+            const _Ty* q{ quaternions + index * 4 };
+            _Ty m[9];
+            QuaternionMicroKernel<ScalarPack<_Ty>>(q[0], q[1], q[2], q[3], m);
+            std::copy(m, m + 9, matrices + index * 9);
+        }
+    }
+
+    // Convert `count` row-major (3 x 3) rotation matrices stored one after another
+    // into quaternions stored as (x, y, z, w)
+    template <typename _Ty>
+    void RotationsToQuaternions(const _Ty* matrices, _Ty* quaternions, const std::size_t count)
+    {
+        using Pack = typename QuadPack<_Ty>::Type;
+
+        std::size_t index{ 0 };
+        if constexpr (Pack::Size == 4)
+        {
+            for (; index + 4 <= count; index += 4)
+            {
+                const _Ty* in{ matrices + index * 9 };
+                typename Pack::Type m[9];
+                alignas(64) _Ty last[4];
+                for (int k = 0; k < 4; k++)
+                {
+                    m[k] = Pack::load(in + k * 9);
+                    m[4 + k] = Pack::load(in + k * 9 + 4);
+                    last[k] = in[k * 9 + 8];
+                }
+                Pack::transpose4(m[0], m[1], m[2], m[3]);
+                Pack::transpose4(m[4], m[5], m[6], m[7]);
+                m[8] = Pack::load(last);
+
+                typename Pack::Type x, y, z, w;
+                RotationMicroKernel<Pack>(m, x, y, z, w);
+                Pack::transpose4(x, y, z, w);
+
+                _Ty* q{ quaternions + index * 4 };
+                Pack::store(q + 0, x);
+                Pack::store(q + 4, y);
+                Pack::store(q + 8, z);
+                Pack::store(q + 12, w);
+            }
+        }
+
+        // remainder
+        for (; index < count; index++)
+        {
+            _Ty m[9];
+            std::copy(matrices + index * 9, matrices + index * 9 + 9, m);
+            _Ty* q{ quaternions + index * 4 };
+            RotationMicroKernel<ScalarPack<_Ty>>(m, q[0], q[1], q[2], q[3]);
+        }
+    }
+
+    // Enough for the six planes of a view frustum
+    constexpr static int MaxCullingPlanes{ 6 };
+
+    // Store the visibility bits of the vectors [index, index + Size)
+    // into the bitmask: bit (i % 32) of visible[i / 32] stands for vector i;
+    // Size divides 32, so the bits never straddle two words
+    template <typename Pack>
+    inline void StoreVisibility(std::uint32_t* visible, const std::size_t index, const int bits)
+    {
+        static_assert(32 % Pack::Size == 0, "The lanes of a pack must not straddle two words!");
+        constexpr std::uint32_t all{ Pack::Size == 32 ? ~std::uint32_t(0) : (std::uint32_t(1) << Pack::Size) - 1 };
+
+        std::uint32_t& word{ visible[index / 32] };
+        if (index % 32 == 0)
+            word = 0;
+        word |= (static_cast<std::uint32_t>(bits) & all) << (index % 32);
+    }
+
+    // Test `count` axis-aligned boxes, given by their centers and half extents,
+    // against the inward-facing planes (a, b, c, d) stored one after another:
+    // a box is culled when it lies entirely on the negative side of one plane,
+    // i.e. when the distance of its center plus its projected radius
+    //      |a| ex + |b| ey + |c| ez
+    // is negative
+    template <typename _Ty>
+    void CullBoxes(const _Ty* planes, const int planeCount,
+        const _Ty* cx, const _Ty* cy, const _Ty* cz,
+        const _Ty* ex, const _Ty* ey, const _Ty* ez,
+        std::uint32_t* visible, const std::size_t count)
+    {
+        assert(planeCount <= MaxCullingPlanes);
+        const auto run = [&](auto pack, std::size_t& index, const std::size_t end) {
+            using Pack = decltype(pack);
+            const typename Pack::Type zero{ Pack::broadcast(0) };
+            // (a, b, c, d, |a|, |b|, |c|) of every plane
+            typename Pack::Type coefficients[MaxCullingPlanes][7];
+            for (int k = 0; k < planeCount; k++)
+                for (int i = 0; i < 7; i++)
+                    coefficients[k][i] = Pack::broadcast(i < 4 ? planes[k * 4 + i] : std::abs(planes[k * 4 + i - 4]));
+
+            for (; index + Pack::Size <= end; index += Pack::Size)
+            {
+                const typename Pack::Type x{ Pack::load(cx + index) };
+                const typename Pack::Type y{ Pack::load(cy + index) };
+                const typename Pack::Type z{ Pack::load(cz + index) };
+                const typename Pack::Type rx{ Pack::load(ex + index) };
+                const typename Pack::Type ry{ Pack::load(ey + index) };
+                const typename Pack::Type rz{ Pack::load(ez + index) };
+
+                int outside{ 0 };
+                for (int k = 0; k < planeCount; k++)
+                {
+                    const typename Pack::Type (&plane)[7]{ coefficients[k] };
+                    const typename Pack::Type distance{
+                        Pack::madd(plane[0], x, Pack::madd(plane[1], y, Pack::madd(plane[2], z, plane[3]))) };
+                    const typename Pack::Type radius{
+                        Pack::madd(plane[4], rx, Pack::madd(plane[5], ry, Pack::mul(plane[6], rz))) };
+                    outside |= Pack::greaterMask(zero, Pack::add(distance, radius));
+                }
+                StoreVisibility<Pack>(visible, index, ~outside);
+            }
+        };
+
+        std::size_t index{ 0 };
+        run(typename WidestPack<_Ty>::Type{}, index, count);
+        run(ScalarPack<_Ty>{}, index, count);
+    }
+
+    // Test `count` spheres against the planes as in `CullBoxes`:
+    // a sphere is culled when the distance of its center is below -radius
+    template <typename _Ty>
+    void CullSpheres(const _Ty* planes, const int planeCount,
+        const _Ty* cx, const _Ty* cy, const _Ty* cz, const _Ty* radii,
+        std::uint32_t* visible, const std::size_t count)
+    {
+        assert(planeCount <= MaxCullingPlanes);
+        const auto run = [&](auto pack, std::size_t& index, const std::size_t end) {
+            using Pack = decltype(pack);
+            const typename Pack::Type zero{ Pack::broadcast(0) };
+            typename Pack::Type coefficients[MaxCullingPlanes][4];
+            for (int k = 0; k < planeCount; k++)
+                for (int i = 0; i < 4; i++)
+                    coefficients[k][i] = Pack::broadcast(planes[k * 4 + i]);
+
+            for (; index + Pack::Size <= end; index += Pack::Size)
+            {
+                const typename Pack::Type x{ Pack::load(cx + index) };
+                const typename Pack::Type y{ Pack::load(cy + index) };
+                const typename Pack::Type z{ Pack::load(cz + index) };
+                const typename Pack::Type r{ Pack::load(radii + index) };
+
+                int outside{ 0 };
+                for (int k = 0; k < planeCount; k++)
+                {
+                    const typename Pack::Type (&plane)[4]{ coefficients[k] };
+                    const typename Pack::Type distance{
+                        Pack::madd(plane[0], x, Pack::madd(plane[1], y, Pack::madd(plane[2], z, plane[3]))) };
+                    outside |= Pack::greaterMask(zero, Pack::add(distance, r));
+                }
+                StoreVisibility<Pack>(visible, index, ~outside);
+            }
+        };
+
+        std::size_t index{ 0 };
+        run(typename WidestPack<_Ty>::Type{}, index, count);
+        run(ScalarPack<_Ty>{}, index, count);
+    }
+
+    // Dot product of two arrays of n entries
+    template <typename _Ty>
+    inline _Ty DotProduct(const _Ty* a, const _Ty* b, const int n)
+    {
+        using Pack = typename WidestPack<_Ty>::Type;
+
+        int index{ 0 };
+        _Ty sum{ 0 };
+        if constexpr (Pack::Size > 1)
+        {
+            if (n >= Pack::Size)
+            {
+                typename Pack::Type acc{ Pack::mul(Pack::load(a), Pack::load(b)) };
+                for (index = Pack::Size; index + Pack::Size <= n; index += Pack::Size)
+                    acc = Pack::madd(Pack::load(a + index), Pack::load(b + index), acc);
+                sum = Pack::reduce(acc);
+            }
+        }
+        for (; index < n; index++)
+            sum += a[index] * b[index];
+        return sum;
+    }
+
+    // C += A * B, A being (m x k), B (k x n) and C (m x n),
+    // all of them stored row by row with their own strides;
+    // `Rows` rows of C are accumulated in registers at a time,
+    // so that every pack of B loaded is used `Rows` times
+    template <int Rows, typename _Ty>
+    void MultiplyAddPanel(const _Ty* a, const int lda, const _Ty* b, const int ldb,
+        _Ty* c, const int ldc, const int m, const int n, const int k)
+    {
+        using Pack = typename WidestPack<_Ty>::Type;
+
+        auto rows = [&](const int row, auto count) {
+            constexpr int R{ decltype(count)::value };
+            const _Ty* pa{ a + row * lda };
+            _Ty* pc{ c + row * ldc };
+
+            int column{ 0 };
+            if constexpr (Pack::Size > 1)
+            {
+                for (; column + Pack::Size <= n; column += Pack::Size)
+                {
+                    typename Pack::Type acc[R];
+                    for (int r = 0; r < R; r++)
+                        acc[r] = Pack::load(pc + r * ldc + column);
+                    for (int p = 0; p < k; p++)
+                    {
+                        const typename Pack::Type vb{ Pack::load(b + p * ldb + column) };
+                        for (int r = 0; r < R; r++)
+                            acc[r] = Pack::madd(Pack::broadcast(pa[r * lda + p]), vb, acc[r]);
+                    }
+                    for (int r = 0; r < R; r++)
+                        Pack::store(pc + r * ldc + column, acc[r]);
+                }
+            }
+            for (; column < n; column++)
+            {
+                for (int r = 0; r < R; r++)
+                {
+                    _Ty sum{ pc[r * ldc + column] };
+                    for (int p = 0; p < k; p++)
+                        sum += pa[r * lda + p] * b[p * ldb + column];
+                    pc[r * ldc + column] = sum;
+                }
+            }
+        };
+
+        int row{ 0 };
+        for (; row + Rows <= m; row += Rows)
+            rows(row, std::integral_constant<int, Rows>{});
+        for (; row < m; row++)
+            rows(row, std::integral_constant<int, 1>{});
+    }
+
+    // C += A * B as MultiplyAddPanel, going through B in blocks of
+    // (multiplyDepth x multiplyWidth) of the tuning, each of them staying
+    // in cache while all the rows of C are updated with it
+    template <typename _Ty>
+    void MultiplyAddBlock(const _Ty* a, const int lda, const _Ty* b, const int ldb,
+        _Ty* c, const int ldc, const int m, const int n, const int k)
+    {
+        const MatrixMath::TuningParameters tuning{ MatrixMath::GetTuning() };
+        for (int p = 0; p < k; p += tuning.multiplyDepth)
+        {
+            const int depth{ std::min(tuning.multiplyDepth, k - p) };
+            for (int column = 0; column < n; column += tuning.multiplyWidth)
+            {
+                const int width{ std::min(tuning.multiplyWidth, n - column) };
+                const _Ty* pa{ a + p };
+                const _Ty* pb{ b + p * ldb + column };
+                _Ty* pc{ c + column };
+                switch (tuning.multiplyRows)
+                {
+                case 1:
+                    MultiplyAddPanel<1>(pa, lda, pb, ldb, pc, ldc, m, width, depth);
+                    break;
+                case 2:
+                    MultiplyAddPanel<2>(pa, lda, pb, ldb, pc, ldc, m, width, depth);
+                    break;
+                case 8:
+                    MultiplyAddPanel<8>(pa, lda, pb, ldb, pc, ldc, m, width, depth);
+                    break;
+                default:
+                    MultiplyAddPanel<4>(pa, lda, pb, ldb, pc, ldc, m, width, depth);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Run `op(pack, index)` on `Pack::Size` vectors at a time,
+    // then on the remaining vectors one by one with the scalar pack
+    template <typename Pack, typename _Op>
+    inline void ForEachPack(const std::size_t count, _Op&& op)
+    {
+        std::size_t index{ 0 };
+        if constexpr (Pack::Size > 1)
+            for (; index + Pack::Size <= count; index += Pack::Size)
+                op(Pack{}, index);
+        for (; index < count; index++)
+            op(ScalarPack<typename Pack::ElementType>{}, index);
+    }
+
+    // Pack walking through interleaved vectors of N entries:
+    // triples and quadruples are transposed into registers,
+    // other sizes are handled vector by vector
+    template <typename _Ty, int N>
+    struct InterleavedVectorPack
+    {
+        using Type = ScalarPack<_Ty>;
+    };
+
+    template <typename _Ty>
+    struct InterleavedVectorPack<_Ty, 3>
+    {
+        using Type = typename InterleavedPack<_Ty>::Type;
+    };
+
+    template <typename _Ty>
+    struct InterleavedVectorPack<_Ty, 4>
+    {
+        using Type = typename QuadPack<_Ty>::Type;
+    };
+
+    // Loads and stores of the vectors described by `_In`,
+    // InterleavedVectors or SeparateVectors, with the packs of this level
+    template <typename _In>
+    struct VectorAccess;
+
+    // `load`/`store` move `P::Size` vectors from/to N registers,
+    // register k holding the k-th entry of every vector
+    template <typename _Ty, int N>
+    struct VectorAccess<detail::InterleavedVectors<_Ty, N>>
+    {
+        using ElementType = std::remove_const_t<_Ty>;
+        using Pack = typename InterleavedVectorPack<ElementType, N>::Type;
+
+        _Ty* data;
+
+        explicit VectorAccess(const detail::InterleavedVectors<_Ty, N>& vectors)
+            : data{ vectors.data }
+        {
+        }
+
+        template <typename P>
+        inline void load(const std::size_t index, typename P::Type (&v)[N]) const
+        {
+            const _Ty* p{ this->data + index * N };
+            if constexpr (P::Size == 1)
+            {
+                for (int k = 0; k < N; k++)
+                    v[k] = p[k];
+            }
+            else if constexpr (N == 3)
+            {
+                P::load3(p, v[0], v[1], v[2]);
+            }
+            else
+            {
+                for (int k = 0; k < 4; k++)
+                    v[k] = P::load(p + k * 4);
+                P::transpose4(v[0], v[1], v[2], v[3]);
+            }
+        }
+
+        template <typename P>
+        inline void store(const std::size_t index, const typename P::Type (&v)[N]) const
+        {
+            _Ty* p{ this->data + index * N };
+            if constexpr (P::Size == 1)
+            {
+                for (int k = 0; k < N; k++)
+                    p[k] = v[k];
+            }
+            else if constexpr (N == 3)
+            {
+                P::store3(p, v[0], v[1], v[2]);
+            }
+            else
+            {
+                typename P::Type t[4]{ v[0], v[1], v[2], v[3] };
+                P::transpose4(t[0], t[1], t[2], t[3]);
+                for (int k = 0; k < 4; k++)
+                    P::store(p + k * 4, t[k]);
+            }
+        }
+    };
+
+    template <typename _Ty, int N>
+    struct VectorAccess<detail::SeparateVectors<_Ty, N>>
+    {
+        using ElementType = std::remove_const_t<_Ty>;
+        using Pack = typename WidestPack<ElementType>::Type;
+
+        _Ty* components[N];
+
+        explicit VectorAccess(const detail::SeparateVectors<_Ty, N>& vectors)
+        {
+            std::copy(vectors.components, vectors.components + N, this->components);
+        }
+
+        template <typename P>
+        inline void load(const std::size_t index, typename P::Type (&v)[N]) const
+        {
+            for (int k = 0; k < N; k++)
+                v[k] = P::load(this->components[k] + index);
+        }
+
+        template <typename P>
+        inline void store(const std::size_t index, const typename P::Type (&v)[N]) const
+        {
+            for (int k = 0; k < N; k++)
+                P::store(this->components[k] + index, v[k]);
+        }
+    };
+
+    // Batched vector kernels over `count` vectors of N entries,
+    // accessed through `InterleavedVectors` or `SeparateVectors`
+
+    template <int N, typename _In>
+    void BatchDot(const _In& lhs, const _In& rhs, typename _In::ElementType* out, const std::size_t count)
+    {
+        const VectorAccess<_In> left{ lhs };
+        const VectorAccess<_In> right{ rhs };
+        ForEachPack<typename VectorAccess<_In>::Pack>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            typename P::Type a[N], b[N];
+            left.template load<P>(index, a);
+            right.template load<P>(index, b);
+            typename P::Type sum{ P::mul(a[0], b[0]) };
+            for (int k = 1; k < N; k++)
+                sum = P::madd(a[k], b[k], sum);
+            P::store(out + index, sum);
+        });
+    }
+
+    template <int N, bool Root, typename _In>
+    void BatchNorm(const _In& in, typename _In::ElementType* out, const std::size_t count)
+    {
+        const VectorAccess<_In> input{ in };
+        ForEachPack<typename VectorAccess<_In>::Pack>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            typename P::Type a[N];
+            input.template load<P>(index, a);
+            typename P::Type sum{ P::mul(a[0], a[0]) };
+            for (int k = 1; k < N; k++)
+                sum = P::madd(a[k], a[k], sum);
+            P::store(out + index, Root ? P::sqrt(sum) : sum);
+        });
+    }
+
+    // `Fast` uses the reciprocal square root estimates of the packs
+    template <int N, bool Fast, typename _In, typename _Out>
+    void BatchNormalize(const _In& in, const _Out& out, const std::size_t count)
+    {
+        const VectorAccess<_In> input{ in };
+        const VectorAccess<_Out> output{ out };
+        ForEachPack<typename VectorAccess<_In>::Pack>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            typename P::Type a[N];
+            input.template load<P>(index, a);
+            typename P::Type sum{ P::mul(a[0], a[0]) };
+            for (int k = 1; k < N; k++)
+                sum = P::madd(a[k], a[k], sum);
+            const typename P::Type scale{ Fast ? P::rsqrt(sum) : P::div(P::broadcast(1), P::sqrt(sum)) };
+            for (int k = 0; k < N; k++)
+                a[k] = P::mul(a[k], scale);
+            output.template store<P>(index, a);
+        });
+    }
+
+    template <typename _In, typename _Out>
+    void BatchCross(const _In& lhs, const _In& rhs, const _Out& out, const std::size_t count)
+    {
+        const VectorAccess<_In> left{ lhs };
+        const VectorAccess<_In> right{ rhs };
+        const VectorAccess<_Out> output{ out };
+        ForEachPack<typename VectorAccess<_In>::Pack>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            typename P::Type a[3], b[3];
+            left.template load<P>(index, a);
+            right.template load<P>(index, b);
+            const typename P::Type c[3]{
+                P::sub(P::mul(a[1], b[2]), P::mul(a[2], b[1])),
+                P::sub(P::mul(a[2], b[0]), P::mul(a[0], b[2])),
+                P::sub(P::mul(a[0], b[1]), P::mul(a[1], b[0])),
+            };
+            output.template store<P>(index, c);
+        });
+    }
+
+    // Entry by entry over `count` entries: lhs += rhs, lhs -= rhs,
+    // lhs *= factor and lhs /= divisor
+    template <typename _Ty>
+    void AddEntries(_Ty* lhs, const _Ty* rhs, const std::size_t count)
+    {
+        ForEachPack<typename WidestPack<_Ty>::Type>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            P::store(lhs + index, P::add(P::load(lhs + index), P::load(rhs + index)));
+        });
+    }
+
+    template <typename _Ty>
+    void SubtractEntries(_Ty* lhs, const _Ty* rhs, const std::size_t count)
+    {
+        ForEachPack<typename WidestPack<_Ty>::Type>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            P::store(lhs + index, P::sub(P::load(lhs + index), P::load(rhs + index)));
+        });
+    }
+
+    template <typename _Ty>
+    void MultiplyEntries(_Ty* lhs, const _Ty factor, const std::size_t count)
+    {
+        ForEachPack<typename WidestPack<_Ty>::Type>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            P::store(lhs + index, P::mul(P::load(lhs + index), P::broadcast(factor)));
+        });
+    }
+
+    template <typename _Ty>
+    void DivideEntries(_Ty* lhs, const _Ty divisor, const std::size_t count)
+    {
+        ForEachPack<typename WidestPack<_Ty>::Type>(count, [&](auto pack, const std::size_t index) {
+            using P = decltype(pack);
+            P::store(lhs + index, P::div(P::load(lhs + index), P::broadcast(divisor)));
+        });
+    }
+
+    // One step of the LU elimination of a row-major (n x n) buffer:
+    // every row of `rows` is reduced by the row `pivot` from column k on,
+    // its factor being stored in column k
+    template <typename _Ty>
+    void EliminateColumn(_Ty* data, const int n, const int pivot, const int* rows, const int count, const int k)
+    {
+        const _Ty* pivotRow{ data + pivot * n + k + 1 };
+        const std::size_t length{ static_cast<std::size_t>(n - k - 1) };
+        for (int i = 0; i < count; i++)
+        {
+            _Ty* row{ data + rows[i] * n };
+            const _Ty factor{ row[k] / pivotRow[-1] };
+            row[k] = factor;
+            row += k + 1;
+            ForEachPack<typename WidestPack<_Ty>::Type>(length, [&](auto pack, const std::size_t index) {
+                using P = decltype(pack);
+                P::store(row + index, P::sub(P::load(row + index), P::mul(P::broadcast(factor), P::load(pivotRow + index))));
+            });
+        }
+    }
+
+    // Index of the lowest set bit of a non-zero mask
+    inline int LowestSetBit(const std::uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    // First occurrence of `byte` in [first, last), or `last`;
+    // compares 32 (AVX2) or 16 (SSE2) bytes at a time
+    inline const char* FindByte(const char* first, const char* last, const char byte)
+    {
+#if MATRIX_KERNEL_AVX2
+        const __m256i pattern32{ _mm256_set1_epi8(byte) };
+        for (; last - first >= 32; first += 32)
+        {
+            const __m256i chunk{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)) };
+            const std::uint32_t mask{ static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern32))) };
+            if (mask != 0)
+                return first + LowestSetBit(mask);
+        }
+#endif
+#if MATRIX_KERNEL_SSE2
+        const __m128i pattern16{ _mm_set1_epi8(byte) };
+        for (; last - first >= 16; first += 16)
+        {
+            const __m128i chunk{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)) };
+            const std::uint32_t mask{ static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern16))) };
+            if (mask != 0)
+                return first + LowestSetBit(mask);
+        }
+#endif
+        for (; first != last; ++first)
+        {
+            if (*first == byte)
+                return first;
+        }
+        return last;
+    }
+
+    // CRC-32C (Castagnoli) table, one entry per byte value
+    inline const std::uint32_t* Crc32cTable()
+    {
+        struct Table
+        {
+            std::uint32_t entries[256];
+
+            Table()
+            {
+                for (std::uint32_t byte = 0; byte < 256; byte++)
+                {
+                    std::uint32_t crc{ byte };
+                    for (int bit = 0; bit < 8; bit++)
+                        crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+                    entries[byte] = crc;
+                }
+            }
+        };
+        static const Table table;
+        return table.entries;
+    }
+
+    // CRC-32C of [data, data + size), continuing from `crc`
+    // (zero for the first piece); SSE4.2 has an instruction for it
+    inline std::uint32_t Crc32c(const void* data, std::size_t size, std::uint32_t crc = 0)
+    {
+        const unsigned char* bytes{ static_cast<const unsigned char*>(data) };
+        crc = ~crc;
+#if MATRIX_KERNEL_SSE42
+#   if defined(_M_X64) || defined(__x86_64__)
+        std::uint64_t wide{ crc };
+        for (; size >= 8; size -= 8, bytes += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, bytes, 8);
+            wide = _mm_crc32_u64(wide, word);
+        }
+        crc = static_cast<std::uint32_t>(wide);
+#   endif
+        for (; size >= 4; size -= 4, bytes += 4)
+        {
+            std::uint32_t word;
+            std::memcpy(&word, bytes, 4);
+            crc = _mm_crc32_u32(crc, word);
+        }
+        for (; size > 0; size--, bytes++)
+            crc = _mm_crc32_u8(crc, *bytes);
+#else
+        const std::uint32_t* table{ Crc32cTable() };
+        for (; size > 0; size--, bytes++)
+            crc = (crc >> 8) ^ table[(crc ^ *bytes) & 0xFFu];
+#endif
+        return ~crc;
+    }
+}
+
+#if defined(MATRIX_KERNEL_TARGETED)
+#   if defined(__clang__)
+#       pragma clang attribute pop
+#   else
+#       pragma GCC pop_options
+#   endif
+#   undef MATRIX_KERNEL_TARGETED
+#endif
+
+#undef MATRIX_KERNEL_SSE2
+#undef MATRIX_KERNEL_SSE42
+#undef MATRIX_KERNEL_AVX
+#undef MATRIX_KERNEL_AVX2
+#undef MATRIX_KERNEL_FMA
+#undef MATRIX_KERNEL_AVX512
+#undef MATRIX_KERNEL_LEVEL
+#undef MATRIX_KERNEL_NAMESPACE
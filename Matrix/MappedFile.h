@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace MatrixMath
+{
+    // Memory mapping of a whole file;
+    // the pages are loaded by the system as they are touched
+    class MappedFile
+    {
+    public:
+        enum class Access : unsigned char
+        {
+            ReadOnly,
+            // writable pages, copied on the first write
+            // and never written back to the file
+            CopyOnWrite,
+        };
+
+    private:
+        const char* data{ nullptr };
+        std::size_t size{ 0 };
+        std::errc error{};
+        Access access{ Access::ReadOnly };
+#if defined(_WIN32)
+        HANDLE file{ INVALID_HANDLE_VALUE };
+        HANDLE mapping{ nullptr };
+#endif
+
+    public:
+        MappedFile() = default;
+        // Check `IsOpen` or `GetError` for failures
+        explicit MappedFile(const char* path, const Access access = Access::ReadOnly);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        // An empty file is open but maps nothing
+        inline bool IsOpen() const;
+        inline std::errc GetError() const;
+        inline const char* GetData() const;
+        // Null unless mapped with Access::CopyOnWrite
+        inline char* GetWritableData() const;
+        inline std::size_t GetSize() const;
+        inline std::string_view GetText() const;
+
+        void Close();
+
+    private:
+        void fail();
+    };
+}
+
+
+inline
+MatrixMath::MappedFile::
+MappedFile(const char* path, const Access access)
+    : access{ access }
+{
+#if defined(_WIN32)
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        this->fail();
+        return;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        this->fail();
+        return;
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (size == 0)
+        return;
+
+    const bool copyOnWrite{ access == Access::CopyOnWrite };
+    mapping = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        this->fail();
+        return;
+    }
+    data = static_cast<const char*>(MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr)
+    {
+        this->fail();
+        return;
+    }
+#else
+    const int descriptor{ ::open(path, O_RDONLY) };
+    if (descriptor < 0)
+    {
+        this->fail();
+        return;
+    }
+
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0)
+    {
+        ::close(descriptor);
+        this->fail();
+        return;
+    }
+    size = static_cast<std::size_t>(status.st_size);
+    if (size > 0)
+    {
+        void* address{ ::mmap(nullptr, size,
+            access == Access::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, descriptor, 0) };
+        if (address == MAP_FAILED)
+        {
+            ::close(descriptor);
+            this->fail();
+            return;
+        }
+        // the parsers walk through the file from the beginning to the end
+        ::madvise(address, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(address);
+    }
+    // the mapping keeps the file alive
+    ::close(descriptor);
+#endif
+}
+
+inline
+MatrixMath::MappedFile::
+MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+inline MatrixMath::MappedFile&
+MatrixMath::MappedFile::
+operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->Close();
+        data = other.data;
+        size = other.size;
+        error = other.error;
+        access = other.access;
+        other.data = nullptr;
+        other.size = 0;
+#if defined(_WIN32)
+        file = other.file;
+        mapping = other.mapping;
+        other.file = INVALID_HANDLE_VALUE;
+        other.mapping = nullptr;
+#endif
+    }
+    return *this;
+}
+
+inline
+MatrixMath::MappedFile::
+~MappedFile()
+{
+    this->Close();
+}
+
+inline bool
+MatrixMath::MappedFile::
+IsOpen() const
+{
+    return error == std::errc{};
+}
+
+inline std::errc
+MatrixMath::MappedFile::
+GetError() const
+{
+    return error;
+}
+
+inline const char*
+MatrixMath::MappedFile::
+GetData() const
+{
+    return data;
+}
+
+inline char*
+MatrixMath::MappedFile::
+GetWritableData() const
+{
+    return access == Access::CopyOnWrite ? const_cast<char*>(data) : nullptr;
+}
+
+inline std::size_t
+MatrixMath::MappedFile::
+GetSize() const
+{
+    return size;
+}
+
+inline std::string_view
+MatrixMath::MappedFile::
+GetText() const
+{
+    return std::string_view(data, size);
+}
+
+inline void
+MatrixMath::MappedFile::
+Close()
+{
+#if defined(_WIN32)
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (data != nullptr)
+        ::munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+inline void
+MatrixMath::MappedFile::
+fail()
+{
+#if defined(_WIN32)
+    const DWORD code{ GetLastError() };
+    error = code == ERROR_FILE_NOT_FOUND || code == ERROR_PATH_NOT_FOUND
+        ? std::errc::no_such_file_or_directory : std::errc::io_error;
+#else
+    error = static_cast<std::errc>(errno);
+#endif
+    this->Close();
+}
@@ -2,10 +2,20 @@
 //
 
 #include <iostream>
+#include <cmath>
+#include <fstream>
 #include <iomanip>
+#include <cstdio>
 
 #include "Matrix.h"
+#include "Binary.h"
+#include "BlockMatrix.h"
+#include "ConstMatrix.h"
+#include "Distributed.h"
 #include "Geometry.h"
+#include "Parse.h"
+#include "SharedMatrix.h"
+#include "TiledMatrix.h"
 
 #ifdef _DEBUG
 #   define SET_DEBUG_NAME(var)     var.name = #var
@@ -74,11 +84,12 @@ int main()
             << std::boolalpha << m2i3.IsTransposed() << std::noboolalpha
             << std::endl
             << std::endl;
+        // m2i2 was moved into m2i3 and holds no data to print
         std::cout
-            << "m2i2 = " << std::endl
-            << m2i2.ToString()
+            << "m2i3t = " << std::endl
+            << m2i3t.ToString()
             << "isTransposed: "
-            << std::boolalpha << m2i2.IsTransposed() << std::noboolalpha
+            << std::boolalpha << m2i3t.IsTransposed() << std::noboolalpha
             << std::endl
             << std::endl;
         std::cout
@@ -150,6 +161,58 @@ int main()
     }
 #endif
 
+    //==============================================
+    // Block
+#if ACTIVATE_MATRIX_TEST
+    {
+        MatrixMath::Matrix<int, 4, 6> m46i1{
+            0, 1, 2, 3, 4, 5,
+            10, 11, 12, 13, 14, 15,
+            20, 21, 22, 23, 24, 25,
+            30, 31, 32, 33, 34, 35,
+        };
+
+        // walk the 2x3 tiles of the matrix in a runtime loop
+        bool succeed{ true };
+        for (int row = 0; row < 4; row += 2)
+        {
+            for (int col = 0; col < 6; col += 3)
+            {
+                auto tile{ m46i1.GetBlock<2, 3>(row, col).Pack() };
+                for (int y = 0; y < 2; y++)
+                    for (int x = 0; x < 3; x++)
+                        succeed = succeed && tile.GetElement(y, x) == (row + y) * 10 + col + x;
+            }
+        }
+        std::cout
+            << "m46i1.GetBlock<2, 3>(row, col).Pack() -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        auto m46i1b1{ m46i1.GetBlock<2, 2>(1, 1) };
+        auto m46i1t1{ m46i1b1.Pack() };
+        m46i1t1.GetElement(0, 0) = -1;
+        m46i1b1.Unpack(m46i1t1);
+        std::cout
+            << "m46i1.GetBlock<2, 2>(1, 1).Unpack(tile) -> "
+            << (m46i1.GetElement(1, 1) == -1 ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // the transposed view shares the buffer, so materializing it reallocates under the block
+        auto m64i1{ m46i1.Transpose() };
+        auto m64i1b1{ m64i1.GetBlock<2, 2>(2, 1) };
+        m64i1.Materialize();
+        m64i1b1.SetElement(1, 1, -2);
+        std::cout
+            << "m64i1.GetBlock<2, 2>(2, 1) after m64i1.Materialize() -> "
+            << (m64i1b1.GetElement(0, 0) == 12 && m64i1b1.GetElement(1, 0) == 13
+                && m64i1.GetElement(3, 2) == -2 && m46i1.GetElement(2, 3) == 23
+                ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
     //==============================================
     // Vector
 #if ACTIVATE_MATRIX_TEST
@@ -186,8 +249,45 @@ int main()
         MatrixMath::Vector4i<> v4i3(std::move(v4i1));
         SET_DEBUG_NAME(v4i3);
         std::cout
-            << "v4i1 == v4i3 -> "
-            << (v4i1 == v4i3 ? "[Succeed]" : "[Fail]")
+            << "v4i2 == v4i3 -> "
+            << (v4i2 == v4i3 ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+
+        // Test: Vector algorithms
+        MatrixMath::Vector3f<> v3f1{ 3.0f, 0.0f, 4.0f };
+        MatrixMath::Vector3f<> v3f2{ 0.0f, 1.0f, 0.0f };
+        std::cout
+            << "v3f1.Dot(v3f2) == 0, v3f1.Norm() == 5 -> "
+            << (v3f1.Dot(v3f2) == 0.0f && v3f1.Norm() == 5.0f ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        auto v3f3{ v3f1.Cross(v3f2) };
+        std::cout
+            << "v3f1 x v3f2 =" << std::endl
+            << v3f3.ToString()
+            << std::endl
+            << " -> "
+            << (v3f3 == MatrixMath::Vector3f<>{ -4.0f, 0.0f, 3.0f } ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        auto v3f4{ v3f1.Normalize<MatrixMath::Precision::Fast>() };
+        std::cout
+            << "|v3f1 / |v3f1|| == 1 -> "
+            << (std::abs(v3f4.Norm() - 1.0f) < 1e-6f ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // Test: Batched vector algorithms over interleaved vectors
+        float xyz[4][3]{ { 3, 0, 4 }, { 0, 2, 0 }, { 1, 2, 2 }, { 0, 0, 7 } };
+        float norms[4];
+        MatrixMath::BatchNormalize<3>(&xyz[0][0], &xyz[0][0], 4);
+        MatrixMath::BatchNorm<3>(&xyz[0][0], norms, 4);
+        bool succeed{ true };
+        for (const float norm : norms)
+            succeed = succeed && std::abs(norm - 1.0f) < 1e-6f;
+        std::cout
+            << "BatchNormalize -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
             << std::endl
             << std::endl;
     }
@@ -333,6 +433,60 @@ int main()
     }
 #endif
 
+    //==============================================
+    // Implicit matrices
+#if ACTIVATE_MATRIX_TEST
+    {
+        MatrixMath::Matrix<int, 3, 2> m32i1{
+            1, 2,
+            3, 4,
+            5, 6,
+        };
+
+        MatrixMath::Identity<int, 3> i3i1;
+        std::cout
+            << "i3i1 * m32i1 == m32i1 -> "
+            << (i3i1 * m32i1 == m32i1 ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        MatrixMath::Diagonal<int, 3> d3i1{ 1, 10, 100 };
+        std::cout
+            << "d3i1 * m32i1 -> "
+            << (d3i1 * m32i1 == MatrixMath::Matrix<int, 3, 2>{ 1, 2, 30, 40, 500, 600 } ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        MatrixMath::Permutation<3> p3i1{ 2, 0, 1 };
+        std::cout
+            << "p3i1 = " << std::endl
+            << p3i1.ToString()
+            << "p3i1 * m32i1 -> "
+            << (p3i1 * m32i1 == MatrixMath::Matrix<int, 3, 2>{ 5, 6, 1, 2, 3, 4 } ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        MatrixMath::MatrixQ<double, 4> m4d1{
+            0.0, 2.0, 1.0, 4.0,
+            1.0, 1.0, 0.0, 2.0,
+            3.0, 0.0, 2.0, 1.0,
+            2.0, 1.0, 1.0, 0.0,
+        };
+        MatrixMath::LUDecomposition lu4d1(m4d1);
+        const auto lhs{ lu4d1.GetPermutation() * m4d1 };
+        const auto rhs{ lu4d1.GetLower() * lu4d1.GetUpper() };
+        bool succeed{ true };
+        for (int row = 0; row < 4; row++)
+            for (int col = 0; col < 4; col++)
+                succeed = succeed && std::abs(lhs.GetElement(row, col) - rhs.GetElement(row, col)) < 1e-12;
+        std::cout
+            << "P * m4d1 == L * U -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << "det(m4d1) = " << MatrixMath::Determinant(m4d1).value() << " "
+            << (std::abs(MatrixMath::Determinant(m4d1).value() - 17.0) < 1e-12 ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
     //==============================================
     // Determinant
 #if ACTIVATE_MATRIX_TEST
@@ -371,6 +525,36 @@ int main()
             << "m2f2 = " << std::endl
             << m2f2.ToString()
             << std::endl;
+
+        MatrixMath::Matrix<float, 40, 36> m4036f1;
+        for (int row = 0; row < 40; row++)
+            for (int col = 0; col < 36; col++)
+                m4036f1.SetElement(row, col, static_cast<float>(row * 100 + col));
+        auto m4036f2{ MatrixMath::ChangeOrder<MatrixMath::StorageOrder::ColumnMajor>(m4036f1) };
+        auto m3640f1{ m4036f1.Transpose() };
+        m3640f1.Materialize();
+        bool succeed{ !m3640f1.IsTransposed() };
+        for (int row = 0; row < 40; row++)
+            for (int col = 0; col < 36; col++)
+                succeed = succeed
+                    && m4036f2.GetElement(row, col) == m4036f1.GetElement(row, col)
+                    && m3640f1.GetElement(col, row) == m4036f1.GetElement(row, col);
+        std::cout
+            << "ChangeOrder(m4036f1) / m4036f1.Transpose().Materialize() -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        MatrixMath::Matrix3i<> m3i1{
+            1, 2, 3,
+            4, 5, 6,
+            7, 8, 9,
+        };
+        m3i1.TransposeInPlace();
+        std::cout
+            << "m3i1.TransposeInPlace() -> "
+            << (m3i1 == MatrixMath::Matrix3i<>{ 1, 4, 7, 2, 5, 8, 3, 6, 9 } ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
     }
 #endif
 
@@ -453,6 +637,720 @@ int main()
             << "Merge Result = " << std::endl
             << mrgres1.ToString()
             << std::endl;
+
+        bool succeed{ true };
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 7; col++)
+                succeed = succeed && mrgres1.GetElement(row, col) == mrgres.GetElement(row, col);
+        std::cout
+            << "Merge<ROW_MEG>(left, identity) == Merge<ROW>(left, identity) -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        auto mrgres2 = MatrixMath::Merge<MatrixMath::MergeMode::COL_MEG, MatrixMath::StorageOrder::ColumnMajor>(
+            identity, identity.Transpose(), identity);
+        std::cout
+            << "Merge Result = " << std::endl
+            << mrgres2.ToString()
+            << "Merge<COL_MEG>(identity, identity.Transpose(), identity) -> "
+            << (mrgres2.GetElement(4, 1) == 1 && mrgres2.GetElement(8, 2) == 1 && mrgres2.GetElement(8, 1) == 0
+                ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Constant Matrix
+#if ACTIVATE_MATRIX_TEST
+    {
+        // everything below is evaluated at compile time
+        constexpr MatrixMath::ConstMatrixQ<double, 3> cm3d1{
+            2.0, 0.0, 1.0,
+            1.0, 3.0, 2.0,
+            1.0, 1.0, 2.0,
+        };
+        constexpr double detCm3d1{ cm3d1.Determinant() };
+        static_assert(detCm3d1 == 6.0, "Constant determinant");
+        constexpr auto cm3d2{ cm3d1 * cm3d1.Inverse() };
+        static_assert(cm3d1.Transpose().Transpose() == cm3d1, "Constant transpose");
+
+        auto m3d1{ cm3d2.ToMatrix() };
+        bool succeed{ true };
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 3; col++)
+                succeed = succeed && std::abs(m3d1.GetElement(row, col) - (row == col ? 1.0 : 0.0)) < 1e-12;
+        std::cout
+            << "cm3d1 * cm3d1^-1 =" << std::endl
+            << m3d1.ToString()
+            << std::endl
+            << " -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Block Matrix
+#if ACTIVATE_MATRIX_TEST
+    {
+        MatrixMath::Matrix2d<> a{ 4.0, 1.0, 1.0, 3.0 };
+        MatrixMath::Matrix2d<> b{ 1.0, 2.0, 0.0, 1.0 };
+        MatrixMath::Matrix2d<> c{ 0.0, 1.0, 1.0, 0.0 };
+        MatrixMath::Matrix2d<> d{ 5.0, 0.0, 2.0, 6.0 };
+
+        // the blocks share the data containers of a, b, c and d
+        auto bm4d1{ MatrixMath::Merge<2, 2>(a, b, c, d) };
+        std::cout
+            << "bm4d1 = " << std::endl
+            << bm4d1.ToString()
+            << std::endl;
+
+        auto bm4d2{ MatrixMath::Inverse(bm4d1) * bm4d1 };
+        bool succeed{ true };
+        for (int row = 0; row < 4; row++)
+            for (int col = 0; col < 4; col++)
+                succeed = succeed && std::abs(bm4d2.GetElement(row, col) - (row == col ? 1.0 : 0.0)) < 1e-9;
+        std::cout
+            << "Inverse(bm4d1) * bm4d1 == I -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        auto bm4d3{ bm4d1.Transpose() };
+        const bool isTransposed{ bm4d3.GetElement(0, 2) == 0.0 && bm4d3.GetElement(2, 0) == 1.0 && bm4d3.GetElement(3, 0) == 2.0 };
+        // the block (0, 1) of bm4d3 is c^T, which bm4d1 and c still see as c
+        bm4d3.AssignBlock(0, 1, MatrixMath::Matrix2d<>{ 1.0, 2.0, 3.0, 4.0 });
+        std::cout
+            << "bm4d1.Transpose() -> "
+            << (isTransposed && bm4d3.GetElement(0, 3) == 2.0 && bm4d1.GetElement(3, 0) == 2.0
+                && bm4d1.GetElement(2, 1) == 3.0 && c.GetElement(0, 1) == 3.0
+                ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Formatting
+#if ACTIVATE_MATRIX_TEST
+    {
+        MatrixMath::Matrix<double, 2, 3> m23d1{
+            1.5, -2.0, 0.1,
+            4.0, 1e-7, 6.0,
+        };
+        const std::string csv{ MatrixMath::Format(m23d1, MatrixMath::FormatOptions::CSV()) };
+        const std::string matlab{ MatrixMath::Format(m23d1, MatrixMath::FormatOptions::Matlab()) };
+        std::cout
+            << "m23d1 as CSV =" << std::endl
+            << csv
+            << "m23d1 as Matlab = " << matlab
+            << std::endl
+            << " -> "
+            << (csv == "1.5,-2,0.1\n4,1e-07,6\n" && matlab == "[ 1.5 -2 0.1; 4 1e-07 6 ]"
+                && MatrixMath::FormattedSize(m23d1) == m23d1.ToString().size()
+                ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Parsing
+#if ACTIVATE_MATRIX_TEST
+    {
+        MatrixMath::DynamicMatrix<double> dm1;
+        const MatrixMath::ParseResult parsed{ MatrixMath::ParseMatrix("1.5, -2, 0.1\r\n\n4, 1e-7, +6\n", dm1) };
+        MatrixMath::Matrix<int, 2, 2> m22i1;
+        const MatrixMath::ParseResult mismatch{ MatrixMath::ParseMatrix("1 2\n3 4 5\n", m22i1) };
+        const MatrixMath::ParseResult signs{ MatrixMath::ParseMatrix("1 +-2\n3 4\n", m22i1) };
+        std::cout
+            << "dm1 parsed from CSV =" << std::endl
+            << dm1.ToString()
+            << "m22i1 from a ragged text: error on line " << mismatch.line
+            << std::endl
+            << " -> "
+            << (parsed && dm1.GetHeight() == 2 && dm1.GetWidth() == 3 && dm1.GetElement(1, 2) == 6.0
+                && mismatch.ec == std::errc::invalid_argument && mismatch.line == 2
+                && signs.ec == std::errc::invalid_argument && signs.line == 1
+                ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // force four chunks on a text of 400 rows with a blank line every 50 rows,
+        // CRLF endings and no trailing newline; row r is on line r + 1 + (r + 1) / 50
+        const auto makeText{ [](const int badRow) {
+            std::string text;
+            for (int row = 0; row < 400; row++)
+            {
+                if (row % 50 == 49)
+                    text += "\r\n";
+                text += (row == badRow ? std::string{ "3x" } : std::to_string(row))
+                    + ", " + std::to_string(row) + ".5; " + std::to_string(-row);
+                if (row + 1 < 400)
+                    text += "\r\n";
+            }
+            return text;
+        } };
+        const MatrixMath::ParseOptions chunked{ 0, 4, 1 };
+        MatrixMath::DynamicMatrix<double> dm2;
+        const MatrixMath::ParseResult parallel{ MatrixMath::ParseMatrix(makeText(-1), dm2, chunked) };
+        MatrixMath::DynamicMatrix<double> dm3;
+        const MatrixMath::ParseResult late{ MatrixMath::ParseMatrix(makeText(390), dm3, chunked) };
+        std::cout
+            << "dm2 parsed in 4 chunks: " << parallel.rows << " rows, error of row 390 on line " << late.line
+            << std::endl
+            << " -> "
+            << (parallel && dm2.GetHeight() == 400 && dm2.GetWidth() == 3
+                && dm2.GetElement(0, 0) == 0.0 && dm2.GetElement(205, 1) == 205.5
+                && dm2.GetElement(320, 0) == 320.0 && dm2.GetElement(399, 2) == -399.0
+                && late.ec == std::errc::invalid_argument && late.line == 398
+                ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Binary files
+#if ACTIVATE_MATRIX_TEST
+    {
+        MatrixMath::Matrix<double, 2, 3> m23d2{
+            0.1, 0.2, 0.3,
+            1.0 / 3.0, -0.0, 1e300,
+        };
+        const char* path{ "Matrix_Test.mtx" };
+        const std::errc saved{ MatrixMath::SaveBinary(path, m23d2) };
+
+        std::errc loaded;
+        {
+            // a view into the mapped file, valid after the file object is gone
+            const MatrixMath::Matrix<double, 2, 3> m23d3{ MatrixMath::LoadBinary<MatrixMath::Matrix<double, 2, 3>>(path, loaded, true) };
+            std::cout
+                << "m23d3 loaded from " << path << " =" << std::endl
+                << m23d3.ToString()
+                << " -> "
+                << (saved == std::errc{} && loaded == std::errc{} && m23d3 == m23d2 ? "[Succeed]" : "[Fail]")
+                << std::endl;
+        }
+
+        // a checksum is easily recomputed: a header with no valid alignment is still rejected
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            MatrixMath::BinaryHeader header;
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            header.alignment = 0;
+            header.headerChecksum = detail::Crc32c(&header, detail::BinaryHeaderChecksumSize);
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+        std::errc rejected;
+        MatrixMath::LoadBinary<MatrixMath::Matrix<double, 2, 3>>(path, rejected);
+        std::cout
+            << "alignment 0 -> "
+            << (rejected == std::errc::illegal_byte_sequence ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+        std::remove(path);
+    }
+#endif
+
+    //==============================================
+    // Out-of-core matrices
+#if ACTIVATE_MATRIX_TEST
+    {
+        // 3 x 3 tiles of 4 x 4 entries, the last ones being padded
+        MatrixMath::DynamicMatrix<double> dm2(10, 10);
+        for (int row = 0; row < 10; row++)
+            for (int col = 0; col < 10; col++)
+                dm2.SetElement(row, col, row == col ? 2.0 : (row + col) % 3);
+
+        std::errc ec;
+        const auto tm1{ MatrixMath::TiledMatrix<double>::Create("Matrix_Test_A.tiles", 10, 10, 4, ec) };
+        const auto tm2{ MatrixMath::TiledMatrix<double>::Create("Matrix_Test_B.tiles", 10, 10, 4, ec) };
+        tm1.Store(dm2);
+
+        // room for one tile of the result and four tiles of the operands
+        MatrixMath::OutOfCoreOptions options;
+        options.memoryBudget = 5 * tm1.GetTileBytes();
+        const MatrixMath::OutOfCoreResult multiplied{ MatrixMath::Multiply(tm1, tm1, tm2, options) };
+        MatrixMath::DynamicMatrix<double> dm3;
+        tm2.Load(dm3);
+
+        bool isEqual{ true };
+        for (int row = 0; row < 10; row++)
+        {
+            for (int col = 0; col < 10; col++)
+            {
+                double sum{ 0.0 };
+                for (int k = 0; k < 10; k++)
+                    sum += dm2.GetElement(row, k) * dm2.GetElement(k, col);
+                isEqual = isEqual && dm3.GetElement(row, col) == sum;
+            }
+        }
+
+        // the operands are left untouched when the result is one of them, or not open
+        const auto tm3{ MatrixMath::TiledMatrix<double>::Open("Matrix_Test_A.tiles", ec) };
+        const MatrixMath::TiledMatrix<double> closed;
+        const bool isRejected{ MatrixMath::Multiply(tm1, tm1, tm3).ec == std::errc::invalid_argument
+            && MatrixMath::Transpose(tm1, tm3).ec == std::errc::invalid_argument
+            && MatrixMath::Multiply(closed, closed, closed).ec == std::errc::invalid_argument };
+        std::cout
+            << "dm2 * dm2 out of core: " << multiplied.bytesRead << " bytes read, "
+            << multiplied.residentBytes << " bytes resident"
+            << std::endl
+            << " -> "
+            << (multiplied && multiplied.residentBytes <= options.memoryBudget && isEqual && isRejected ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+    std::remove("Matrix_Test_A.tiles");
+    std::remove("Matrix_Test_B.tiles");
+#endif
+
+    //==============================================
+    // Shared memory
+#if ACTIVATE_MATRIX_TEST
+    {
+        using SharedMatrix3f = MatrixMath::SharedMatrix<float, 3, 3>;
+
+        // the writer and the reader would live in two processes
+        SharedMatrix3f writer{ SharedMatrix3f::Create("/Matrix_Test_Shared") };
+        const SharedMatrix3f reader{ SharedMatrix3f::Attach("/Matrix_Test_Shared") };
+
+        writer.Store(MatrixMath::IdentityMatrix<float, 3>());
+        writer.Write([](MatrixMath::Matrix<float, 3, 3>& entries) { entries.SetElement(0, 2, 5.0f); });
+
+        std::uint64_t version{ 0 };
+        const float trace{ reader.Read([](const MatrixMath::Matrix<float, 3, 3>& entries) {
+            return entries.GetElement(0, 0) + entries.GetElement(1, 1) + entries.GetElement(2, 2);
+        }, &version) };
+        float corner{ 0.0f };
+        reader.Read([&corner](const MatrixMath::Matrix<float, 3, 3>& entries) { corner = entries.GetElement(0, 2); });
+        std::cout
+            << "shared m33f, version " << version << " =" << std::endl
+            << reader.View().ToString()
+            << " -> "
+            << (writer.IsOpen() && reader.IsOpen() && version == 2 && trace == 3.0f && corner == 5.0f
+                && reader.Load().GetElement(0, 2) == 5.0f
+                ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Distributed matrices
+#if ACTIVATE_MATRIX_TEST
+    {
+        // 4 local processes in a (2 x 2) grid, with blocks of 2 x 2
+        const MatrixMath::DynamicMatrix<double> a(5, 5, {
+            4.0, 1.0, 0.0, 2.0, 1.0,
+            1.0, 5.0, 2.0, 0.0, 3.0,
+            0.0, 2.0, 6.0, 1.0, 0.0,
+            2.0, 0.0, 1.0, 7.0, 2.0,
+            1.0, 3.0, 0.0, 2.0, 8.0 });
+        const int code{ MatrixMath::RunLocalProcesses(4, [&a](MatrixMath::Transport& transport) {
+            const MatrixMath::ProcessGrid grid{ MatrixMath::ProcessGrid::Square(transport) };
+            MatrixMath::DistributedMatrix<double> lhs(transport, grid, 5, 5, 2);
+            MatrixMath::DistributedMatrix<double> product(transport, grid, 5, 5, 2);
+            if (lhs.Scatter(a, 0) != std::errc{} || MatrixMath::Multiply(lhs, lhs, product) != std::errc{})
+                return 1;
+            std::vector<int> pivots;
+            if (MatrixMath::DecomposeLU(lhs, pivots) != std::errc{})
+                return 2;
+
+            MatrixMath::DynamicMatrix<double> squared;
+            MatrixMath::DynamicMatrix<double> lu;
+            if (product.Gather(squared, 0) != std::errc{} || lhs.Gather(lu, 0) != std::errc{})
+                return 3;
+            if (transport.GetRank() != 0)
+                return 0;
+
+            // the determinant from the diagonal of U and the exchanges
+            double determinant{ 1.0 };
+            for (int i = 0; i < 5; i++)
+                determinant *= pivots[i] == i ? lu.GetElement(i, i) : -lu.GetElement(i, i);
+            std::cout
+                << "a * a =" << std::endl
+                << squared.ToString()
+                << "det(a) = " << determinant
+                << std::endl;
+            return squared.GetElement(0, 0) == 22.0 && std::abs(determinant - 2857.0) < 1e-9 ? 0 : 4;
+        }) };
+
+        // a single block of 10 x 10 on a (3 x 2) grid: all but one process hold nothing
+        MatrixMath::DynamicMatrix<double> b(10, 10);
+        for (int i = 0; i < 10; i++)
+            b.SetElement(i, i, i + 1.0);
+        const int sparseCode{ MatrixMath::RunLocalProcesses(6, [&b](MatrixMath::Transport& transport) {
+            const MatrixMath::ProcessGrid grid{ MatrixMath::ProcessGrid::Make(transport, 3, 2) };
+            MatrixMath::DistributedMatrix<double> lhs(transport, grid, 10, 10, 16);
+            MatrixMath::DistributedMatrix<double> product(transport, grid, 10, 10, 16);
+            MatrixMath::DynamicMatrix<double> squared;
+            if (lhs.Scatter(b, 0) != std::errc{} || MatrixMath::Multiply(lhs, lhs, product) != std::errc{}
+                || product.Gather(squared, 0) != std::errc{})
+                return 1;
+            return transport.GetRank() != 0 || squared.GetElement(9, 9) == 100.0 ? 0 : 2;
+        }) };
+        std::cout
+            << "distributed on 4 and on 6 processes -> "
+            << (code == 0 && sparseCode == 0 ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Instrumentation
+#if ACTIVATE_MATRIX_TEST
+    {
+        // compiled out unless MATRIX_INSTRUMENT is defined
+        MatrixMath::ResetCounters();
+        {
+            const MatrixMath::Matrix3f<> m3f1{ 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f };
+            const MatrixMath::Matrix3f<> m3f2{ m3f1 };
+            const auto m3f3{ m3f2.Transpose() };
+        }
+        const std::vector<MatrixMath::TypeCounters> counters{ MatrixMath::SnapshotCounters() };
+        for (const MatrixMath::TypeCounters& type : counters)
+            std::cout
+                << type.type << ": "
+                << type.counters.allocations << " allocations, "
+                << type.counters.bytes << " bytes, "
+                << type.counters.copies << " copies, "
+                << type.counters.aliases << " aliases, "
+                << type.counters.destructions << " destructions"
+                << std::endl;
+        const bool isCounted{ counters.size() == 1 && counters[0].counters.allocations == 2
+            && counters[0].counters.copies == 1 && counters[0].counters.aliases == 1
+            && counters[0].counters.destructions == 3 };
+        std::cout
+            << (MatrixMath::IsInstrumented ? "instrumented" : "not instrumented")
+            << " -> "
+            << ((MatrixMath::IsInstrumented ? isCounted : counters.empty()) ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Tracing
+#if ACTIVATE_MATRIX_TEST
+    {
+        // compiled out unless MATRIX_TRACE is defined
+        MatrixMath::ResetTrace();
+        const MatrixMath::Matrix4d<> m4d1{ 2.0, 0.0, 0.0, 1.0, 0.0, 3.0, 0.0, 0.0, 0.0, 0.0, 4.0, 0.0, 1.0, 0.0, 0.0, 5.0 };
+        const MatrixMath::Matrix4d<> m4d2{ m4d1 * m4d1 };
+        const double det{ MatrixMath::Determinant(m4d2).value() };
+
+        const std::vector<MatrixMath::OperationStats> operations{ MatrixMath::SnapshotOperations() };
+        std::cout << MatrixMath::FormatTraceSummary();
+        const bool isTraced{ std::any_of(operations.begin(), operations.end(), [](const MatrixMath::OperationStats& stats) {
+            return stats.name == "operator*" && stats.calls == 1 && stats.flops == 128;
+        }) };
+        std::cout
+            << (MatrixMath::IsTraced ? "traced" : "not traced")
+            << ", det(m4d1 * m4d1) = " << det
+            << " -> "
+            << ((MatrixMath::IsTraced ? isTraced : operations.empty()) ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Tuning
+#if ACTIVATE_MATRIX_TEST
+    {
+        // the smallest blocks and leaves give the same results as the defaults
+        const MatrixMath::TuningParameters defaults{ MatrixMath::GetTuning() };
+        MatrixMath::TuningParameters small{ defaults };
+        small.multiplyRows = 1;
+        small.multiplyDepth = 3;
+        small.multiplyWidth = 16;
+        small.transposeLeaf = MatrixMath::MinTransposeLeafSize;
+        small.luBlock = 2;
+
+        const int n{ 37 };
+        std::vector<double> a(n * n), b(n * n), c1(n * n), c2(n * n), t1(n * n), t2(n * n);
+        for (int i = 0; i < n * n; i++)
+        {
+            a[i] = i % 7 - 3.0;
+            b[i] = i % 5 - 2.0;
+        }
+        detail::MultiplyAddBlock(a.data(), n, b.data(), n, c1.data(), n, n, n, n);
+        detail::TransposeBlock(a.data(), n, t1.data(), n, n, n);
+
+        // saved as the entry of this machine, and loaded back
+        const char* path{ "Matrix_Test.cfg" };
+        const std::errc saved{ MatrixMath::SaveTuning(path, small) };
+        const std::errc loaded{ MatrixMath::LoadTuning(path) };
+        const bool isLoaded{ MatrixMath::GetTuning().multiplyDepth == 3 && MatrixMath::GetTuning().luBlock == 2 };
+        std::remove(path);
+
+        detail::MultiplyAddBlock(a.data(), n, b.data(), n, c2.data(), n, n, n, n);
+        t2 = a;
+        detail::TransposeSquareInPlace(t2.data(), n, n);
+
+        // the 5 x 5 matrix of the distributed section, in blocks of 2 on one process
+        const MatrixMath::DynamicMatrix<double> m55d1(5, 5, {
+            4.0, 1.0, 0.0, 2.0, 1.0,
+            1.0, 5.0, 2.0, 0.0, 3.0,
+            0.0, 2.0, 6.0, 1.0, 0.0,
+            2.0, 0.0, 1.0, 7.0, 2.0,
+            1.0, 3.0, 0.0, 2.0, 8.0 });
+        MatrixMath::SingleProcessTransport transport;
+        MatrixMath::DistributedMatrix<double> dm1(transport, MatrixMath::ProcessGrid::Square(transport), 5, 5);
+        std::vector<int> pivots;
+        dm1.Scatter(m55d1, 0);
+        const std::errc decomposed{ MatrixMath::DecomposeLU(dm1, pivots) };
+        double det{ 1.0 };
+        for (int i = 0; i < 5; i++)
+            det *= (pivots[i] != i ? -1.0 : 1.0) * dm1.GetLocal().GetElement(i, i);
+
+        MatrixMath::TuningParameters invalid{ defaults };
+        invalid.multiplyRows = 3;
+        const std::errc rejected{ MatrixMath::SetTuning(invalid) };
+        MatrixMath::SetTuning(defaults);
+
+        std::cout
+            << MatrixMath::GetMachineKey()
+            << ", block size " << dm1.GetBlockSize()
+            << ", det = " << det
+            << " -> "
+            << (saved == std::errc{} && loaded == std::errc{} && isLoaded && c1 == c2 && t1 == t2
+                && decomposed == std::errc{} && dm1.GetBlockSize() == 2 && std::abs(det - 2857.0) < 1e-9
+                && rejected == std::errc::invalid_argument ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // CPU dispatch
+#if ACTIVATE_MATRIX_TEST
+    {
+        // every level the processor supports gives the results of the scalar kernels
+        const MatrixMath::CpuFeatures& features{ MatrixMath::GetCpuFeatures() };
+        const MatrixMath::IsaLevel initial{ MatrixMath::GetIsaLevel() };
+        const MatrixMath::IsaLevel supported{ MatrixMath::GetSupportedIsaLevel() };
+
+        const int n{ 37 };
+        std::vector<double> a(n * n), b(n * n);
+        std::vector<float> xyz(3 * n);
+        std::string text(1000, 'x');
+        text[777] = '\n';
+        for (int i = 0; i < n * n; i++)
+        {
+            a[i] = i % 7 - 3.0;
+            b[i] = i % 5 - 2.0;
+        }
+        for (int i = 0; i < 3 * n; i++)
+            xyz[i] = static_cast<float>(i % 11) + 1.0f;
+        MatrixMath::MatrixQ<double, 12> m12d1;
+        for (int row = 0; row < 12; row++)
+            for (int col = 0; col < 12; col++)
+                m12d1.SetElement(row, col, row == col ? 20.0 + row : (row * 3 + col * 5) % 7 - 3.0);
+
+        // the geometry kernels: n points and boxes, some of the boxes
+        // across the planes of the view volume [-1, 1]^3, and n rotations
+        const MatrixMath::Transform3f tf1{ MatrixMath::Transform3f::Translation(1.0f, -2.0f, 0.5f)
+            * MatrixMath::Transform3f::Rotation(1.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.7f) * MatrixMath::Transform3f::Scaling(2.0f, 1.0f, 3.0f) };
+        const MatrixMath::Frustumf fr1{ MatrixMath::IdentityMatrix<float, 4>() };
+        std::vector<float> xs(n), ys(n), zs(n), extents(n);
+        std::vector<MatrixMath::Quaternionf> quaternions;
+        for (int i = 0; i < n; i++)
+        {
+            xs[i] = (i % 7 - 3) * 0.6f;
+            ys[i] = (i % 5 - 2) * 0.7f;
+            zs[i] = (i % 3 - 1) * 0.9f;
+            extents[i] = 0.25f;
+            quaternions.push_back(i % 2 == 0
+                ? MatrixMath::Quaternionf::AxisAngle(0.6f, 0.0f, 0.8f, 0.1f * i)
+                : MatrixMath::Quaternionf::AxisAngle(0.0f, 0.8f, -0.6f, -0.2f * i));
+        }
+
+        const auto close = [](const double lhs, const double rhs) {
+            return std::abs(lhs - rhs) <= 1e-5 * std::max(1.0, std::abs(rhs));
+        };
+        std::vector<double> c0, s0;
+        std::vector<float> normalized0, geometry0;
+        std::vector<MatrixMath::Quaternionf> converted0;
+        std::uint32_t visible0[4]{};
+        double det0{ 0.0 };
+        std::uint32_t crc0{ 0 };
+        bool isSame{ true };
+        std::cout << "sse2 " << features.sse2 << ", sse4.2 " << features.sse42 << ", avx2 " << features.avx2
+            << ", fma " << features.fma << ", avx512f " << features.avx512f << ":";
+        for (int level = 0; level <= static_cast<int>(supported); level++)
+        {
+            const std::errc set{ MatrixMath::SetIsaLevel(static_cast<MatrixMath::IsaLevel>(level)) };
+            isSame = isSame && set == std::errc{};
+            std::cout << " " << MatrixMath::GetIsaName(MatrixMath::GetIsaLevel());
+
+            std::vector<double> c(n * n), t(n * n);
+            detail::MultiplyAddBlock(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+            detail::TransposeBlock(c.data(), n, t.data(), n, n, n);
+            detail::TransposeSquareInPlace(t.data(), n, n);
+            std::vector<float> normalized(xyz.size());
+            MatrixMath::BatchNormalize<3>(xyz.data(), normalized.data(), n);
+            MatrixMath::MatrixQ<double, 12> m12d2{ m12d1 };
+            m12d2 += m12d1;
+            m12d2 *= 0.5;
+            const std::vector<double> s(m12d2.GetData().begin(), m12d2.GetData().end());
+            const double det{ MatrixMath::Determinant(m12d2).value() };
+            const std::uint32_t crc{ detail::Crc32c(text.data(), text.size()) };
+            const char* newline{ detail::FindByte(text.data(), text.data() + text.size(), '\n') };
+
+            // points interleaved and separated, normals, and rotations there and back
+            std::vector<float> geometry(12 * n);
+            tf1.TransformPoints(xyz.data(), geometry.data(), n);
+            tf1.TransformPoints(xs.data(), ys.data(), zs.data(), &geometry[3 * n], &geometry[4 * n], &geometry[5 * n], n);
+            tf1.TransformNormals(xyz.data(), &geometry[6 * n], n);
+            std::vector<float> rotations(9 * n);
+            MatrixMath::QuaternionsToMatrices(quaternions.data(), rotations.data(), n);
+            geometry.insert(geometry.end(), rotations.begin(), rotations.end());
+            std::vector<MatrixMath::Quaternionf> converted(n);
+            MatrixMath::MatricesToQuaternions(rotations.data(), converted.data(), n);
+            std::uint32_t visible[4]{};
+            fr1.CullBoxes(xs.data(), ys.data(), zs.data(), extents.data(), extents.data(), extents.data(), visible, n);
+            fr1.CullSpheres(xs.data(), ys.data(), zs.data(), extents.data(), visible + 2, n);
+
+            if (level == 0)
+            {
+                c0 = c;
+                s0 = s;
+                normalized0 = normalized;
+                geometry0 = geometry;
+                converted0 = converted;
+                std::copy(visible, visible + 4, visible0);
+                det0 = det;
+                crc0 = crc;
+            }
+            isSame = isSame && t == c && close(det, det0) && crc == crc0 && newline == text.data() + 777
+                && std::equal(visible, visible + 4, visible0);
+            for (int i = 0; i < n * n; i++)
+                isSame = isSame && close(c[i], c0[i]);
+            for (std::size_t i = 0; i < s.size(); i++)
+                isSame = isSame && close(s[i], s0[i]);
+            for (std::size_t i = 0; i < normalized.size(); i++)
+                isSame = isSame && close(normalized[i], normalized0[i]);
+            for (std::size_t i = 0; i < geometry.size(); i++)
+                isSame = isSame && close(geometry[i], geometry0[i]);
+            // q and -q are the same rotation
+            for (int i = 0; i < n; i++)
+                isSame = isSame && std::abs(std::abs(converted[i].Dot(converted0[i])) - 1.0f) < 1e-5f
+                    && std::abs(std::abs(converted[i].Dot(quaternions[i])) - 1.0f) < 1e-5f;
+        }
+
+        const bool isRejected{ supported == MatrixMath::IsaLevel::Avx512
+            || MatrixMath::SetIsaLevel(MatrixMath::IsaLevel::Avx512) == std::errc::not_supported };
+        MatrixMath::SetIsaLevel(initial);
+        std::cout
+            << ", det(m12d1) = " << det0
+            << " -> "
+            << (isSame && isRejected && MatrixMath::GetIsaLevel() == initial ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
+    }
+#endif
+
+    //==============================================
+    // Geometry
+#if ACTIVATE_MATRIX_TEST
+    {
+        const float halfPi{ 1.57079632679f };
+        MatrixMath::Transform3f tf1{ MatrixMath::Transform3f::Rotation(0.0f, 0.0f, 1.0f, halfPi) };
+        std::cout
+            << "tf1 = " << std::endl
+            << tf1.ToString()
+            << std::endl;
+
+        // 10 points interleaved, so that both the SIMD body and the remainder run
+        float points[30];
+        float xs[10], ys[10], zs[10];
+        for (int i = 0; i < 10; i++)
+        {
+            points[i * 3 + 0] = xs[i] = static_cast<float>(i);
+            points[i * 3 + 1] = ys[i] = 1.0f;
+            points[i * 3 + 2] = zs[i] = -static_cast<float>(i);
+        }
+        tf1.TransformPoints(points, points, 10);
+        tf1.TransformPoints(xs, ys, zs, xs, ys, zs, 10);
+
+        // (x, y, z) -> (-y, x, z)
+        bool succeed{ true };
+        for (int i = 0; i < 10; i++)
+        {
+            succeed = succeed && std::abs(points[i * 3 + 0] + 1.0f) < 1e-5f
+                && std::abs(points[i * 3 + 1] - i) < 1e-5f
+                && std::abs(points[i * 3 + 2] + i) < 1e-5f;
+            succeed = succeed && xs[i] == points[i * 3 + 0] && ys[i] == points[i * 3 + 1] && zs[i] == points[i * 3 + 2];
+        }
+        std::cout
+            << "tf1.TransformPoints(...) -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // a normal stays orthogonal to the transformed surface
+        MatrixMath::Transform3f tf2{ MatrixMath::Transform3f::Scaling(2.0f, 1.0f, 1.0f) };
+        float normal[3]{ 1.0f, 1.0f, 0.0f };
+        tf2.TransformNormals(normal, normal, 1);
+        std::cout
+            << "tf2.TransformNormals(...) -> "
+            << (normal[0] == 0.5f && normal[1] == 1.0f && normal[2] == 0.0f ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // rigid * uniform scale, inverted in closed form
+        MatrixMath::Transform3f tf3{ MatrixMath::Transform3f::Translation(1.0f, 2.0f, 3.0f) * tf1
+            * MatrixMath::Transform3f::Scaling(2.0f, 2.0f, 2.0f) };
+        MatrixMath::Transform3f tf4{ tf3.Inverse() * tf3 };
+        succeed = tf3.GetKind() == MatrixMath::TransformKind::UniformScale;
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 4; col++)
+                succeed = succeed && std::abs(tf4.GetElement(row, col) - (row == col ? 1.0f : 0.0f)) < 1e-5f;
+        std::cout
+            << "tf3.Inverse() * tf3 == I -> "
+            << (succeed ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // two quarter turns around z make a half turn
+        MatrixMath::Quaternionf q1{ MatrixMath::Quaternionf::AxisAngle(0.0f, 0.0f, 1.0f, halfPi) };
+        MatrixMath::Quaternionf q2{ q1 * q1 };
+        std::cout
+            << "q2 = " << q2.ToString()
+            << "q1 * q1 -> "
+            << (std::abs(q2.GetZ() - 1.0f) < 1e-6f && std::abs(q2.GetW()) < 1e-6f ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        MatrixMath::Quaternionf q3{ q2.ToMatrix3() };
+        MatrixMath::Quaternionf q4{ MatrixMath::Slerp(MatrixMath::Quaternionf(), q2, 0.5f) };
+        std::cout
+            << "Quaternionf(q2.ToMatrix3()) -> "
+            << (std::abs(std::abs(q3.Dot(q2)) - 1.0f) < 1e-6f ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << "Slerp(I, q2, 0.5) == q1 -> "
+            << (std::abs(q4.Dot(q1) - 1.0f) < 1e-6f ? "[Succeed]" : "[Fail]")
+            << std::endl;
+
+        // orthographic view volume [-1, 1]^3
+        MatrixMath::Frustumf fr1{ MatrixMath::Matrix4f<>{
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        } };
+        float cx[5]{ 0.0f, 1.4f, 1.6f, -3.0f, 0.0f };
+        float cy[5]{ 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        float cz[5]{ 0.0f, 0.0f, 0.0f, 0.0f, -1.2f };
+        float ex[5]{ 0.5f, 0.5f, 0.5f, 0.5f, 0.5f };
+        std::uint32_t visible{ 0 };
+        fr1.CullBoxes(cx, cy, cz, ex, ex, ex, &visible, 5);
+        std::cout
+            << "fr1.CullBoxes(...) -> "
+            << (visible == 0x13u ? "[Succeed]" : "[Fail]")
+            << std::endl
+            << std::endl;
     }
 #endif
 
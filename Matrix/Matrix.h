@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cmath>
 #include <exception>
 #include <initializer_list>
 #include <iomanip>
@@ -11,8 +13,14 @@
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "Format.h"
+#include "Instrument.h"
+#include "Kernel.h"
+#include "Trace.h"
+
 namespace MetaMath
 {
     template <int LHS, int RHS>
@@ -28,9 +36,9 @@ namespace MetaMath
     constexpr static bool IsEven = (Number & 1) == 0;
 
     template <typename _Ty> constexpr static _Ty Zero{ 0 };
-    template <> constexpr static float Zero<float>{ 0.0f };
-    template <> constexpr static double Zero<double>{ 0.0 };
-    template <> constexpr static long long Zero<long long>{ 0LL };
+    template <> constexpr float Zero<float>{ 0.0f };
+    template <> constexpr double Zero<double>{ 0.0 };
+    template <> constexpr long long Zero<long long>{ 0LL };
 }
 
 namespace MetaControl
@@ -44,44 +52,55 @@ namespace MetaControl
 
         using Next = ForLoop_Range_t<_Src, _Dst, _Inc, _Pos + _Inc>;
         using Reset = ForLoop_Range_t<_Src, _Dst, _Inc, _Src>;
+        // the range advanced by `Steps` increments
+        template <int Steps>
+        using At = ForLoop_Range_t<_Src, _Dst, _Inc, _Pos + Steps * _Inc>;
 
         constexpr static bool IsValid{ _Inc > 0 && _Pos < _Dst || _Inc < 0 && _Pos > _Dst };
+        // number of iterations left, from `Pos` (included) to `Dst` (excluded)
+        constexpr static int Count{ IsValid ? (_Dst - _Pos + _Inc + (_Inc > 0 ? -1 : 1)) / _Inc : 0 };
 
         constexpr static int Src{ _Src };
         constexpr static int Dst{ _Dst };
         constexpr static int Pos{ _Pos };
     };
 
+    // Nested compile-time loop: the outer loop walks through `XRange`,
+    // the inner one through `YRange`, and `Function::run<X, Y>` is called
+    // in that order for every pair of positions.
+    // The loops are unrolled by pack expansions over index sequences
+    // rather than by recursion, so that the number of helper instantiations
+    // grows linearly, not quadratically, with the number of iterations
     struct ForLoop_t
     {
+    private:
+        struct NoContext {};
 
-        // Without Context
+        template <typename X, typename YRange, typename Function, typename Context, int... Ys>
+        constexpr static void row(std::integer_sequence<int, Ys...>, Context& context)
+        {
+            if constexpr (std::is_same_v<Context, NoContext>)
+                (Function::template run<X, typename YRange::template At<Ys>>(), ...);
+            else
+                (Function::template run<X, typename YRange::template At<Ys>>(context), ...);
+        }
 
-        template <typename XRange, typename YRange, typename Function>
-        constexpr static void pass1()
+        template <typename XRange, typename YRange, typename Function, typename Context, int... Xs>
+        constexpr static void rows(std::integer_sequence<int, Xs...>, Context& context)
         {
-            if constexpr (XRange::IsValid)
-            {
-                pass2<XRange, YRange, Function>();
-            }
+            (row<typename XRange::template At<Xs>, YRange, Function>(
+                std::make_integer_sequence<int, YRange::Count>{}, context), ...);
         }
 
+    public:
+
+        // Without Context
+
         template <typename XRange, typename YRange, typename Function>
-        constexpr static void pass2()
+        constexpr static void pass1()
         {
-            if constexpr (YRange::IsValid)
-            {
-                // the innermost loop
-                Function::template run<XRange, YRange>();
-
-                pass2<XRange, typename YRange::Next, Function>();
-            }
-            else if constexpr (!YRange::IsValid)
-            {
-                // the nesting loop is over;
-                // restart the outter loop
-                pass1<typename XRange::Next, typename YRange::Reset, Function>();
-            }
+            NoContext context;
+            rows<XRange, YRange, Function>(std::make_integer_sequence<int, XRange::Count>{}, context);
         }
 
         // With Context
@@ -89,28 +108,7 @@ namespace MetaControl
         template <typename XRange, typename YRange, typename Function, typename Context>
         constexpr static void pass1(Context&& context)
         {
-            if constexpr (XRange::IsValid)
-            {
-                pass2<XRange, YRange, Function>(std::move(context));
-            }
-        }
-
-        template <typename XRange, typename YRange, typename Function, typename Context>
-        constexpr static void pass2(Context&& context)
-        {
-            if constexpr (YRange::IsValid)
-            {
-                // the innermost loop
-                Function::template run<XRange, YRange>(context);
-
-                pass2<XRange, typename YRange::Next, Function>(std::move(context));
-            }
-            else if constexpr (!YRange::IsValid)
-            {
-                // the nesting loop is over;
-                // restart the outter loop
-                pass1<typename XRange::Next, typename YRange::Reset, Function>(std::move(context));
-            }
+            rows<XRange, YRange, Function>(std::make_integer_sequence<int, XRange::Count>{}, context);
         }
     };
 }
@@ -194,6 +192,7 @@ namespace MatrixMath
         static_assert(std::is_base_of_v<StorageOrder, _StorageOrder>, "Template argument 'order' is invalid type!");
 
     public:
+        using OrderType = _StorageOrder;
         constexpr static int Width{ _Width };
         constexpr static int Height{ _Height };
 
@@ -204,9 +203,18 @@ namespace MatrixMath
         inline constexpr int GetHeight() const;
     };
 
+    // Partitioned matrix, defined in "BlockMatrix.h"
+    template <typename _Ty, int BlockHeight, int BlockWidth, int BlockRows, int BlockColumns,
+        typename order = StorageOrder::RowMajor>
+    class BlockMatrix;
+
     template <typename _Ty, int Height, int Width, typename order>
     class ProtoMatrixData
     {
+        // block matrices share the data containers of their blocks
+        template <typename, int, int, int, int, typename>
+        friend class BlockMatrix;
+
     public:
         using data_t = std::array<_Ty, Width * Height>;
         using data_ptr_t = std::shared_ptr<data_t>;
@@ -228,12 +236,18 @@ namespace MatrixMath
 
         inline const data_ptr_t& GetDataPointer() const;
         inline data_ptr_t& GetDataPointer();
+        inline void SetTransposed(const bool isTransposed);
 
     public:
         bool IsTransposed() const;
         inline const data_t& GetData() const;
         inline data_t& GetData();
 
+        // Rearrange the buffer physically so that the matrix is no longer
+        // marked as transposed; the buffer is copied first if it is shared
+        // with other matrices, otherwise square buffers are transposed in place
+        void Materialize();
+
         static inline std::pair<int, int> index2pair(const int index, const bool isTransposed);
 
 #ifdef _DEBUG
@@ -272,6 +286,10 @@ namespace MatrixMath
         [[nodiscard]]
         Transposed Transpose() const;
 
+        // Transpose a square matrix physically, without allocating
+        // unless the buffer is shared with other matrices
+        void TransposeInPlace();
+
         // Always output a string representing the matrix in row-major order
         const std::string ToString() const;
 
@@ -286,6 +304,48 @@ namespace MatrixMath
 
         template <int _Row, int _Column>
         Cofactor<_Row, _Column> GetCofactor();
+
+        // Fixed-size block whose position is decided at run time,
+        // e.g. while walking the tiles of the matrix in a loop
+        template <int BlockHeight, int BlockWidth>
+        class Block;
+
+        template <int BlockHeight, int BlockWidth>
+        Block<BlockHeight, BlockWidth> GetBlock(const int row, const int column);
+    };
+
+    // Packed tile
+    // A contiguous, row-major and cache-line aligned copy of a block,
+    // suitable to be used as scratch memory by blocked algorithms
+
+    template <typename _Ty, int _Height, int _Width>
+    struct alignas(64) PackedTile
+    {
+        using ElementType = _Ty;
+        constexpr static int Height{ _Height };
+        constexpr static int Width{ _Width };
+
+        std::array<_Ty, _Height * _Width> data;
+
+        inline const _Ty& GetElement(const int row, const int column) const
+        {
+            return data[column + row * _Width];
+        }
+
+        inline _Ty& GetElement(const int row, const int column)
+        {
+            return data[column + row * _Width];
+        }
+
+        inline const _Ty* GetRow(const int row) const
+        {
+            return data.data() + row * _Width;
+        }
+
+        inline _Ty* GetRow(const int row)
+        {
+            return data.data() + row * _Width;
+        }
     };
 
     // Vector
@@ -308,26 +368,119 @@ namespace MatrixMath
         IdentityMatrix();
     };
 
-    // Conduct template instantiation of IdentityMatrix
-#ifdef MakeIdentityMatrix
-#   error "Failed to conduct template instantiation of IdentityMatrix!"
-#else
-#   define MakeIdentityMatrix(_Ty, N, initializer) template <typename order> \
-    class IdentityMatrix<_Ty, N, order> : public Matrix<_Ty, N, N, order> \
-    { public: IdentityMatrix() : Matrix<_Ty, N, N, order>initializer {} }
-
-    MakeIdentityMatrix(int, 2, ({ 1,0,0,1 }));
-    MakeIdentityMatrix(int, 3, ({ 1,0,0,0,1,0,0,0,1 }));
-    MakeIdentityMatrix(int, 4, ({ 1,0,0,0,0,1,0,0,0,0,1,0,0,0,0,1 }));
-    MakeIdentityMatrix(float, 2, ({ 1.0f,0.0f,0.0f,1.0f }));
-    MakeIdentityMatrix(float, 3, ({ 1.0f,0.0f,0.0f,0.0f,1.0f,0.0f,0.0f,0.0f,1.0f }));
-    MakeIdentityMatrix(float, 4, ({ 1.0f,0.0f,0.0f,0.0f,0.0f,1.0f,0.0f,0.0f,0.0f,0.0f,1.0f,0.0f,0.0f,0.0f,0.0f,1.0f }));
-    MakeIdentityMatrix(double, 2, ({ 1.0,0.0,0.0,1.0 }));
-    MakeIdentityMatrix(double, 3, ({ 1.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,1.0 }));
-    MakeIdentityMatrix(double, 4, ({ 1.0,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0,1.0 }));
-
-#   undef MakeIdentityMatrix
-#endif
+    // Implicit matrices
+    // The following matrices are never stored entry by entry;
+    // multiplying a matrix by them reduces to a copy,
+    // a scaling of rows or columns, or a gather of rows or columns
+
+    // Identity without any storage
+    template <typename _Ty, int N>
+    class Identity
+    {
+    public:
+        using ElementType = _Ty;
+        constexpr static int Width{ N };
+        constexpr static int Height{ N };
+
+        inline _Ty GetElement(const int row, const int column) const;
+
+        const std::string ToString() const;
+    };
+
+    // Diagonal matrix storing nothing but the N entries of its diagonal
+    template <typename _Ty, int N>
+    class Diagonal
+    {
+    public:
+        using ElementType = _Ty;
+        constexpr static int Width{ N };
+        constexpr static int Height{ N };
+
+    private:
+        std::array<_Ty, N> data;
+
+    public:
+        Diagonal();
+        Diagonal(const std::initializer_list<_Ty>& init);
+
+        inline const std::array<_Ty, N>& GetData() const;
+        inline std::array<_Ty, N>& GetData();
+        inline _Ty GetElement(const int row, const int column) const;
+
+        const std::string ToString() const;
+    };
+
+    // Permutation matrix storing nothing but an index vector:
+    // the entry (row, indices[row]) is one, all the others are zero,
+    // thus row `row` of (P * M) is row `indices[row]` of M
+    template <int N>
+    class Permutation
+    {
+    public:
+        using ElementType = int;
+        constexpr static int Width{ N };
+        constexpr static int Height{ N };
+
+    private:
+        std::array<int, N> indices;
+        // whether an odd number of transpositions makes up the permutation
+        bool isOdd;
+
+        template <int M>
+        friend Permutation<M> operator*(const Permutation<M>&, const Permutation<M>&);
+
+    public:
+        Permutation();
+        // `init` lists indices[0..N-1], each of 0..N-1 exactly once (asserted);
+        // anything else gives the identity
+        Permutation(const std::initializer_list<int>& init);
+
+        inline const std::array<int, N>& GetIndices() const;
+        inline int operator[](const int row) const;
+        inline int GetElement(const int row, const int column) const;
+
+        // Exchange two rows of the permutation matrix
+        inline void Swap(const int lhs, const int rhs);
+        // (-1) to the power of the number of transpositions
+        inline int Sign() const;
+
+        [[nodiscard]]
+        Permutation Inverse() const;
+
+        const std::string ToString() const;
+    };
+
+    template <typename _Ty, int N, int Width, typename order>
+    Matrix<_Ty, N, Width, order> operator*(const Identity<_Ty, N>&, const Matrix<_Ty, N, Width, order>&);
+
+    template <typename _Ty, int Height, int N, typename order>
+    Matrix<_Ty, Height, N, order> operator*(const Matrix<_Ty, Height, N, order>&, const Identity<_Ty, N>&);
+
+    template <typename _Ty, int N>
+    Identity<_Ty, N> operator*(const Identity<_Ty, N>&, const Identity<_Ty, N>&);
+
+    // scale the rows of the matrix
+    template <typename _Ty, int N, int Width, typename order>
+    Matrix<_Ty, N, Width, order> operator*(const Diagonal<_Ty, N>&, const Matrix<_Ty, N, Width, order>&);
+
+    // scale the columns of the matrix
+    template <typename _Ty, int Height, int N, typename order>
+    Matrix<_Ty, Height, N, order> operator*(const Matrix<_Ty, Height, N, order>&, const Diagonal<_Ty, N>&);
+
+    template <typename _Ty, int N>
+    Diagonal<_Ty, N> operator*(const Diagonal<_Ty, N>&, const Diagonal<_Ty, N>&);
+
+    // gather the rows of the matrix
+    template <typename _Ty, int N, int Width, typename order>
+    Matrix<_Ty, N, Width, order> operator*(const Permutation<N>&, const Matrix<_Ty, N, Width, order>&);
+
+    // gather the columns of the matrix
+    template <typename _Ty, int Height, int N, typename order>
+    Matrix<_Ty, Height, N, order> operator*(const Matrix<_Ty, Height, N, order>&, const Permutation<N>&);
+
+    template <int N>
+    Permutation<N> operator*(const Permutation<N>&, const Permutation<N>&);
+
 
     // Alias
 
@@ -473,6 +626,13 @@ namespace MatrixMath
         std::enable_if_t<MatrixType::Width == MatrixType::Height, int> = 0>
     class Determinant;
 
+    // LU decomposition with partial pivoting: P * A = L * U,
+    // the row exchanges are recorded by the permutation P
+    // instead of being performed on the rows of the matrix
+    template <typename MatrixType,
+        std::enable_if_t<MatrixType::Width == MatrixType::Height, int> = 0>
+    class LUDecomposition;
+
     template <int _Row, int _Column, typename MatrixType,
         std::enable_if_t<MatrixType::Width == MatrixType::Height, int> = 0>
     typename MatrixType::ElementType AlgebraicCofactor(const MatrixType& square);
@@ -485,6 +645,12 @@ namespace MatrixMath
         std::enable_if_t<MatrixType::Width == MatrixType::Height, int> = 0>
     bool IsInvertible(const MatrixType& matrix);
 
+    // Adjoint matrix divided by the determinant;
+    // meaningful only if the element type is a field, e.g. float or double
+    template <typename MatrixType,
+        std::enable_if_t<MatrixType::Width == MatrixType::Height, int> = 0>
+    MatrixType Inverse(const MatrixType& matrix);
+
     // Utilities
 
     template <typename MatrixType>
@@ -514,8 +680,61 @@ namespace MatrixMath
         COL_MEG = 6u,
     };
 
+    // Vector algorithms
+
+    // Accuracy of the reciprocal square roots used by normalization:
+    // `Fast` refines the hardware estimate by Newton-Raphson steps,
+    // which leaves a relative error of about 1e-7 for float
+    enum class Precision : unsigned char
+    {
+        Exact,
+        Fast,
+    };
+
+    // Batched variants over `count` vectors of N entries, stored either
+    // one after another (AoS, `_Ty[count][N]`) or as N arrays of `count` entries,
+    // one per component (SoA); outputs may alias the inputs
+
+    template <int N, typename _Ty>
+    void BatchDot(const _Ty* lhs, const _Ty* rhs, _Ty* out, const std::size_t count);
+
+    template <int N, typename _Ty>
+    void BatchDot(const _Ty* const (&lhs)[N], const _Ty* const (&rhs)[N], _Ty* out, const std::size_t count);
+
+    template <int N, typename _Ty>
+    void BatchSquaredNorm(const _Ty* in, _Ty* out, const std::size_t count);
+
+    template <int N, typename _Ty>
+    void BatchSquaredNorm(const _Ty* const (&in)[N], _Ty* out, const std::size_t count);
+
+    template <int N, typename _Ty>
+    void BatchNorm(const _Ty* in, _Ty* out, const std::size_t count);
+
+    template <int N, typename _Ty>
+    void BatchNorm(const _Ty* const (&in)[N], _Ty* out, const std::size_t count);
+
+    // None of the vectors may be zero
+    template <int N, Precision precision = Precision::Exact, typename _Ty>
+    void BatchNormalize(const _Ty* in, _Ty* out, const std::size_t count);
+
+    template <int N, Precision precision = Precision::Exact, typename _Ty>
+    void BatchNormalize(const _Ty* const (&in)[N], _Ty* const (&out)[N], const std::size_t count);
+
+    template <typename _Ty>
+    void BatchCross(const _Ty* lhs, const _Ty* rhs, _Ty* out, const std::size_t count);
+
+    template <typename _Ty>
+    void BatchCross(const _Ty* const (&lhs)[3], const _Ty* const (&rhs)[3], _Ty* const (&out)[3], const std::size_t count);
+
 } /* NAMESPACE: MatrixMath */
 
+namespace detail
+{
+    template <typename DstOrder, int DstHeight, int DstWidth, typename MatrixType>
+    void CopyMatrixInto(const MatrixType& src, typename MatrixType::ElementType* dst,
+        const int row, const int column);
+}
+
 
 template <typename _Ty, int Height, int Width, typename order>
 inline constexpr bool
@@ -563,6 +782,7 @@ ProtoMatrixData()                                   // default ctor
     : pData{ std::make_unique<std::array<_Ty, Width * Height>>() } // initialize std::array pointer with nullptr
     , isTransposed{ false }
 {
+    detail::Instrument<_Ty, Height, Width, order>(MatrixEvent::Allocate, sizeof(data_t));
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -572,6 +792,7 @@ ProtoMatrixData(const ProtoMatrixData& other)       // copy ctor
 {
     std::copy(other.pData->begin(), other.pData->end(), this->pData->begin());
     this->isTransposed = other.isTransposed;
+    detail::Instrument<_Ty, Height, Width, order>(MatrixEvent::Copy);
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -581,6 +802,7 @@ ProtoMatrixData(ProtoMatrixData&& other)            // move ctor
     , isTransposed{ other.isTransposed }
 {
     other.pData = nullptr;
+    detail::Instrument<_Ty, Height, Width, order>(MatrixEvent::Move);
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -602,19 +824,14 @@ ProtoMatrixData(const data_ptr_t& pData, bool isTransposed)
     : pData{ pData }
     , isTransposed{ isTransposed }
 {
+    detail::Instrument<_Ty, Height, Width, order>(MatrixEvent::Alias);
 }
 
 template <typename _Ty, int Height, int Width, typename order>
 MatrixMath::ProtoMatrixData<_Ty, Height, Width, order>::
 ~ProtoMatrixData()
 {
-#ifdef _DEBUG
-    std::cout
-        << "Deleting ProtoMatrixData{name: "
-        << this->name
-        << "} ..."
-        << std::endl;
-#endif
+    detail::Instrument<_Ty, Height, Width, order>(MatrixEvent::Destroy);
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -635,6 +852,14 @@ GetDataPointer()
     return this->pData;
 }
 
+template <typename _Ty, int Height, int Width, typename order>
+inline void
+MatrixMath::ProtoMatrixData<_Ty, Height, Width, order>::
+SetTransposed(const bool isTransposed)
+{
+    this->isTransposed = isTransposed;
+}
+
 template <typename _Ty, int Height, int Width, typename order>
 bool
 MatrixMath::ProtoMatrixData<_Ty, Height, Width, order>::
@@ -643,6 +868,37 @@ IsTransposed() const
     return this->isTransposed;
 }
 
+template <typename _Ty, int Height, int Width, typename order>
+void
+MatrixMath::ProtoMatrixData<_Ty, Height, Width, order>::
+Materialize()
+{
+    if (!this->isTransposed)
+        return;
+
+    // a single row or column is laid out the same way in both orders
+    if constexpr (Height > 1 && Width > 1)
+    {
+        // the shape of the buffer as it is stored, row by row
+        constexpr int Rows{ order::IsRowMajor() ? Width : Height };
+        constexpr int Columns{ order::IsRowMajor() ? Height : Width };
+
+        if (Rows == Columns && this->pData.use_count() == 1)
+        {
+            detail::TransposeSquareInPlace(this->pData->data(), Columns, Rows);
+        }
+        else
+        {
+            data_ptr_t pFresh{ std::make_shared<data_t>() };
+            detail::Instrument<_Ty, Height, Width, order>(MatrixEvent::Allocate, sizeof(data_t));
+            detail::TransposeBlock(this->pData->data(), Columns, pFresh->data(), Rows, Rows, Columns);
+            this->pData = pFresh;
+        }
+    }
+
+    this->isTransposed = false;
+}
+
 template <typename _Ty, int Height, int Width, typename order>
 inline
 const std::array<_Ty, Width * Height>&
@@ -790,6 +1046,18 @@ Transpose() const
     return Transposed{ this->GetDataPointer(), !this->IsTransposed() };
 }
 
+template <typename _Ty, int Height, int Width, typename order>
+void
+MatrixMath::Matrix<_Ty, Height, Width, order>::
+TransposeInPlace()
+{
+    static_assert(Height == Width, "Only square matrices can be transposed in place!");
+    // flipping the flag alone changes the logical content,
+    // materializing it moves the entries to where they belong
+    this->SetTransposed(!this->IsTransposed());
+    this->Materialize();
+}
+
 template <typename _Ty, int Height, int Width, typename order>
 const std::string
 MatrixMath::Matrix<_Ty, Height, Width, order>::
@@ -1037,13 +1305,562 @@ GetCofactor()
 }
 
 
+template <typename _Ty, int Height, int Width, typename order>
+template <int BlockHeight, int BlockWidth>
+class MatrixMath::Matrix<_Ty, Height, Width, order>::Block
+    : public ProtoMatrix<_Ty, BlockHeight, BlockWidth, order>
+    , public IMatrix<_Ty>
+{
+    static_assert(BlockHeight <= Height, "Invalid template argument: BlockHeight > Height!");
+    static_assert(BlockWidth <= Width, "Invalid template argument: BlockWidth > Width!");
+
+public:
+    using ParentType = Matrix<_Ty, Height, Width, order>;
+    using TileType = PackedTile<_Ty, BlockHeight, BlockWidth>;
+
+private:
+    ParentType& parent;
+    int row;
+    int column;
+
+    // the address of the entry (0, 0) of the block in the buffer of the parent;
+    // the strides are resolved with it so that accessing an entry of the block
+    // neither calls `convert2index` nor the virtual functions of the parent.
+    // `Materialize` may reallocate or re-lay out the buffer of the parent,
+    // so they are resolved again whenever its buffer or transposition changes
+    mutable const _Ty* buffer;
+    mutable bool isTransposed;
+    mutable _Ty* origin;
+    mutable int rowStride;
+    mutable int columnStride;
+
+    inline void resolve() const
+    {
+        _Ty* const data{ parent.GetData().data() };
+        const bool transposed{ parent.IsTransposed() };
+        if (data == buffer && transposed == isTransposed)
+            return;
+
+        buffer = data;
+        isTransposed = transposed;
+        origin = data + ParentType::convert2index(row, column, transposed);
+        rowStride = ParentType::convert2index(1, 0, transposed)
+            - ParentType::convert2index(0, 0, transposed);
+        columnStride = ParentType::convert2index(0, 1, transposed)
+            - ParentType::convert2index(0, 0, transposed);
+    }
+
+    inline int convert2index(const int y, const int x) const
+    {
+        return y * rowStride + x * columnStride;
+    }
+
+    inline int convert2index(const int index) const
+    {
+        using prototype = ProtoMatrixData<_Ty, BlockHeight, BlockWidth, order>;
+        auto [y, x] = prototype::index2pair(index, false);
+        return convert2index(y, x);
+    }
+
+public:
+    Block(ParentType& parent, const int row, const int column)
+        : parent{ parent }
+        , row{ row }
+        , column{ column }
+        , buffer{ nullptr }
+        , isTransposed{ false }
+        , origin{ nullptr }
+        , rowStride{ 0 }
+        , columnStride{ 0 }
+    {
+        assert(row >= 0 && row + BlockHeight <= Height);
+        assert(column >= 0 && column + BlockWidth <= Width);
+        this->resolve();
+    }
+
+    const ParentType& GetParent() const
+    {
+        return parent;
+    }
+
+    ParentType& GetParent()
+    {
+        return parent;
+    }
+
+    inline bool IsTransposed() const
+    {
+        return parent.IsTransposed();
+    }
+
+    // the absolute coordinate of the entry (0, 0) of the block in the parent matrix
+    inline int GetRowOffset() const
+    {
+        return row;
+    }
+
+    inline int GetColumnOffset() const
+    {
+        return column;
+    }
+
+    // Access data
+
+    inline void SetElement(const int index, const _Ty& value)
+    {
+        this->resolve();
+        origin[this->convert2index(index)] = value;
+    }
+
+    inline const _Ty& GetElement(const int index) const
+    {
+        this->resolve();
+        return origin[this->convert2index(index)];
+    }
+
+    inline void SetElement(const int y, const int x, const _Ty& value)
+    {
+        this->resolve();
+        origin[this->convert2index(y, x)] = value;
+    }
+
+    inline const _Ty& GetElement(const int y, const int x) const
+    {
+        this->resolve();
+        return origin[this->convert2index(y, x)];
+    }
+
+    inline _Ty& GetElement(const int index)
+    {
+        this->resolve();
+        return origin[this->convert2index(index)];
+    }
+
+    inline _Ty& GetElement(const int y, const int x)
+    {
+        this->resolve();
+        return origin[this->convert2index(y, x)];
+    }
+
+    // Copy the entries of the block into contiguous memory in row-major order;
+    // `destination` must be able to hold `BlockHeight * BlockWidth` entries
+    void Pack(_Ty* destination) const
+    {
+        this->resolve();
+        if (columnStride == 1)
+        {
+            // every row of the block is contiguous in the parent
+            for (int y = 0; y < BlockHeight; y++)
+            {
+                const _Ty* src{ origin + y * rowStride };
+                std::copy(src, src + BlockWidth, destination + y * BlockWidth);
+            }
+        }
+        else
+        {
+            // every column of the block is contiguous in the parent;
+            // read the parent sequentially and scatter into the tile
+            for (int x = 0; x < BlockWidth; x++)
+            {
+                const _Ty* src{ origin + x * columnStride };
+                for (int y = 0; y < BlockHeight; y++)
+                    destination[x + y * BlockWidth] = src[y * rowStride];
+            }
+        }
+    }
+
+    void Pack(TileType& tile) const
+    {
+        this->Pack(tile.data.data());
+    }
+
+    [[nodiscard]]
+    TileType Pack() const
+    {
+        TileType tile;
+        this->Pack(tile);
+        return tile;
+    }
+
+    // Write the entries of a packed tile back into the block
+    void Unpack(const _Ty* source)
+    {
+        this->resolve();
+        if (columnStride == 1)
+        {
+            for (int y = 0; y < BlockHeight; y++)
+            {
+                const _Ty* src{ source + y * BlockWidth };
+                std::copy(src, src + BlockWidth, origin + y * rowStride);
+            }
+        }
+        else
+        {
+            for (int x = 0; x < BlockWidth; x++)
+            {
+                _Ty* dst{ origin + x * columnStride };
+                for (int y = 0; y < BlockHeight; y++)
+                    dst[y * rowStride] = source[x + y * BlockWidth];
+            }
+        }
+    }
+
+    void Unpack(const TileType& tile)
+    {
+        this->Unpack(tile.data.data());
+    }
+
+    const std::string ToString() const
+    {
+        return MatrixMath::ToString(*this);
+    }
+};
+
+template <typename _Ty, int Height, int Width, typename order>
+template <int BlockHeight, int BlockWidth>
+MatrixMath::Matrix<_Ty, Height, Width, order>::Block<BlockHeight, BlockWidth>
+MatrixMath::Matrix<_Ty, Height, Width, order>::
+GetBlock(const int row, const int column)
+{
+    return Block<BlockHeight, BlockWidth>(*this, row, column);
+}
+
+
 template <typename _Ty, int N, typename order>
 MatrixMath::IdentityMatrix<_Ty, N, order>::
 IdentityMatrix()
     : MatrixQ<_Ty, N, order>()
+{
+    // the diagonal is at the same place in both storage orders
+    auto& data{ this->GetData() };
+    for (int i = 0; i < N; i++)
+        data[i * (N + 1)] = static_cast<_Ty>(1);
+}
+
+template <typename _Ty, int N>
+inline _Ty
+MatrixMath::Identity<_Ty, N>::
+GetElement(const int row, const int column) const
+{
+    return static_cast<_Ty>(row == column ? 1 : 0);
+}
+
+template <typename _Ty, int N>
+const std::string
+MatrixMath::Identity<_Ty, N>::
+ToString() const
+{
+    return MatrixMath::ToString(*this);
+}
+
+template <typename _Ty, int N>
+MatrixMath::Diagonal<_Ty, N>::
+Diagonal()
+    : data{}
+{
+}
+
+template <typename _Ty, int N>
+MatrixMath::Diagonal<_Ty, N>::
+Diagonal(const std::initializer_list<_Ty>& init)
+    : data{}
+{
+    const _Ty* src{ init.begin() };
+    const _Ty* end{ src + std::min<ptrdiff_t>(init.size(), N) };
+    std::copy(src, end, this->data.begin());
+}
+
+template <typename _Ty, int N>
+inline const std::array<_Ty, N>&
+MatrixMath::Diagonal<_Ty, N>::
+GetData() const
+{
+    return this->data;
+}
+
+template <typename _Ty, int N>
+inline std::array<_Ty, N>&
+MatrixMath::Diagonal<_Ty, N>::
+GetData()
+{
+    return this->data;
+}
+
+template <typename _Ty, int N>
+inline _Ty
+MatrixMath::Diagonal<_Ty, N>::
+GetElement(const int row, const int column) const
+{
+    return row == column ? this->data[row] : static_cast<_Ty>(0);
+}
+
+template <typename _Ty, int N>
+const std::string
+MatrixMath::Diagonal<_Ty, N>::
+ToString() const
+{
+    return MatrixMath::ToString(*this);
+}
+
+template <int N>
+MatrixMath::Permutation<N>::
+Permutation()
+    : isOdd{ false }
 {
     for (int i = 0; i < N; i++)
-        this->SetElement(i, i, 1);
+        this->indices[i] = i;
+}
+
+template <int N>
+MatrixMath::Permutation<N>::
+Permutation(const std::initializer_list<int>& init)
+    : Permutation()
+{
+    // every index of 0..N-1 exactly once, otherwise the identity is kept
+    std::array<bool, N> visited{};
+    bool isPermutation{ init.size() == static_cast<std::size_t>(N) };
+    for (const int index : init)
+    {
+        if (!isPermutation || index < 0 || index >= N || visited[index])
+        {
+            isPermutation = false;
+            break;
+        }
+        visited[index] = true;
+    }
+    assert(isPermutation && "Not a permutation of 0..N-1!");
+    if (!isPermutation)
+        return;
+    std::copy(init.begin(), init.end(), this->indices.begin());
+
+    // the parity of a permutation is the parity of (N - number of cycles)
+    visited.fill(false);
+    int cycles{ 0 };
+    for (int i = 0; i < N; i++)
+    {
+        if (visited[i])
+            continue;
+        ++cycles;
+        for (int j = i; !visited[j]; j = this->indices[j])
+            visited[j] = true;
+    }
+    this->isOdd = ((N - cycles) & 1) == 1;
+}
+
+template <int N>
+inline const std::array<int, N>&
+MatrixMath::Permutation<N>::
+GetIndices() const
+{
+    return this->indices;
+}
+
+template <int N>
+inline int
+MatrixMath::Permutation<N>::
+operator[](const int row) const
+{
+    return this->indices[row];
+}
+
+template <int N>
+inline int
+MatrixMath::Permutation<N>::
+GetElement(const int row, const int column) const
+{
+    return this->indices[row] == column ? 1 : 0;
+}
+
+template <int N>
+inline void
+MatrixMath::Permutation<N>::
+Swap(const int lhs, const int rhs)
+{
+    if (lhs == rhs)
+        return;
+    std::swap(this->indices[lhs], this->indices[rhs]);
+    this->isOdd = !this->isOdd;
+}
+
+template <int N>
+inline int
+MatrixMath::Permutation<N>::
+Sign() const
+{
+    return this->isOdd ? -1 : 1;
+}
+
+template <int N>
+MatrixMath::Permutation<N>
+MatrixMath::Permutation<N>::
+Inverse() const
+{
+    Permutation result;
+    for (int i = 0; i < N; i++)
+        result.indices[this->indices[i]] = i;
+    result.isOdd = this->isOdd;
+    return result;
+}
+
+template <int N>
+const std::string
+MatrixMath::Permutation<N>::
+ToString() const
+{
+    return MatrixMath::ToString(*this);
+}
+
+template <typename _Ty, int N, int Width, typename order>
+MatrixMath::Matrix<_Ty, N, Width, order>
+MatrixMath::
+operator*(const Identity<_Ty, N>&, const Matrix<_Ty, N, Width, order>& rhs)
+{
+    return rhs;
+}
+
+template <typename _Ty, int Height, int N, typename order>
+MatrixMath::Matrix<_Ty, Height, N, order>
+MatrixMath::
+operator*(const Matrix<_Ty, Height, N, order>& lhs, const Identity<_Ty, N>&)
+{
+    return lhs;
+}
+
+template <typename _Ty, int N>
+MatrixMath::Identity<_Ty, N>
+MatrixMath::
+operator*(const Identity<_Ty, N>& lhs, const Identity<_Ty, N>&)
+{
+    return lhs;
+}
+
+template <typename _Ty, int N, int Width, typename order>
+MatrixMath::Matrix<_Ty, N, Width, order>
+MatrixMath::
+operator*(const Diagonal<_Ty, N>& lhs, const Matrix<_Ty, N, Width, order>& rhs)
+{
+    Matrix<_Ty, N, Width, order> result;
+    auto& data{ result.GetData() };
+    const auto& diagonal{ lhs.GetData() };
+    detail::CopyMatrixInto<order, N, Width>(rhs, data.data(), 0, 0);
+
+    if constexpr (order::IsRowMajor())
+    {
+        for (int row = 0; row < N; row++)
+            for (int col = 0; col < Width; col++)
+                data[col + row * Width] *= diagonal[row];
+    }
+    else
+    {
+        for (int col = 0; col < Width; col++)
+            for (int row = 0; row < N; row++)
+                data[row + col * N] *= diagonal[row];
+    }
+    return result;
+}
+
+template <typename _Ty, int Height, int N, typename order>
+MatrixMath::Matrix<_Ty, Height, N, order>
+MatrixMath::
+operator*(const Matrix<_Ty, Height, N, order>& lhs, const Diagonal<_Ty, N>& rhs)
+{
+    Matrix<_Ty, Height, N, order> result;
+    auto& data{ result.GetData() };
+    const auto& diagonal{ rhs.GetData() };
+    detail::CopyMatrixInto<order, Height, N>(lhs, data.data(), 0, 0);
+
+    if constexpr (order::IsRowMajor())
+    {
+        for (int row = 0; row < Height; row++)
+            for (int col = 0; col < N; col++)
+                data[col + row * N] *= diagonal[col];
+    }
+    else
+    {
+        for (int col = 0; col < N; col++)
+            for (int row = 0; row < Height; row++)
+                data[row + col * Height] *= diagonal[col];
+    }
+    return result;
+}
+
+template <typename _Ty, int N>
+MatrixMath::Diagonal<_Ty, N>
+MatrixMath::
+operator*(const Diagonal<_Ty, N>& lhs, const Diagonal<_Ty, N>& rhs)
+{
+    Diagonal<_Ty, N> result;
+    for (int i = 0; i < N; i++)
+        result.GetData()[i] = lhs.GetData()[i] * rhs.GetData()[i];
+    return result;
+}
+
+template <typename _Ty, int N, int Width, typename order>
+MatrixMath::Matrix<_Ty, N, Width, order>
+MatrixMath::
+operator*(const Permutation<N>& lhs, const Matrix<_Ty, N, Width, order>& rhs)
+{
+    Matrix<_Ty, N, Width, order> result;
+    auto& data{ result.GetData() };
+
+    if (order::IsRowMajor() && !rhs.IsTransposed())
+    {
+        // the rows are contiguous in both buffers
+        const auto& src{ rhs.GetData() };
+        for (int row = 0; row < N; row++)
+        {
+            const auto from{ src.begin() + lhs[row] * Width };
+            std::copy(from, from + Width, data.begin() + row * Width);
+        }
+    }
+    else
+    {
+        for (int row = 0; row < N; row++)
+            for (int col = 0; col < Width; col++)
+                data[order::convert2index(N, Width, row, col, false)] = rhs.GetElement(lhs[row], col);
+    }
+    return result;
+}
+
+template <typename _Ty, int Height, int N, typename order>
+MatrixMath::Matrix<_Ty, Height, N, order>
+MatrixMath::
+operator*(const Matrix<_Ty, Height, N, order>& lhs, const Permutation<N>& rhs)
+{
+    // column `rhs[col]` of the result is column `col` of the matrix
+    Matrix<_Ty, Height, N, order> result;
+    auto& data{ result.GetData() };
+
+    if (order::IsColumnMajor() && !lhs.IsTransposed())
+    {
+        // the columns are contiguous in both buffers
+        const auto& src{ lhs.GetData() };
+        for (int col = 0; col < N; col++)
+        {
+            const auto from{ src.begin() + col * Height };
+            std::copy(from, from + Height, data.begin() + rhs[col] * Height);
+        }
+    }
+    else
+    {
+        for (int row = 0; row < Height; row++)
+            for (int col = 0; col < N; col++)
+                data[order::convert2index(Height, N, row, rhs[col], false)] = lhs.GetElement(row, col);
+    }
+    return result;
+}
+
+template <int N>
+MatrixMath::Permutation<N>
+MatrixMath::
+operator*(const Permutation<N>& lhs, const Permutation<N>& rhs)
+{
+    // row `row` of (lhs * rhs) is row `lhs[row]` of rhs
+    Permutation<N> result;
+    for (int row = 0; row < N; row++)
+        result.indices[row] = rhs[lhs[row]];
+    result.isOdd = lhs.isOdd != rhs.isOdd;
+    return result;
 }
 
 
@@ -1052,8 +1869,22 @@ void
 MatrixMath::
 operator+=(Matrix<_Ty, Height, Width, order>& lhs, const Matrix<_Ty, Height, Width, order>& rhs)
 {
-    for (int i{ 0 }; i < Width * Height; i++)
-        lhs.GetElement(i) += rhs.GetElement(i);
+    MATRIX_TRACE_SCOPE("operator+=", Height * Width, 3 * Height * Width * sizeof(_Ty));
+    if (lhs.IsTransposed() == rhs.IsTransposed())
+    {
+        if constexpr (std::is_floating_point_v<_Ty> && Width * Height >= detail::MinDispatchedEntries)
+            detail::AddEntries(lhs.GetData().data(), rhs.GetData().data(), Width * Height);
+        else
+            for (int i{ 0 }; i < Width * Height; i++)
+                lhs.GetElement(i) += rhs.GetElement(i);
+    }
+    else
+    {
+        // the buffers are laid out differently
+        for (int row{ 0 }; row < Height; row++)
+            for (int col{ 0 }; col < Width; col++)
+                lhs.GetElement(row, col) += rhs.GetElement(row, col);
+    }
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -1061,8 +1892,22 @@ void
 MatrixMath::
 operator-=(Matrix<_Ty, Height, Width, order>& lhs, const Matrix<_Ty, Height, Width, order>& rhs)
 {
-    for (int i{ 0 }; i < Width * Height; i++)
-        lhs.GetElement(i) -= rhs.GetElement(i);
+    MATRIX_TRACE_SCOPE("operator-=", Height * Width, 3 * Height * Width * sizeof(_Ty));
+    if (lhs.IsTransposed() == rhs.IsTransposed())
+    {
+        if constexpr (std::is_floating_point_v<_Ty> && Width * Height >= detail::MinDispatchedEntries)
+            detail::SubtractEntries(lhs.GetData().data(), rhs.GetData().data(), Width * Height);
+        else
+            for (int i{ 0 }; i < Width * Height; i++)
+                lhs.GetElement(i) -= rhs.GetElement(i);
+    }
+    else
+    {
+        // the buffers are laid out differently
+        for (int row{ 0 }; row < Height; row++)
+            for (int col{ 0 }; col < Width; col++)
+                lhs.GetElement(row, col) -= rhs.GetElement(row, col);
+    }
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -1070,8 +1915,12 @@ void
 MatrixMath::
 operator*=(Matrix<_Ty, Height, Width, order>& lhs, const _Ty& rhs)
 {
-    for (int i{ 0 }; i < Width * Height; i++)
-        lhs.GetElement(i) *= rhs;
+    MATRIX_TRACE_SCOPE("operator*=", Height * Width, 2 * Height * Width * sizeof(_Ty));
+    if constexpr (std::is_floating_point_v<_Ty> && Width * Height >= detail::MinDispatchedEntries)
+        detail::MultiplyEntries(lhs.GetData().data(), rhs, Width * Height);
+    else
+        for (int i{ 0 }; i < Width * Height; i++)
+            lhs.GetElement(i) *= rhs;
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -1079,8 +1928,12 @@ void
 MatrixMath::
 operator/=(Matrix<_Ty, Height, Width, order>& lhs, const _Ty& rhs)
 {
-    for (int i{ 0 }; i < Width * Height; i++)
-        lhs.GetElement(i) /= rhs;
+    MATRIX_TRACE_SCOPE("operator/=", Height * Width, 2 * Height * Width * sizeof(_Ty));
+    if constexpr (std::is_floating_point_v<_Ty> && Width * Height >= detail::MinDispatchedEntries)
+        detail::DivideEntries(lhs.GetData().data(), rhs, Width * Height);
+    else
+        for (int i{ 0 }; i < Width * Height; i++)
+            lhs.GetElement(i) /= rhs;
 }
 
 template <typename _Ty, int Height, int Width, typename order>
@@ -1088,6 +1941,7 @@ MatrixMath::Matrix<_Ty, Height, Width, order>
 MatrixMath::
 operator+(const Matrix<_Ty, Height, Width, order>& lhs, const Matrix<_Ty, Height, Width, order>& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator+", Height * Width, 3 * Height * Width * sizeof(_Ty));
     Matrix result(lhs);
     result += rhs;
     return result;
@@ -1098,6 +1952,7 @@ MatrixMath::Matrix<_Ty, Height, Width, order>
 MatrixMath::
 operator-(const Matrix<_Ty, Height, Width, order>& lhs, const Matrix<_Ty, Height, Width, order>& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator-", Height * Width, 3 * Height * Width * sizeof(_Ty));
     Matrix result(lhs);
     result -= rhs;
     return result;
@@ -1108,6 +1963,7 @@ MatrixMath::Matrix<_Ty, Height, Width, order>
 MatrixMath::
 operator/(const Matrix<_Ty, Height, Width, order>& lhs, const _Ty& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator/", Height * Width, 2 * Height * Width * sizeof(_Ty));
     Matrix result(lhs);
     result /= rhs;
     return result;
@@ -1169,6 +2025,7 @@ MatrixMath::Matrix<_Ty, Height, Width, order>
 MatrixMath::
 operator*(const MatrixMath::Matrix<_Ty, Height, Width, order>& lhs, const _Ty& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator*", Height * Width, 2 * Height * Width * sizeof(_Ty));
     Matrix result(lhs);
     result *= rhs;
     return result;
@@ -1203,6 +2060,7 @@ MatrixMath::Matrix<_Ty, M, N, order>
 MatrixMath::
 operator*(const MatrixMath::Matrix<_Ty, M, P, order>& lhs, const MatrixMath::Matrix<_Ty, P, N, order>& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator*", 2 * M * N * P, (M * P + P * N + M * N) * sizeof(_Ty));
     MatrixMath::Matrix<_Ty, M, N, order> result;
 
     for (int i = 0; i < M; i++)
@@ -1226,6 +2084,7 @@ MatrixMath::MatrixQ<_Ty, 2, order>
 MatrixMath::
 operator*(const MatrixQ<_Ty, 2, order>& lhs, const MatrixQ<_Ty, 2, order>& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator*", 2 * 2 * 2 * 2, 3 * 2 * 2 * sizeof(_Ty));
     const _Ty& a11 = lhs.GetElement(0, 0);
     const _Ty& a12 = lhs.GetElement(0, 1);
     const _Ty& a21 = lhs.GetElement(1, 0);
@@ -1251,6 +2110,7 @@ MatrixMath::MatrixQ<_Ty, 3, order>
 MatrixMath::
 operator*(const MatrixQ<_Ty, 3, order>& lhs, const MatrixQ<_Ty, 3, order>& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator*", 2 * 3 * 3 * 3, 3 * 3 * 3 * sizeof(_Ty));
     const _Ty& a11 = lhs.GetElement(0, 0);
     const _Ty& a12 = lhs.GetElement(0, 1);
     const _Ty& a13 = lhs.GetElement(0, 2);
@@ -1281,9 +2141,9 @@ operator*(const MatrixQ<_Ty, 3, order>& lhs, const MatrixQ<_Ty, 3, order>& rhs)
     const _Ty c33 = a31 * b13 + a32 * b23 + a33 * b33;
 
     if constexpr (order::IsRowMajor())
-        return MatrixQ<_Ty, 2, order>{ c11, c12, c13, c21, c22, c23, c31, c32, c33 };
+        return MatrixQ<_Ty, 3, order>{ c11, c12, c13, c21, c22, c23, c31, c32, c33 };
     else
-        return MatrixQ<_Ty, 2, order>{ c11, c21, c31, c12, c22, c32, c13, c23, c33 };
+        return MatrixQ<_Ty, 3, order>{ c11, c21, c31, c12, c22, c32, c13, c23, c33 };
 }
 
 template <typename _Ty, typename order>
@@ -1291,6 +2151,7 @@ MatrixMath::MatrixQ<_Ty, 4, order>
 MatrixMath::
 operator*(const MatrixQ<_Ty, 4, order>& lhs, const MatrixQ<_Ty, 4, order>& rhs)
 {
+    MATRIX_TRACE_SCOPE("operator*", 2 * 4 * 4 * 4, 3 * 4 * 4 * sizeof(_Ty));
     const _Ty& a11 = lhs.GetElement(0, 0);
     const _Ty& a12 = lhs.GetElement(0, 1);
     const _Ty& a13 = lhs.GetElement(0, 2);
@@ -1357,11 +2218,13 @@ class MatrixMath::Matrix<_Ty, N, 1, order>
 public:
     using DataType = ProtoMatrixData<_Ty, N, 1, order>;
     using Transposed = Matrix<_Ty, 1, N, order>;
+    using data_ptr_t = typename DataType::data_ptr_t;
 
     Matrix();
     Matrix(const Matrix& other);
     Matrix(Matrix&& other);
     Matrix(const std::initializer_list<_Ty>& init);
+    explicit Matrix(const data_ptr_t& pData, bool isTransposed);
 
     inline void SetElement(const int index, const _Ty& value);
     inline void SetElement(const int row, const int column, const _Ty& value);
@@ -1370,6 +2233,20 @@ public:
     inline _Ty& GetElement(const int index);
     inline _Ty& GetElement(const int row, const int column);
 
+    // Vector algorithms, vectorized over the entries
+
+    inline _Ty Dot(const Matrix& other) const;
+    inline _Ty SquaredNorm() const;
+    inline _Ty Norm() const;
+    // Valid only if N is 3
+    template <int M = N, std::enable_if_t<M == 3, int> = 0>
+    [[nodiscard]]
+    Matrix Cross(const Matrix& other) const;
+    // The vector must not be zero
+    template <Precision precision = Precision::Exact>
+    [[nodiscard]]
+    Matrix Normalize() const;
+
     const std::string ToString() const;
 };
 
@@ -1401,6 +2278,13 @@ Matrix(const std::initializer_list<_Ty>& init)
 {
 }
 
+template <typename _Ty, int N, typename order>
+MatrixMath::Matrix<_Ty, N, 1, order>::
+Matrix(const data_ptr_t& pData, bool isTransposed)
+    : DataType(pData, isTransposed)
+{
+}
+
 template <typename _Ty, int N, typename order>
 inline void
 MatrixMath::Matrix<_Ty, N, 1, order>::
@@ -1452,22 +2336,170 @@ GetElement(const int row, const int column)
     return this->GetElement(row);
 }
 
+template <typename _Ty, int N, typename order>
+inline _Ty
+MatrixMath::Matrix<_Ty, N, 1, order>::
+Dot(const Matrix& other) const
+{
+    return detail::DotProduct(this->GetData().data(), other.GetData().data(), N);
+}
+
+template <typename _Ty, int N, typename order>
+inline _Ty
+MatrixMath::Matrix<_Ty, N, 1, order>::
+SquaredNorm() const
+{
+    auto& data{ this->GetData() };
+    return detail::DotProduct(data.data(), data.data(), N);
+}
+
+template <typename _Ty, int N, typename order>
+inline _Ty
+MatrixMath::Matrix<_Ty, N, 1, order>::
+Norm() const
+{
+    return static_cast<_Ty>(std::sqrt(this->SquaredNorm()));
+}
+
+template <typename _Ty, int N, typename order>
+template <int M, std::enable_if_t<M == 3, int>>
+MatrixMath::Matrix<_Ty, N, 1, order>
+MatrixMath::Matrix<_Ty, N, 1, order>::
+Cross(const Matrix& other) const
+{
+    auto& a{ this->GetData() };
+    auto& b{ other.GetData() };
+    return Matrix{
+        a[1] * b[2] - a[2] * b[1],
+        a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0],
+    };
+}
+
+template <typename _Ty, int N, typename order>
+template <MatrixMath::Precision precision>
+MatrixMath::Matrix<_Ty, N, 1, order>
+MatrixMath::Matrix<_Ty, N, 1, order>::
+Normalize() const
+{
+    const _Ty squaredNorm{ this->SquaredNorm() };
+    _Ty scale;
+    if constexpr (precision == Precision::Fast)
+        scale = detail::ScalarPack<_Ty>::rsqrt(squaredNorm);
+    else
+        scale = 1 / std::sqrt(squaredNorm);
+
+    Matrix result(*this);
+    for (auto& x : result.GetData())
+        x *= scale;
+    return result;
+}
+
 template <typename _Ty, int N, typename order>
 const std::string
 MatrixMath::Matrix<_Ty, N, 1, order>::
 ToString() const
 {
     auto& data{ this->GetData() };
-    std::stringstream ss;
 
-    ss << "| ";
-    for (const auto& x : data)
-    {
-        ss << x << " ";
-    }
-    ss << "|T";
+    // | x y z |T
+    FormatOptions options;
+    options.rowSuffix = " |T";
+    options.width = 0;
+
+    std::string result;
+    detail::FormatAppend(result, 1, N, [&data](const int, const int column) -> const _Ty& {
+        return data[column];
+    }, options);
+    return result;
+}
+
+// Batched vector algorithms
+
+template <int N, typename _Ty>
+void
+MatrixMath::
+BatchDot(const _Ty* lhs, const _Ty* rhs, _Ty* out, const std::size_t count)
+{
+    using Access = detail::InterleavedVectors<const _Ty, N>;
+    detail::BatchDot<N>(Access{ lhs }, Access{ rhs }, out, count);
+}
+
+template <int N, typename _Ty>
+void
+MatrixMath::
+BatchDot(const _Ty* const (&lhs)[N], const _Ty* const (&rhs)[N], _Ty* out, const std::size_t count)
+{
+    using Access = detail::SeparateVectors<const _Ty, N>;
+    detail::BatchDot<N>(Access(lhs), Access(rhs), out, count);
+}
+
+template <int N, typename _Ty>
+void
+MatrixMath::
+BatchSquaredNorm(const _Ty* in, _Ty* out, const std::size_t count)
+{
+    detail::BatchNorm<N, false>(detail::InterleavedVectors<const _Ty, N>{ in }, out, count);
+}
+
+template <int N, typename _Ty>
+void
+MatrixMath::
+BatchSquaredNorm(const _Ty* const (&in)[N], _Ty* out, const std::size_t count)
+{
+    detail::BatchNorm<N, false>(detail::SeparateVectors<const _Ty, N>(in), out, count);
+}
+
+template <int N, typename _Ty>
+void
+MatrixMath::
+BatchNorm(const _Ty* in, _Ty* out, const std::size_t count)
+{
+    detail::BatchNorm<N, true>(detail::InterleavedVectors<const _Ty, N>{ in }, out, count);
+}
+
+template <int N, typename _Ty>
+void
+MatrixMath::
+BatchNorm(const _Ty* const (&in)[N], _Ty* out, const std::size_t count)
+{
+    detail::BatchNorm<N, true>(detail::SeparateVectors<const _Ty, N>(in), out, count);
+}
+
+template <int N, MatrixMath::Precision precision, typename _Ty>
+void
+MatrixMath::
+BatchNormalize(const _Ty* in, _Ty* out, const std::size_t count)
+{
+    detail::BatchNormalize<N, precision == Precision::Fast>(
+        detail::InterleavedVectors<const _Ty, N>{ in }, detail::InterleavedVectors<_Ty, N>{ out }, count);
+}
+
+template <int N, MatrixMath::Precision precision, typename _Ty>
+void
+MatrixMath::
+BatchNormalize(const _Ty* const (&in)[N], _Ty* const (&out)[N], const std::size_t count)
+{
+    detail::BatchNormalize<N, precision == Precision::Fast>(
+        detail::SeparateVectors<const _Ty, N>(in), detail::SeparateVectors<_Ty, N>(out), count);
+}
+
+template <typename _Ty>
+void
+MatrixMath::
+BatchCross(const _Ty* lhs, const _Ty* rhs, _Ty* out, const std::size_t count)
+{
+    using Access = detail::InterleavedVectors<const _Ty, 3>;
+    detail::BatchCross(Access{ lhs }, Access{ rhs }, detail::InterleavedVectors<_Ty, 3>{ out }, count);
+}
 
-    return ss.str();
+template <typename _Ty>
+void
+MatrixMath::
+BatchCross(const _Ty* const (&lhs)[3], const _Ty* const (&rhs)[3], _Ty* const (&out)[3], const std::size_t count)
+{
+    using Access = detail::SeparateVectors<const _Ty, 3>;
+    detail::BatchCross(Access(lhs), Access(rhs), detail::SeparateVectors<_Ty, 3>(out), count);
 }
 
 
@@ -1945,6 +2977,122 @@ namespace detail
 
 }
 
+template <typename MatrixType,
+    std::enable_if_t<MatrixType::Width == MatrixType::Height, int>>
+class MatrixMath::LUDecomposition
+{
+public:
+    using _Ty = typename MatrixType::ElementType;
+    constexpr static int N{ MatrixType::Width };
+    using ResultType = MatrixQ<_Ty, N>;
+
+private:
+    // L (without its unit diagonal) and U packed together;
+    // row `row` of the factors is stored at row `permutation[row]`
+    std::array<_Ty, N * N> data;
+    Permutation<N> permutation;
+    bool isSingular;
+
+    inline const _Ty& at(const int row, const int column) const
+    {
+        return data[column + permutation[row] * N];
+    }
+
+public:
+    LUDecomposition(const MatrixType& square)
+        : isSingular{ false }
+    {
+        MATRIX_TRACE_SCOPE("LUDecomposition", 2 * N * N * N / 3, N * N * sizeof(_Ty));
+        for (int row = 0; row < N; row++)
+            for (int col = 0; col < N; col++)
+                data[col + row * N] = square.GetElement(row, col);
+
+        for (int k = 0; k < N; k++)
+        {
+            // choose the entry of the largest magnitude as the pivot
+            int pivot{ k };
+            _Ty largest{ std::abs(at(k, k)) };
+            for (int i = k + 1; i < N; i++)
+            {
+                const _Ty candidate{ std::abs(at(i, k)) };
+                if (candidate > largest)
+                {
+                    largest = candidate;
+                    pivot = i;
+                }
+            }
+            permutation.Swap(k, pivot);
+
+            const _Ty* pivotRow{ data.data() + permutation[k] * N };
+            if (pivotRow[k] == MetaMath::Zero<_Ty>)
+            {
+                isSingular = true;
+                continue;
+            }
+
+            if constexpr (std::is_floating_point_v<_Ty> && N >= 8)
+            {
+                // the rows below the pivot, through the kernel of the CPU
+                std::array<int, N> rows;
+                for (int i = k + 1; i < N; i++)
+                    rows[i - k - 1] = permutation[i];
+                detail::EliminateColumn(data.data(), N, permutation[k], rows.data(), N - k - 1, k);
+                continue;
+            }
+
+            for (int i = k + 1; i < N; i++)
+            {
+                _Ty* currentRow{ data.data() + permutation[i] * N };
+                const _Ty factor{ currentRow[k] / pivotRow[k] };
+                currentRow[k] = factor;
+                for (int j = k + 1; j < N; j++)
+                    currentRow[j] -= factor * pivotRow[j];
+            }
+        }
+    }
+
+    const Permutation<N>& GetPermutation() const
+    {
+        return permutation;
+    }
+
+    bool IsSingular() const
+    {
+        return isSingular;
+    }
+
+    ResultType GetLower() const
+    {
+        ResultType result;
+        for (int row = 0; row < N; row++)
+        {
+            for (int col = 0; col < row; col++)
+                result.SetElement(row, col, at(row, col));
+            result.SetElement(row, row, static_cast<_Ty>(1));
+        }
+        return result;
+    }
+
+    ResultType GetUpper() const
+    {
+        ResultType result;
+        for (int row = 0; row < N; row++)
+            for (int col = row; col < N; col++)
+                result.SetElement(row, col, at(row, col));
+        return result;
+    }
+
+    _Ty GetDeterminant() const
+    {
+        if (isSingular)
+            return MetaMath::Zero<_Ty>;
+        _Ty result{ static_cast<_Ty>(permutation.Sign()) };
+        for (int i = 0; i < N; i++)
+            result *= at(i, i);
+        return result;
+    }
+};
+
 template <typename MatrixType,
     std::enable_if_t<MatrixType::Width == MatrixType::Height, int>>
 class MatrixMath::Determinant
@@ -1956,23 +3104,45 @@ private:
     _Ty result;
     constexpr static int N{ MatrixType::Width };
 
+    // elimination, or N products for each of the N! permutations
+    constexpr static std::uint64_t flops()
+    {
+        std::uint64_t count{ N };
+        if constexpr (std::is_floating_point_v<_Ty> && N > 3)
+            count = 2 * N * N * N / 3;
+        else
+            for (int i = 2; i <= N; i++)
+                count *= i;
+        return count;
+    }
+
 public:
     Determinant(const MatrixType& square)
         : result{ 0 }
     {
-        for (auto& p : detail::PermutationGenerator<N>::generate())
+        MATRIX_TRACE_SCOPE("Determinant", flops(), N * N * sizeof(_Ty));
+        if constexpr (std::is_floating_point_v<_Ty> && N > 3)
+        {
+            // O(N^3) elimination instead of expanding N! permutations;
+            // the sign is tracked by the permutation of the pivoting
+            result = LUDecomposition<MatrixType>(square).GetDeterminant();
+        }
+        else
         {
-            // calculate power(-1, p.inverse)
-            _Ty cache{ (p.inverse & 0x1) ? -1 : 1 };
-            //std::cout << std::setw(2) << cache;
-            for (int i = 0; i < N; i++)
+            for (auto& p : detail::PermutationGenerator<N>::generate())
             {
-                const _Ty& element{ square.GetElement(i, p[i]) };
-                cache *= element;
-                //std::cout << " * (" << i << ", " << p[i] << ": " << element << ")";
+                // calculate power(-1, p.inverse)
+                _Ty cache{ static_cast<_Ty>((p.inverse & 0x1) ? -1 : 1) };
+                //std::cout << std::setw(2) << cache;
+                for (int i = 0; i < N; i++)
+                {
+                    const _Ty& element{ square.GetElement(i, p[i]) };
+                    cache *= element;
+                    //std::cout << " * (" << i << ", " << p[i] << ": " << element << ")";
+                }
+                result += cache;
+                //std::cout << " = " << cache << std::endl;
             }
-            result += cache;
-            //std::cout << " = " << cache << std::endl;
         }
     }
 
@@ -2007,53 +3177,54 @@ AlgebraicCofactor(const MatrixType& square)
     return result;
 }
 
-namespace detail
-{
-    template <typename MatrixType>
-    struct AdjointMatrix_Context_t
-    {
-        constexpr static int Height{ MatrixType::Height };
-        constexpr static int Width{ MatrixType::Width };
-
-        const MatrixType& matrix;
-        MatrixType& result;
-
-        AdjointMatrix_Context_t(const MatrixType& matrix, MatrixType& result)
-            : matrix{ matrix }
-            , result{ result }
-        {
-        }
-    };
-
-    template <typename ContextType>
-    struct AdjointMatrix_Maker_t
-    {
-        template <typename XRange, typename YRange>
-        constexpr static void run(ContextType& context)
-        {
-            auto val{ MatrixMath::template AlgebraicCofactor<XRange::Pos, YRange::Pos>(context.matrix) };
-            const int col{ XRange::Pos };
-            const int row{ YRange::Pos };
-            context.result.SetElement(row, col, val);
-        }
-    };
-}
-
 template <typename MatrixType,
     std::enable_if_t<MatrixType::Width == MatrixType::Height, int>>
 MatrixType
 MatrixMath::
 AdjointMatrix(const MatrixType& matrix)
 {
-    using ContextType = detail::template AdjointMatrix_Context_t<MatrixType>;
-    using FunctionType = detail::template AdjointMatrix_Maker_t<ContextType>;
+    using _Ty = typename MatrixType::ElementType;
+    constexpr int N{ MatrixType::Width };
+    // the determinants are traced on their own
+    MATRIX_TRACE_SCOPE("AdjointMatrix", 0, 2 * N * N * sizeof(_Ty));
     MatrixType result;
 
-    MetaControl::ForLoop_t::template pass1<
-        MetaControl::template ForLoop_Range_t<0, MatrixType::Height, 1>,
-        MetaControl::template ForLoop_Range_t<0, MatrixType::Width, 1>,
-        FunctionType
-    >(ContextType(matrix, result));
+    if constexpr (N == 2)
+    {
+        result.SetElement(0, 0, matrix.GetElement(1, 1));
+        result.SetElement(0, 1, -matrix.GetElement(0, 1));
+        result.SetElement(1, 0, -matrix.GetElement(1, 0));
+        result.SetElement(1, 1, matrix.GetElement(0, 0));
+    }
+    else
+    {
+        // the minors are copied into one matrix in a runtime loop,
+        // which instantiates a single determinant whatever the size,
+        // instead of one cofactor view and one determinant per entry
+        MatrixQ<_Ty, N - 1> minor;
+        for (int row = 0; row < N; row++)
+        {
+            for (int col = 0; col < N; col++)
+            {
+                for (int y = 0, i = 0; y < N; y++)
+                {
+                    if (y == row)
+                        continue;
+                    for (int x = 0, j = 0; x < N; x++)
+                    {
+                        if (x != col)
+                            minor.SetElement(i, j++, matrix.GetElement(y, x));
+                    }
+                    i++;
+                }
+
+                _Ty cofactor{ Determinant(minor).value() };
+                if (((row + col) & 1) == 1)
+                    cofactor = -cofactor;
+                result.SetElement(col, row, cofactor);
+            }
+        }
+    }
 
     return result;
 }
@@ -2076,28 +3247,26 @@ IsInvertible(const MatrixType& matrix)
     return Zero<_Ty> != Determinant(matrix).value();
 }
 
+template <typename MatrixType,
+    std::enable_if_t<MatrixType::Width == MatrixType::Height, int>>
+MatrixType
+MatrixMath::
+Inverse(const MatrixType& matrix)
+{
+    MATRIX_TRACE_SCOPE("Inverse", MatrixType::Height * MatrixType::Width,
+        2 * MatrixType::Height * MatrixType::Width * sizeof(typename MatrixType::ElementType));
+    MatrixType result{ AdjointMatrix(matrix) };
+    result /= Determinant(matrix).value();
+    return result;
+}
+
 template <typename MatrixType>
 const std::string
 MatrixMath::
 ToString(const MatrixType& matrix)
 {
-    std::stringstream ss;
-    int Width{ MatrixType::Width };
-    int Height{ MatrixType::Height };
-
-    for (int row = 0; row < Height; row++)
-    {
-        ss << "| ";
-        for (int column = 0; column < Width; column++)
-        {
-            ss << std::setw(5)
-                << matrix.GetElement(row, column)
-                << " ";
-        }
-        ss << "    |" << std::endl;
-    }
-
-    return ss.str();
+    MATRIX_TRACE_SCOPE("ToString", 0, MatrixType::Height * MatrixType::Width * sizeof(typename MatrixType::ElementType));
+    return Format(matrix, FormatOptions::Pretty());
 }
 
 template <typename NewOrder, typename _Ty, int Height, int Width, typename OldOrder>
@@ -2115,21 +3284,84 @@ ChangeOrder(const Matrix<_Ty, Height, Width, OldOrder>& other)
     static_assert(!std::is_base_of_v<AbstractCofactor, OldOrder>,
         "Invalid template argument: It is not allowed to change from CofactorOrder!");
 
+    MATRIX_TRACE_SCOPE("ChangeOrder", 0, 2 * Height * Width * sizeof(_Ty));
+
     if constexpr (std::is_same_v<NewOrder, OldOrder>)
         return other;
 
     using NewType = Matrix<_Ty, Height, Width, NewOrder>;
 
     NewType result;
-    for (int row = 0; row < Height; row++)
-        for (int col = 0; col < Width; col++)
-            result.SetElement(row, col,
-                other.GetElement(row, col));
+    const _Ty* src{ other.GetData().data() };
+    _Ty* dst{ result.GetData().data() };
+
+    // whether the entries of a row are contiguous in the buffers
+    const bool isSrcByRow{ OldOrder::IsRowMajor() != other.IsTransposed() };
+    constexpr bool IsDstByRow{ NewOrder::IsRowMajor() };
+
+    if (isSrcByRow == IsDstByRow)
+        std::copy(src, src + Height * Width, dst);
+    else if (isSrcByRow)
+        detail::TransposeBlock(src, Width, dst, Height, Height, Width);
+    else
+        detail::TransposeBlock(src, Height, dst, Width, Width, Height);
     return result;
 }
 
 namespace detail
 {
+    // Copy all the entries of `src` into the region of a (DstHeight x DstWidth)
+    // buffer stored in `DstOrder`, whose entry (0, 0) is at (row, column);
+    // whole rows or columns are copied at once if the layouts agree,
+    // otherwise the entries are transposed block by block
+    template <typename DstOrder, int DstHeight, int DstWidth, typename MatrixType>
+    void CopyMatrixInto(const MatrixType& src, typename MatrixType::ElementType* dst,
+        const int row, const int column)
+    {
+        using _Ty = typename MatrixType::ElementType;
+        using SrcOrder = typename MatrixType::OrderType;
+        constexpr int Height{ MatrixType::Height };
+        constexpr int Width{ MatrixType::Width };
+        constexpr bool IsDstByRow{ DstOrder::IsRowMajor() };
+        constexpr int DstStride{ IsDstByRow ? DstWidth : DstHeight };
+
+        dst += DstOrder::convert2index(DstHeight, DstWidth, row, column, false);
+
+        // only the matrices holding a buffer of their own can be copied in bulk,
+        // views like SubMatrix or Cofactor are copied entry by entry
+        if constexpr (std::is_base_of_v<MatrixMath::ProtoMatrixData<_Ty, Height, Width, SrcOrder>, MatrixType>)
+        {
+            const _Ty* source{ src.GetData().data() };
+            const bool isSrcByRow{ SrcOrder::IsRowMajor() != src.IsTransposed() };
+            const int srcLines{ isSrcByRow ? Height : Width };
+            const int srcLength{ isSrcByRow ? Width : Height };
+
+            if (isSrcByRow == IsDstByRow)
+            {
+                if (srcLength == DstStride)
+                {
+                    std::copy(source, source + Height * Width, dst);
+                }
+                else
+                {
+                    for (int line = 0; line < srcLines; line++)
+                        std::copy(source + line * srcLength, source + (line + 1) * srcLength,
+                            dst + line * DstStride);
+                }
+            }
+            else
+            {
+                detail::TransposeBlock(source, srcLength, dst, DstStride, srcLines, srcLength);
+            }
+        }
+        else
+        {
+            for (int y = 0; y < Height; y++)
+                for (int x = 0; x < Width; x++)
+                    dst[DstOrder::convert2index(DstHeight, DstWidth, y, x, false)] = src.GetElement(y, x);
+        }
+    }
+
     template <typename _LhsMatrixType, typename _RhsMatrixType, MatrixMath::MergeMode _MergeMode>
     struct MergingMatricesTypeCheck
     {
@@ -2323,8 +3555,12 @@ namespace detail
             MergeResultImpl(const _LMatrixType& lhs, const _RMatrixType& rhs)
                 : DataType()
             {
-                // TODO copy the entries of two matrices
-                // into the newly created data container
+                _Ty* dst{ this->GetData().data() };
+                CopyMatrixInto<_NewStorageOrder, Height, Width>(lhs, dst, 0, 0);
+                if constexpr (IsModeRow)
+                    CopyMatrixInto<_NewStorageOrder, Height, Width>(rhs, dst, 0, LWidth);
+                else
+                    CopyMatrixInto<_NewStorageOrder, Height, Width>(rhs, dst, LHeight, 0);
             }
 
             inline void SetElement(const int index, const _Ty& value)
@@ -2383,6 +3619,29 @@ namespace detail
             typename AbstractMergeResult<_LMatrixType, _RMatrixType, _MergeMode, _NewStorageOrder>::MergeResultImpl,
             void>>;
     };
+
+    // Type of the result of merging any number of matrices in one pass
+    template <MatrixMath::MergeMode _MergeMode, typename _NewStorageOrder, typename _FirstType, typename... _RestTypes>
+    struct _MultiMergeResult
+    {
+        using _Ty = typename _FirstType::ElementType;
+        constexpr static bool IsModeRow{ _MergeMode == MatrixMath::MergeMode::ROW_MEG };
+
+        static_assert(_MergeMode == MatrixMath::MergeMode::ROW_MEG
+            || _MergeMode == MatrixMath::MergeMode::COL_MEG,
+            "Invalid template argument: Merging more than two matrices requires ROW_MEG or COL_MEG!");
+        static_assert((std::is_same_v<_Ty, typename _RestTypes::ElementType> && ...),
+            "Invalid template argument: Element types differ!");
+        static_assert(IsModeRow
+            ? ((_FirstType::Height == _RestTypes::Height) && ...)
+            : ((_FirstType::Width == _RestTypes::Width) && ...),
+            "Invalid template argument: Dimensions mismatch!");
+
+        constexpr static int Height{ IsModeRow ? _FirstType::Height : (_FirstType::Height + ... + _RestTypes::Height) };
+        constexpr static int Width{ IsModeRow ? (_FirstType::Width + ... + _RestTypes::Width) : _FirstType::Width };
+
+        using type = MatrixMath::Matrix<_Ty, Height, Width, _NewStorageOrder>;
+    };
 }
 
 namespace MatrixMath
@@ -2392,6 +3651,14 @@ namespace MatrixMath
 
     template <typename _LMatrixType, typename _RMatrixType, MatrixMath::MergeMode _MergeMode, typename _NewStorageOrder>
     MergeResult<_LMatrixType, _RMatrixType, _MergeMode, _NewStorageOrder> Merge(const _LMatrixType& lhs, const _RMatrixType& rhs);
+
+    template <MatrixMath::MergeMode _MergeMode, typename _NewStorageOrder, typename _FirstType, typename... _RestTypes>
+    using MultiMergeResult = typename detail::_MultiMergeResult<_MergeMode, _NewStorageOrder, _FirstType, _RestTypes...>::type;
+
+    // Merge all the matrices SUBSTANTIALLY in one pass,
+    // allocating a single data container for the result
+    template <MatrixMath::MergeMode _MergeMode, typename _NewStorageOrder, typename _FirstType, typename... _RestTypes>
+    MultiMergeResult<_MergeMode, _NewStorageOrder, _FirstType, _RestTypes...> Merge(const _FirstType& first, const _RestTypes&... rest);
 }
 
 template <typename _LMatrixType, typename _RMatrixType, MatrixMath::MergeMode _MergeMode, typename _NewStorageOrder>
@@ -2399,4 +3666,28 @@ MatrixMath::MergeResult<_LMatrixType, _RMatrixType, _MergeMode, _NewStorageOrder
 MatrixMath::Merge(const _LMatrixType& lhs, const _RMatrixType& rhs)
 {
     return MergeResult<_LMatrixType, _RMatrixType, _MergeMode, _NewStorageOrder>(lhs, rhs);
-}
\ No newline at end of file
+}
+
+template <MatrixMath::MergeMode _MergeMode, typename _NewStorageOrder, typename _FirstType, typename... _RestTypes>
+MatrixMath::MultiMergeResult<_MergeMode, _NewStorageOrder, _FirstType, _RestTypes...>
+MatrixMath::Merge(const _FirstType& first, const _RestTypes&... rest)
+{
+    using ResultInfo = detail::_MultiMergeResult<_MergeMode, _NewStorageOrder, _FirstType, _RestTypes...>;
+    constexpr int Height{ ResultInfo::Height };
+    constexpr int Width{ ResultInfo::Width };
+    MATRIX_TRACE_SCOPE("Merge", 0, 2 * Height * Width * sizeof(typename ResultInfo::type::ElementType));
+
+    typename ResultInfo::type result;
+    auto* dst{ result.GetData().data() };
+    // the position of the next matrix in the result
+    int offset{ 0 };
+
+    detail::CopyMatrixInto<_NewStorageOrder, Height, Width>(first, dst, 0, 0);
+    offset += ResultInfo::IsModeRow ? _FirstType::Width : _FirstType::Height;
+    ((ResultInfo::IsModeRow
+        ? detail::CopyMatrixInto<_NewStorageOrder, Height, Width>(rest, dst, 0, offset)
+        : detail::CopyMatrixInto<_NewStorageOrder, Height, Width>(rest, dst, offset, 0),
+        offset += ResultInfo::IsModeRow ? _RestTypes::Width : _RestTypes::Height), ...);
+
+    return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// Explicit instantiations of the common matrix types
+//
+// Including this header instead of "Matrix.h" declares the square matrices
+// and vectors of size 2 to 4 over int, float and double, in both storage
+// orders, together with their basic, multiplication and advanced algorithms,
+// as `extern template`: translation units stop instantiating them
+// and link against the MatrixLib library, which defines them once.
+// Inline members are still instantiated where they are used, so that
+// they can be inlined as before.
+
+#include "Matrix.h"
+
+// Defined as empty by the translation unit of MatrixLib,
+// which turns the declarations below into definitions
+#ifndef MATRIX_EXTERN
+#   define MATRIX_EXTERN extern
+#endif
+
+#define MATRIX_INSTANTIATE_DATA(_Ty, Height, Width, order) \
+    MATRIX_EXTERN template class MatrixMath::ProtoMatrixData<_Ty, Height, Width, order>; \
+    MATRIX_EXTERN template class MatrixMath::Matrix<_Ty, Height, Width, order>; \
+    MATRIX_EXTERN template void MatrixMath::operator+=(MatrixMath::Matrix<_Ty, Height, Width, order>&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template void MatrixMath::operator-=(MatrixMath::Matrix<_Ty, Height, Width, order>&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template void MatrixMath::operator*=(MatrixMath::Matrix<_Ty, Height, Width, order>&, const _Ty&); \
+    MATRIX_EXTERN template void MatrixMath::operator/=(MatrixMath::Matrix<_Ty, Height, Width, order>&, const _Ty&); \
+    MATRIX_EXTERN template MatrixMath::Matrix<_Ty, Height, Width, order> MatrixMath::operator+(const MatrixMath::Matrix<_Ty, Height, Width, order>&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template MatrixMath::Matrix<_Ty, Height, Width, order> MatrixMath::operator-(const MatrixMath::Matrix<_Ty, Height, Width, order>&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template MatrixMath::Matrix<_Ty, Height, Width, order> MatrixMath::operator/(const MatrixMath::Matrix<_Ty, Height, Width, order>&, const _Ty&); \
+    MATRIX_EXTERN template MatrixMath::Matrix<_Ty, Height, Width, order> MatrixMath::operator*(const MatrixMath::Matrix<_Ty, Height, Width, order>&, const _Ty&); \
+    MATRIX_EXTERN template MatrixMath::Matrix<_Ty, Height, Width, order> MatrixMath::operator*(const _Ty&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template bool MatrixMath::operator==(const MatrixMath::Matrix<_Ty, Height, Width, order>&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template bool MatrixMath::operator!=(const MatrixMath::Matrix<_Ty, Height, Width, order>&, const MatrixMath::Matrix<_Ty, Height, Width, order>&); \
+    MATRIX_EXTERN template const std::string MatrixMath::ToString(const MatrixMath::Matrix<_Ty, Height, Width, order>&);
+
+#define MATRIX_INSTANTIATE_SQUARE(_Ty, N, order, otherOrder) \
+    MATRIX_INSTANTIATE_DATA(_Ty, N, N, order) \
+    MATRIX_INSTANTIATE_DATA(_Ty, N, 1, order) \
+    MATRIX_EXTERN template MatrixMath::MatrixQ<_Ty, N, order> MatrixMath::operator*(const MatrixMath::MatrixQ<_Ty, N, order>&, const MatrixMath::MatrixQ<_Ty, N, order>&); \
+    MATRIX_EXTERN template MatrixMath::Vector<_Ty, N, order> MatrixMath::operator*(const MatrixMath::MatrixQ<_Ty, N, order>&, const MatrixMath::Vector<_Ty, N, order>&); \
+    MATRIX_EXTERN template MatrixMath::MatrixQ<_Ty, N, otherOrder> MatrixMath::ChangeOrder<otherOrder>(const MatrixMath::MatrixQ<_Ty, N, order>&); \
+    MATRIX_EXTERN template class MatrixMath::Determinant<MatrixMath::MatrixQ<_Ty, N, order>>; \
+    MATRIX_EXTERN template MatrixMath::MatrixQ<_Ty, N, order> MatrixMath::AdjointMatrix(const MatrixMath::MatrixQ<_Ty, N, order>&); \
+    MATRIX_EXTERN template bool MatrixMath::IsInvertible(const MatrixMath::MatrixQ<_Ty, N, order>&); \
+    MATRIX_EXTERN template MatrixMath::MatrixQ<_Ty, N, order> MatrixMath::Inverse(const MatrixMath::MatrixQ<_Ty, N, order>&);
+
+#define MATRIX_INSTANTIATE_SIZES(_Ty, order, otherOrder) \
+    MATRIX_INSTANTIATE_SQUARE(_Ty, 2, order, otherOrder) \
+    MATRIX_INSTANTIATE_SQUARE(_Ty, 3, order, otherOrder) \
+    MATRIX_INSTANTIATE_SQUARE(_Ty, 4, order, otherOrder)
+
+#define MATRIX_INSTANTIATE_ORDERS(_Ty) \
+    MATRIX_INSTANTIATE_SIZES(_Ty, MatrixMath::StorageOrder::RowMajor, MatrixMath::StorageOrder::ColumnMajor) \
+    MATRIX_INSTANTIATE_SIZES(_Ty, MatrixMath::StorageOrder::ColumnMajor, MatrixMath::StorageOrder::RowMajor)
+
+MATRIX_INSTANTIATE_ORDERS(int)
+MATRIX_INSTANTIATE_ORDERS(float)
+MATRIX_INSTANTIATE_ORDERS(double)
+
+#undef MATRIX_INSTANTIATE_ORDERS
+#undef MATRIX_INSTANTIATE_SIZES
+#undef MATRIX_INSTANTIATE_SQUARE
+#undef MATRIX_INSTANTIATE_DATA
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "DynamicMatrix.h"
+#include "Kernel.h"
+#include "MappedFile.h"
+#include "Matrix.h"
+
+namespace MatrixMath
+{
+    struct ParseOptions
+    {
+        // Separator of the entries besides spaces, tabs and carriage returns;
+        // zero accepts both ',' and ';'. Consecutive separators count as one
+        char delimiter{ 0 };
+        // Threads parsing chunks of lines in parallel; zero: one per core
+        int threads{ 0 };
+        // Texts are not split into chunks smaller than this
+        std::size_t minChunkSize{ 1 << 20 };
+    };
+
+    struct ParseResult
+    {
+        // - std::errc::invalid_argument:
+        //      malformed entry, or lines of different lengths,
+        //      or dimensions different from those of a fixed-size matrix
+        // - std::errc::result_out_of_range:
+        //      entry not representable by the element type
+        // - errors of the file system when loading files
+        std::errc ec{};
+        // 1-based line of the first error, zero if not related to a line
+        std::size_t line{ 0 };
+        // dimensions found in the text
+        int rows{ 0 };
+        int columns{ 0 };
+
+        inline explicit operator bool() const { return ec == std::errc{}; }
+    };
+
+    // Fill the matrix with the numbers of the text, one row per line;
+    // blank lines are skipped. Dynamic matrices are resized to fit the text,
+    // fixed-size ones must have its dimensions
+    template <typename _Ty, typename order>
+    ParseResult ParseMatrix(const std::string_view text, DynamicMatrix<_Ty, order>& matrix, const ParseOptions& options = {});
+
+    template <typename _Ty, int Height, int Width, typename order>
+    ParseResult ParseMatrix(const std::string_view text, Matrix<_Ty, Height, Width, order>& matrix, const ParseOptions& options = {});
+
+    // Map the file and parse it in place, without reading it into a buffer first
+    template <typename MatrixType>
+    ParseResult LoadMatrix(const char* path, MatrixType& matrix, const ParseOptions& options = {});
+}
+
+namespace detail
+{
+    // Text split at line boundaries into pieces parsed independently:
+    // pass 1 counts the rows of every piece, so that pass 2 knows
+    // where each piece writes its rows
+    struct ParseChunk
+    {
+        const char* first;
+        const char* last;
+        // rows and lines before the chunk
+        std::size_t firstRow{ 0 };
+        std::size_t firstLine{ 0 };
+        // rows and lines of the chunk
+        std::size_t rows{ 0 };
+        std::size_t lines{ 0 };
+        MatrixMath::ParseResult result{};
+    };
+
+    inline bool IsParseSeparator(const char c, const char delimiter)
+    {
+        return c == ' ' || c == '\t' || c == '\r'
+            || (delimiter == 0 ? c == ',' || c == ';' : c == delimiter);
+    }
+
+    inline const char* SkipParseSeparators(const char* first, const char* last, const char delimiter)
+    {
+        while (first != last && IsParseSeparator(*first, delimiter))
+            ++first;
+        return first;
+    }
+
+    // Entries of the line [first, last), `at(column)` being called with each of them;
+    // returns the number of entries, or -1 with `ec` set
+    template <typename _Ty, typename _At>
+    int ParseLine(const char* first, const char* last, const char delimiter, const int capacity,
+        _At&& at, std::errc& ec)
+    {
+        int column{ 0 };
+        for (first = SkipParseSeparators(first, last, delimiter); first != last;
+            first = SkipParseSeparators(first, last, delimiter))
+        {
+            if (column == capacity)
+            {
+                ec = std::errc::invalid_argument;
+                return -1;
+            }
+            // from_chars rejects the plus sign, but would accept "+-1"
+            if (*first == '+')
+            {
+                ++first;
+                if (first != last && *first == '-')
+                {
+                    ec = std::errc::invalid_argument;
+                    return -1;
+                }
+            }
+
+            _Ty value{};
+            const std::from_chars_result result{ std::from_chars(first, last, value) };
+            if (result.ec != std::errc{})
+            {
+                ec = result.ec;
+                return -1;
+            }
+            // "1.5x" or "1.5" into an integer
+            if (result.ptr != last && !IsParseSeparator(*result.ptr, delimiter))
+            {
+                ec = std::errc::invalid_argument;
+                return -1;
+            }
+            at(column++, value);
+            first = result.ptr;
+        }
+        return column;
+    }
+
+    inline bool IsBlankLine(const char* first, const char* last, const char delimiter)
+    {
+        return SkipParseSeparators(first, last, delimiter) == last;
+    }
+
+    // Run `task(index)` for every index in [0, count), on `count` threads
+    template <typename _Task>
+    void RunParallel(const std::size_t count, _Task&& task)
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(count > 0 ? count - 1 : 0);
+        for (std::size_t index = 1; index < count; index++)
+            workers.emplace_back(task, index);
+        if (count > 0)
+            task(0);
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    // `resize(rows, columns)` prepares the destination and returns false
+    // if it cannot hold such a matrix; `at(row, column)` returns its entries
+    template <typename _Ty, typename _Resize, typename _At>
+    MatrixMath::ParseResult ParseText(const std::string_view text, const MatrixMath::ParseOptions& options,
+        _Resize&& resize, _At&& at)
+    {
+        const char* const begin{ text.data() };
+        const char* const end{ text.data() + text.size() };
+        const char delimiter{ options.delimiter };
+        MatrixMath::ParseResult result;
+
+        // the first line which is not blank gives the number of columns
+        std::size_t line{ 0 };
+        for (const char* first = begin; first != end && result.columns == 0; line++)
+        {
+            const char* last{ FindByte(first, end, '\n') };
+            std::errc ec{};
+            const int columns{ ParseLine<_Ty>(first, last, delimiter, 1 << 30,
+                [](const int, const _Ty&) {}, ec) };
+            if (columns < 0)
+                return { ec, line + 1 };
+            result.columns = columns;
+            first = last == end ? end : last + 1;
+        }
+        if (result.columns == 0)
+        {
+            if (!resize(0, 0))
+                return { std::errc::invalid_argument };
+            return result;
+        }
+
+        // split the text at line boundaries
+        const std::size_t hardware{ std::max(1u, std::thread::hardware_concurrency()) };
+        const std::size_t threads{ options.threads > 0 ? static_cast<std::size_t>(options.threads) : hardware };
+        const std::size_t count{ std::max<std::size_t>(1,
+            std::min(threads, text.size() / std::max<std::size_t>(options.minChunkSize, 1))) };
+        std::vector<ParseChunk> chunks(count);
+        const char* first{ begin };
+        for (std::size_t index = 0; index < count; index++)
+        {
+            const char* last{ index + 1 == count ? end : begin + text.size() / count * (index + 1) };
+            if (last <= first)
+                last = first;
+            else if (last != end)
+            {
+                last = FindByte(last - 1, end, '\n');
+                last = last == end ? end : last + 1;
+            }
+            chunks[index].first = first;
+            chunks[index].last = last;
+            first = last;
+        }
+
+        // pass 1: count the rows of the chunks
+        RunParallel(count, [&chunks, delimiter](const std::size_t index) {
+            ParseChunk& chunk{ chunks[index] };
+            for (const char* first = chunk.first; first != chunk.last; chunk.lines++)
+            {
+                const char* last{ FindByte(first, chunk.last, '\n') };
+                if (!IsBlankLine(first, last, delimiter))
+                    chunk.rows++;
+                first = last == chunk.last ? last : last + 1;
+            }
+        });
+
+        std::size_t rows{ 0 };
+        line = 0;
+        for (auto& chunk : chunks)
+        {
+            chunk.firstRow = rows;
+            chunk.firstLine = line;
+            rows += chunk.rows;
+            line += chunk.lines;
+        }
+        if (rows > static_cast<std::size_t>(1 << 30))
+            return { std::errc::result_out_of_range };
+        result.rows = static_cast<int>(rows);
+        if (!resize(result.rows, result.columns))
+        {
+            result.ec = std::errc::invalid_argument;
+            return result;
+        }
+
+        // pass 2: parse the chunks straight into the destination
+        const int columns{ result.columns };
+        RunParallel(count, [&chunks, &at, delimiter, columns](const std::size_t index) {
+            ParseChunk& chunk{ chunks[index] };
+            int row{ static_cast<int>(chunk.firstRow) };
+            std::size_t line{ chunk.firstLine };
+            for (const char* first = chunk.first; first != chunk.last; line++)
+            {
+                const char* last{ FindByte(first, chunk.last, '\n') };
+                std::errc ec{};
+                const int found{ ParseLine<_Ty>(first, last, delimiter, columns,
+                    [&at, row](const int column, const _Ty& value) { at(row, column) = value; }, ec) };
+                if (found > 0 && found != columns)
+                    ec = std::errc::invalid_argument;
+                if (ec != std::errc{})
+                {
+                    chunk.result = { ec, line + 1 };
+                    return;
+                }
+                if (found > 0)
+                    row++;
+                first = last == chunk.last ? last : last + 1;
+            }
+        });
+
+        // report the first error of the text
+        for (const auto& chunk : chunks)
+        {
+            if (chunk.result.ec != std::errc{})
+            {
+                result.ec = chunk.result.ec;
+                result.line = chunk.result.line;
+                break;
+            }
+        }
+        return result;
+    }
+}
+
+
+template <typename _Ty, typename order>
+MatrixMath::ParseResult
+MatrixMath::
+ParseMatrix(const std::string_view text, DynamicMatrix<_Ty, order>& matrix, const ParseOptions& options)
+{
+    return detail::ParseText<_Ty>(text, options,
+        [&matrix](const int rows, const int columns) {
+            matrix.Resize(rows, columns);
+            return true;
+        },
+        [&matrix](const int row, const int column) -> _Ty& {
+            return matrix.GetElement(row, column);
+        });
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+MatrixMath::ParseResult
+MatrixMath::
+ParseMatrix(const std::string_view text, Matrix<_Ty, Height, Width, order>& matrix, const ParseOptions& options)
+{
+    return detail::ParseText<_Ty>(text, options,
+        [](const int rows, const int columns) {
+            return rows == Height && columns == Width;
+        },
+        [&matrix](const int row, const int column) -> _Ty& {
+            return matrix.GetElement(row, column);
+        });
+}
+
+template <typename MatrixType>
+MatrixMath::ParseResult
+MatrixMath::
+LoadMatrix(const char* path, MatrixType& matrix, const ParseOptions& options)
+{
+    const MappedFile file(path);
+    if (!file.IsOpen())
+        return { file.GetError() };
+    return ParseMatrix(file.GetText(), matrix, options);
+}
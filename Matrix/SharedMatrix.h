@@ -0,0 +1,484 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include "Binary.h"
+#include "Matrix.h"
+
+namespace detail
+{
+    // Named shared memory: a POSIX shared-memory object (shm_open)
+    // or a Windows file mapping backed by the paging file
+    class SharedSegment
+    {
+    private:
+        std::string name;
+        void* address{ nullptr };
+        std::size_t size{ 0 };
+#if defined(_WIN32)
+        HANDLE mapping{ nullptr };
+#else
+        // the creator removes the name
+        bool isOwner{ false };
+#endif
+
+    public:
+        SharedSegment() = default;
+        SharedSegment(const SharedSegment&) = delete;
+        SharedSegment& operator=(const SharedSegment&) = delete;
+        ~SharedSegment();
+
+        // Fails with std::errc::file_exists if the name is taken
+        std::errc Create(const char* name, const std::size_t size);
+        // Read-only; the size is that of the existing segment
+        std::errc Attach(const char* name);
+
+        inline void* GetAddress() const { return address; }
+        inline std::size_t GetSize() const { return size; }
+
+    private:
+        inline static std::errc lastError();
+    };
+}
+
+namespace MatrixMath
+{
+    // Segment layout:
+    //
+    //   [0, 64)        description of the matrix
+    //   [64, 128)      sequence number of the seqlock, alone in its cache line
+    //   [128, ...)     the entries in `order`
+    struct SharedMatrixHeader
+    {
+        constexpr static char Magic[4]{ 'M', 'T', 'R', 'S' };
+        constexpr static std::uint16_t Version{ 1 };
+        constexpr static std::size_t DataOffset{ 128 };
+
+        char magic[4];
+        std::uint16_t version;
+        ElementCode elementCode;
+        std::uint8_t elementSize;
+        std::uint32_t height;
+        std::uint32_t width;
+        // 0: row-major, 1: column-major
+        std::uint8_t order;
+
+        // odd while the writer is updating the entries,
+        // incremented twice by every update
+        alignas(64) std::atomic<std::uint64_t> sequence;
+    };
+    static_assert(sizeof(SharedMatrixHeader) == SharedMatrixHeader::DataOffset, "SharedMatrixHeader must take 128 bytes!");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The sequence must be lock-free to be shared between processes!");
+
+    // Matrix living in named shared memory, written by the process
+    // which created it and read in place by any process attaching to it.
+    //
+    // Updates are published through a seqlock: the writer never waits
+    // for the readers, and the readers never copy the entries; they run
+    // their computation directly on the shared entries and run it again
+    // if the writer changed them meanwhile
+    template <typename _Ty, int Height, int Width, typename order = StorageOrder::RowMajor>
+    class SharedMatrix
+    {
+        static_assert(std::is_trivially_copyable_v<_Ty>, "Entries of shared matrices must be trivially copyable!");
+
+    public:
+        using MatrixType = Matrix<_Ty, Height, Width, order>;
+
+    private:
+        std::shared_ptr<detail::SharedSegment> pSegment;
+        std::errc error{};
+
+    public:
+        SharedMatrix() = default;
+        // Move-only: a copy of the writer would be a second writer of the seqlock
+        SharedMatrix(const SharedMatrix&) = delete;
+        SharedMatrix& operator=(const SharedMatrix&) = delete;
+        SharedMatrix(SharedMatrix&&) = default;
+        SharedMatrix& operator=(SharedMatrix&&) = default;
+
+        // The writer: a zero matrix in a new segment, removed when the writer
+        // is destroyed (POSIX) or when the last process detaches (Windows).
+        // Names are like "/sensor-fusion" on POSIX systems
+        static SharedMatrix Create(const char* name);
+        // A reader; std::errc::invalid_argument if the segment holds
+        // another kind of matrix, std::errc::resource_unavailable_try_again
+        // if its writer has not finished creating it
+        static SharedMatrix Attach(const char* name);
+
+        inline bool IsOpen() const;
+        inline std::errc GetError() const;
+
+        // Number of updates published so far
+        inline std::uint64_t GetVersion() const;
+
+        // Writer only: `update(MatrixType&)` modifies the entries in place,
+        // then the new version is published
+        template <typename _Fn>
+        void Write(_Fn&& update);
+        void Store(const MatrixType& matrix);
+
+        // Result of `read(const MatrixType&)` computed on a consistent version
+        // of the entries, which are shared, not copied; `read` may also return
+        // void. It may run several times and may see a half-written matrix
+        // on the runs that are thrown away, so it must not rely on invariants
+        // of the entries to be safe
+        template <typename _Fn>
+        auto Read(_Fn&& read, std::uint64_t* version = nullptr) const;
+
+        // Copy of a consistent version
+        MatrixType Load() const;
+
+        // Matrix pointing into the segment, which it keeps mapped;
+        // its entries may change at any time
+        const MatrixType View() const;
+
+    private:
+        inline SharedMatrixHeader& header() const;
+        inline MatrixType view() const;
+    };
+}
+
+
+inline std::errc
+detail::SharedSegment::
+lastError()
+{
+#if defined(_WIN32)
+    const DWORD code{ GetLastError() };
+    if (code == ERROR_FILE_NOT_FOUND)
+        return std::errc::no_such_file_or_directory;
+    if (code == ERROR_ALREADY_EXISTS)
+        return std::errc::file_exists;
+    if (code == ERROR_ACCESS_DENIED)
+        return std::errc::permission_denied;
+    return std::errc::io_error;
+#else
+    return static_cast<std::errc>(errno);
+#endif
+}
+
+inline
+detail::SharedSegment::
+~SharedSegment()
+{
+#if defined(_WIN32)
+    if (address != nullptr)
+        UnmapViewOfFile(address);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+#else
+    if (address != nullptr)
+        ::munmap(address, size);
+    if (isOwner)
+        ::shm_unlink(name.c_str());
+#endif
+}
+
+inline std::errc
+detail::SharedSegment::
+Create(const char* name, const std::size_t size)
+{
+    this->name = name;
+#if defined(_WIN32)
+    const std::uint64_t wide{ size };
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(wide >> 32), static_cast<DWORD>(wide), name);
+    if (mapping == nullptr)
+        return lastError();
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+        return std::errc::file_exists;
+    address = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (address == nullptr)
+        return lastError();
+#else
+    const int descriptor{ ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600) };
+    if (descriptor < 0)
+        return lastError();
+    isOwner = true;
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+    {
+        const std::errc ec{ lastError() };
+        ::close(descriptor);
+        return ec;
+    }
+    void* mapped{ ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) };
+    const std::errc ec{ mapped == MAP_FAILED ? lastError() : std::errc{} };
+    ::close(descriptor);
+    if (mapped == MAP_FAILED)
+        return ec;
+    address = mapped;
+#endif
+    this->size = size;
+    return std::errc{};
+}
+
+inline std::errc
+detail::SharedSegment::
+Attach(const char* name)
+{
+    this->name = name;
+#if defined(_WIN32)
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (mapping == nullptr)
+        return lastError();
+    address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr)
+        return lastError();
+    MEMORY_BASIC_INFORMATION information;
+    if (VirtualQuery(address, &information, sizeof(information)) == 0)
+        return lastError();
+    size = information.RegionSize;
+#else
+    const int descriptor{ ::shm_open(name, O_RDONLY, 0) };
+    if (descriptor < 0)
+        return lastError();
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0)
+    {
+        const std::errc ec{ lastError() };
+        ::close(descriptor);
+        return ec;
+    }
+    const std::size_t length{ static_cast<std::size_t>(status.st_size) };
+    void* mapped{ length > 0 ? ::mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED };
+    const std::errc ec{ length == 0 ? std::errc::resource_unavailable_try_again
+        : mapped == MAP_FAILED ? lastError() : std::errc{} };
+    ::close(descriptor);
+    if (mapped == MAP_FAILED)
+        return ec;
+    address = mapped;
+    size = length;
+#endif
+    return std::errc{};
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+Create(const char* name)
+{
+    static_assert(detail::ElementCodeOf<_Ty>() != ElementCode::Unknown, "Element type cannot be shared!");
+
+    SharedMatrix matrix;
+    auto pSegment{ std::make_shared<detail::SharedSegment>() };
+    matrix.error = pSegment->Create(name, SharedMatrixHeader::DataOffset + sizeof(typename MatrixType::data_t));
+    if (matrix.error != std::errc{})
+        return matrix;
+
+    // the segment starts zeroed
+    SharedMatrixHeader& header{ *new (pSegment->GetAddress()) SharedMatrixHeader() };
+    header.version = SharedMatrixHeader::Version;
+    header.elementCode = detail::ElementCodeOf<_Ty>();
+    header.elementSize = static_cast<std::uint8_t>(sizeof(_Ty));
+    header.height = static_cast<std::uint32_t>(Height);
+    header.width = static_cast<std::uint32_t>(Width);
+    header.order = order::IsRowMajor() ? 0 : 1;
+    header.sequence.store(0, std::memory_order_relaxed);
+    // the magic tells the readers that the header is complete
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header.magic, SharedMatrixHeader::Magic, sizeof(header.magic));
+
+    matrix.pSegment = std::move(pSegment);
+    return matrix;
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+Attach(const char* name)
+{
+    SharedMatrix matrix;
+    auto pSegment{ std::make_shared<detail::SharedSegment>() };
+    matrix.error = pSegment->Attach(name);
+    if (matrix.error != std::errc{})
+        return matrix;
+    if (pSegment->GetSize() < SharedMatrixHeader::DataOffset + sizeof(typename MatrixType::data_t))
+    {
+        matrix.error = std::errc::resource_unavailable_try_again;
+        return matrix;
+    }
+
+    const SharedMatrixHeader& header{ *static_cast<const SharedMatrixHeader*>(pSegment->GetAddress()) };
+    if (std::memcmp(header.magic, SharedMatrixHeader::Magic, sizeof(header.magic)) != 0)
+    {
+        matrix.error = std::errc::resource_unavailable_try_again;
+        return matrix;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header.version != SharedMatrixHeader::Version
+        || header.elementCode != detail::ElementCodeOf<_Ty>() || header.elementSize != sizeof(_Ty)
+        || header.height != static_cast<std::uint32_t>(Height) || header.width != static_cast<std::uint32_t>(Width)
+        || header.order != (order::IsRowMajor() ? 0 : 1))
+    {
+        matrix.error = std::errc::invalid_argument;
+        return matrix;
+    }
+
+    matrix.pSegment = std::move(pSegment);
+    return matrix;
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+inline bool
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+IsOpen() const
+{
+    return pSegment != nullptr;
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+inline std::errc
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+GetError() const
+{
+    return error;
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+inline MatrixMath::SharedMatrixHeader&
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+header() const
+{
+    return *static_cast<SharedMatrixHeader*>(pSegment->GetAddress());
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+inline typename MatrixMath::SharedMatrix<_Ty, Height, Width, order>::MatrixType
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+view() const
+{
+    // std::array holds exactly its elements, so it can overlay the entries
+    using data_t = typename MatrixType::data_t;
+    data_t* const pEntries{ reinterpret_cast<data_t*>(
+        static_cast<char*>(pSegment->GetAddress()) + SharedMatrixHeader::DataOffset) };
+    return MatrixType(typename MatrixType::data_ptr_t(pSegment, pEntries), false);
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+inline std::uint64_t
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+GetVersion() const
+{
+    return this->header().sequence.load(std::memory_order_acquire) / 2;
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+template <typename _Fn>
+void
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+Write(_Fn&& update)
+{
+    std::atomic<std::uint64_t>& sequence{ this->header().sequence };
+    const std::uint64_t current{ sequence.load(std::memory_order_relaxed) };
+
+    // odd: the readers started from now on will retry
+    sequence.store(current + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    MatrixType entries{ this->view() };
+    update(entries);
+
+    sequence.store(current + 2, std::memory_order_release);
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+void
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+Store(const MatrixType& matrix)
+{
+    this->Write([&matrix](MatrixType& entries) {
+        for (int row = 0; row < Height; row++)
+            for (int column = 0; column < Width; column++)
+                entries.SetElement(row, column, matrix.GetElement(row, column));
+    });
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+template <typename _Fn>
+auto
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+Read(_Fn&& read, std::uint64_t* version) const
+{
+    const std::atomic<std::uint64_t>& sequence{ this->header().sequence };
+    const MatrixType entries{ this->view() };
+
+    for (int attempt = 0; ; attempt++)
+    {
+        const std::uint64_t before{ sequence.load(std::memory_order_acquire) };
+        if (before % 2 == 0)
+        {
+            const auto isConsistent{ [&sequence, before, version]() {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) != before)
+                    return false;
+                if (version != nullptr)
+                    *version = before / 2;
+                return true;
+            } };
+
+            if constexpr (std::is_void_v<std::invoke_result_t<_Fn&, const MatrixType&>>)
+            {
+                read(entries);
+                if (isConsistent())
+                    return;
+            }
+            else
+            {
+                auto result{ read(entries) };
+                if (isConsistent())
+                    return result;
+            }
+        }
+        // the writer is busy, most likely on another core
+        if (attempt >= 16)
+            std::this_thread::yield();
+    }
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+typename MatrixMath::SharedMatrix<_Ty, Height, Width, order>::MatrixType
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+Load() const
+{
+    using data_t = typename MatrixType::data_t;
+    const data_t data{ this->Read([](const MatrixType& entries) { return entries.GetData(); }) };
+
+    MatrixType matrix;
+    matrix.GetData() = data;
+    return matrix;
+}
+
+template <typename _Ty, int Height, int Width, typename order>
+const typename MatrixMath::SharedMatrix<_Ty, Height, Width, order>::MatrixType
+MatrixMath::SharedMatrix<_Ty, Height, Width, order>::
+View() const
+{
+    return this->view();
+}
@@ -0,0 +1,705 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include "Binary.h"
+#include "DynamicMatrix.h"
+#include "Kernel.h"
+
+namespace detail
+{
+    // File read and written at explicit offsets (pread / pwrite),
+    // so that several threads may use it at the same time
+    class RandomAccessFile
+    {
+    private:
+#if defined(_WIN32)
+        HANDLE file{ INVALID_HANDLE_VALUE };
+#else
+        int descriptor{ -1 };
+#endif
+
+    public:
+        RandomAccessFile() = default;
+        RandomAccessFile(const RandomAccessFile&) = delete;
+        RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+        ~RandomAccessFile() { this->Close(); }
+
+        // `create` truncates the file
+        inline std::errc Open(const char* path, const bool create);
+        inline void Close();
+        inline std::errc Resize(const std::uint64_t size);
+        inline std::errc Read(const std::uint64_t offset, void* data, std::size_t size) const;
+        inline std::errc Write(const std::uint64_t offset, const void* data, std::size_t size) const;
+        // Whether both refer to the same file, even through different paths
+        inline bool IsSameFile(const RandomAccessFile& other) const;
+
+    private:
+        inline static std::errc lastError();
+    };
+}
+
+namespace MatrixMath
+{
+    // Matrix stored in a file as square tiles, for matrices larger than
+    // the memory: only the tiles being worked on are ever loaded.
+    //
+    // The file holds a 64-byte header, then the tiles from offset 4096,
+    // row of tiles after row of tiles, every tile being (TileSize x TileSize)
+    // entries stored row by row; the tiles on the right and bottom edges
+    // are padded with zeros
+    template <typename _Ty>
+    class TiledMatrix
+    {
+    public:
+        using ElementType = _Ty;
+
+        struct Header
+        {
+            constexpr static char Magic[4]{ 'M', 'T', 'R', 'T' };
+            constexpr static std::uint16_t Version{ 1 };
+            constexpr static std::uint64_t DataOffset{ 4096 };
+
+            char magic[4];
+            std::uint16_t version;
+            std::uint16_t byteOrder;
+            ElementCode elementCode;
+            std::uint8_t elementSize;
+            std::uint16_t reserved0;
+            std::uint32_t tileSize;
+            std::uint32_t height;
+            std::uint32_t width;
+            std::uint8_t reserved1[40];
+        };
+        static_assert(sizeof(Header) == 64, "TiledMatrix::Header must be packed into 64 bytes!");
+
+    private:
+        std::unique_ptr<detail::RandomAccessFile> pFile;
+        int height{ 0 };
+        int width{ 0 };
+        int tileSize{ 0 };
+
+    public:
+        TiledMatrix() = default;
+        TiledMatrix(TiledMatrix&&) = default;
+        TiledMatrix& operator=(TiledMatrix&&) = default;
+
+        // Zero matrix in a new file
+        static TiledMatrix Create(const char* path, const int height, const int width, const int tileSize,
+            std::errc& ec);
+        // Matrix of a file written by `Create`
+        static TiledMatrix Open(const char* path, std::errc& ec);
+
+        inline bool IsOpen() const;
+        // Whether both are open on the same file, e.g. opened twice
+        inline bool SharesFileWith(const TiledMatrix& other) const;
+        inline int GetHeight() const;
+        inline int GetWidth() const;
+        inline int GetTileSize() const;
+        inline int GetTileRows() const;
+        inline int GetTileColumns() const;
+        inline std::size_t GetTileBytes() const;
+
+        // (TileSize x TileSize) entries, row by row
+        std::errc ReadTile(const int tileRow, const int tileColumn, _Ty* tile) const;
+        std::errc WriteTile(const int tileRow, const int tileColumn, const _Ty* tile) const;
+
+        // Copy a matrix held in memory into the tiles, and back
+        template <typename order>
+        std::errc Store(const DynamicMatrix<_Ty, order>& matrix) const;
+        template <typename order>
+        std::errc Load(DynamicMatrix<_Ty, order>& matrix) const;
+
+    private:
+        inline std::uint64_t offset(const int tileRow, const int tileColumn) const;
+    };
+
+    struct OutOfCoreOptions
+    {
+        // Upper bound of the memory taken by the tiles held at once
+        std::size_t memoryBudget{ std::size_t{ 256 } << 20 };
+        // Load the next tiles on another thread while computing
+        bool prefetch{ true };
+    };
+
+    struct OutOfCoreResult
+    {
+        // - std::errc::invalid_argument: dimensions or tile sizes do not match,
+        //   an operand is not open, or the result shares the file of an operand
+        // - std::errc::not_enough_memory: the budget cannot hold the tiles needed
+        // - errors of the file system
+        std::errc ec{};
+        std::uint64_t bytesRead{ 0 };
+        std::uint64_t bytesWritten{ 0 };
+        // memory taken by the tiles, never above the budget
+        std::size_t residentBytes{ 0 };
+
+        inline explicit operator bool() const { return ec == std::errc{}; }
+    };
+
+    // result = lhs * rhs, the three of them having the same tile size,
+    // the result in a file of its own, as it is written while lhs and rhs are read.
+    // The result is computed by squares of (b x b) tiles held in memory,
+    // b being as large as the budget allows; each square reads one row
+    // of tiles of `lhs` and one column of tiles of `rhs`, step by step,
+    // the tiles of the next step being loaded during the current one
+    template <typename _Ty>
+    OutOfCoreResult Multiply(const TiledMatrix<_Ty>& lhs, const TiledMatrix<_Ty>& rhs, const TiledMatrix<_Ty>& result,
+        const OutOfCoreOptions& options = {});
+
+    // result = matrix^T, both of them having the same tile size,
+    // in files of their own
+    template <typename _Ty>
+    OutOfCoreResult Transpose(const TiledMatrix<_Ty>& matrix, const TiledMatrix<_Ty>& result,
+        const OutOfCoreOptions& options = {});
+}
+
+
+inline std::errc
+detail::RandomAccessFile::
+lastError()
+{
+#if defined(_WIN32)
+    const DWORD code{ GetLastError() };
+    if (code == ERROR_FILE_NOT_FOUND || code == ERROR_PATH_NOT_FOUND)
+        return std::errc::no_such_file_or_directory;
+    if (code == ERROR_DISK_FULL || code == ERROR_HANDLE_DISK_FULL)
+        return std::errc::no_space_on_device;
+    return std::errc::io_error;
+#else
+    return static_cast<std::errc>(errno);
+#endif
+}
+
+inline std::errc
+detail::RandomAccessFile::
+Open(const char* path, const bool create)
+{
+    this->Close();
+#if defined(_WIN32)
+    file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return lastError();
+#else
+    descriptor = ::open(path, create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+    if (descriptor < 0)
+        return lastError();
+#endif
+    return std::errc{};
+}
+
+inline void
+detail::RandomAccessFile::
+Close()
+{
+#if defined(_WIN32)
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (descriptor >= 0)
+        ::close(descriptor);
+    descriptor = -1;
+#endif
+}
+
+inline std::errc
+detail::RandomAccessFile::
+Resize(const std::uint64_t size)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+        return lastError();
+#else
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+        return lastError();
+#endif
+    return std::errc{};
+}
+
+inline std::errc
+detail::RandomAccessFile::
+Read(std::uint64_t offset, void* data, std::size_t size) const
+{
+    char* bytes{ static_cast<char*>(data) };
+    while (size > 0)
+    {
+#if defined(_WIN32)
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD count{ 0 };
+        const DWORD request{ static_cast<DWORD>(std::min<std::size_t>(size, 1u << 30)) };
+        if (!ReadFile(file, bytes, request, &count, &overlapped) && GetLastError() != ERROR_HANDLE_EOF)
+            return lastError();
+#else
+        const ssize_t count{ ::pread(descriptor, bytes, size, static_cast<off_t>(offset)) };
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return lastError();
+        }
+#endif
+        // beyond the end of the file
+        if (count == 0)
+        {
+            std::memset(bytes, 0, size);
+            break;
+        }
+        bytes += count;
+        offset += static_cast<std::uint64_t>(count);
+        size -= static_cast<std::size_t>(count);
+    }
+    return std::errc{};
+}
+
+inline std::errc
+detail::RandomAccessFile::
+Write(std::uint64_t offset, const void* data, std::size_t size) const
+{
+    const char* bytes{ static_cast<const char*>(data) };
+    while (size > 0)
+    {
+#if defined(_WIN32)
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD count{ 0 };
+        const DWORD request{ static_cast<DWORD>(std::min<std::size_t>(size, 1u << 30)) };
+        if (!WriteFile(file, bytes, request, &count, &overlapped))
+            return lastError();
+#else
+        const ssize_t count{ ::pwrite(descriptor, bytes, size, static_cast<off_t>(offset)) };
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return lastError();
+        }
+#endif
+        bytes += count;
+        offset += static_cast<std::uint64_t>(count);
+        size -= static_cast<std::size_t>(count);
+    }
+    return std::errc{};
+}
+
+inline bool
+detail::RandomAccessFile::
+IsSameFile(const RandomAccessFile& other) const
+{
+#if defined(_WIN32)
+    BY_HANDLE_FILE_INFORMATION lhs;
+    BY_HANDLE_FILE_INFORMATION rhs;
+    return GetFileInformationByHandle(file, &lhs) && GetFileInformationByHandle(other.file, &rhs)
+        && lhs.dwVolumeSerialNumber == rhs.dwVolumeSerialNumber
+        && lhs.nFileIndexHigh == rhs.nFileIndexHigh && lhs.nFileIndexLow == rhs.nFileIndexLow;
+#else
+    struct stat lhs;
+    struct stat rhs;
+    return ::fstat(descriptor, &lhs) == 0 && ::fstat(other.descriptor, &rhs) == 0
+        && lhs.st_dev == rhs.st_dev && lhs.st_ino == rhs.st_ino;
+#endif
+}
+
+template <typename _Ty>
+MatrixMath::TiledMatrix<_Ty>
+MatrixMath::TiledMatrix<_Ty>::
+Create(const char* path, const int height, const int width, const int tileSize, std::errc& ec)
+{
+    static_assert(detail::ElementCodeOf<_Ty>() != ElementCode::Unknown, "Element type cannot be stored in files!");
+
+    TiledMatrix matrix;
+    if (height <= 0 || width <= 0 || tileSize <= 0)
+    {
+        ec = std::errc::invalid_argument;
+        return matrix;
+    }
+    matrix.pFile = std::make_unique<detail::RandomAccessFile>();
+    matrix.height = height;
+    matrix.width = width;
+    matrix.tileSize = tileSize;
+
+    Header header{};
+    std::memcpy(header.magic, Header::Magic, sizeof(header.magic));
+    header.version = Header::Version;
+    header.byteOrder = BinaryHeader::ByteOrderMark;
+    header.elementCode = detail::ElementCodeOf<_Ty>();
+    header.elementSize = static_cast<std::uint8_t>(sizeof(_Ty));
+    header.tileSize = static_cast<std::uint32_t>(tileSize);
+    header.height = static_cast<std::uint32_t>(height);
+    header.width = static_cast<std::uint32_t>(width);
+
+    // the tiles never written are read as zeros
+    // from the holes of the file, which take no disk space
+    ec = matrix.pFile->Open(path, true);
+    if (ec == std::errc{})
+        ec = matrix.pFile->Write(0, &header, sizeof(header));
+    if (ec == std::errc{})
+        ec = matrix.pFile->Resize(matrix.offset(matrix.GetTileRows(), 0));
+    if (ec != std::errc{})
+        matrix.pFile.reset();
+    return matrix;
+}
+
+template <typename _Ty>
+MatrixMath::TiledMatrix<_Ty>
+MatrixMath::TiledMatrix<_Ty>::
+Open(const char* path, std::errc& ec)
+{
+    TiledMatrix matrix;
+    matrix.pFile = std::make_unique<detail::RandomAccessFile>();
+
+    Header header{};
+    ec = matrix.pFile->Open(path, false);
+    if (ec == std::errc{})
+        ec = matrix.pFile->Read(0, &header, sizeof(header));
+    if (ec == std::errc{}
+        && (std::memcmp(header.magic, Header::Magic, sizeof(header.magic)) != 0
+            || header.byteOrder != BinaryHeader::ByteOrderMark
+            || header.elementCode != detail::ElementCodeOf<_Ty>() || header.elementSize != sizeof(_Ty)
+            || header.tileSize == 0 || header.height == 0 || header.width == 0))
+        ec = std::errc::illegal_byte_sequence;
+    if (ec == std::errc{} && header.version != Header::Version)
+        ec = std::errc::not_supported;
+    if (ec != std::errc{})
+    {
+        matrix.pFile.reset();
+        return matrix;
+    }
+
+    matrix.height = static_cast<int>(header.height);
+    matrix.width = static_cast<int>(header.width);
+    matrix.tileSize = static_cast<int>(header.tileSize);
+    return matrix;
+}
+
+template <typename _Ty>
+inline bool
+MatrixMath::TiledMatrix<_Ty>::
+IsOpen() const
+{
+    return pFile != nullptr;
+}
+
+template <typename _Ty>
+inline bool
+MatrixMath::TiledMatrix<_Ty>::
+SharesFileWith(const TiledMatrix& other) const
+{
+    return this->IsOpen() && other.IsOpen() && pFile->IsSameFile(*other.pFile);
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::TiledMatrix<_Ty>::
+GetHeight() const
+{
+    return height;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::TiledMatrix<_Ty>::
+GetWidth() const
+{
+    return width;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::TiledMatrix<_Ty>::
+GetTileSize() const
+{
+    return tileSize;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::TiledMatrix<_Ty>::
+GetTileRows() const
+{
+    return (height + tileSize - 1) / tileSize;
+}
+
+template <typename _Ty>
+inline int
+MatrixMath::TiledMatrix<_Ty>::
+GetTileColumns() const
+{
+    return (width + tileSize - 1) / tileSize;
+}
+
+template <typename _Ty>
+inline std::size_t
+MatrixMath::TiledMatrix<_Ty>::
+GetTileBytes() const
+{
+    return static_cast<std::size_t>(tileSize) * tileSize * sizeof(_Ty);
+}
+
+template <typename _Ty>
+inline std::uint64_t
+MatrixMath::TiledMatrix<_Ty>::
+offset(const int tileRow, const int tileColumn) const
+{
+    const std::uint64_t index{ static_cast<std::uint64_t>(tileRow) * this->GetTileColumns() + tileColumn };
+    return Header::DataOffset + index * this->GetTileBytes();
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::TiledMatrix<_Ty>::
+ReadTile(const int tileRow, const int tileColumn, _Ty* tile) const
+{
+    return pFile->Read(this->offset(tileRow, tileColumn), tile, this->GetTileBytes());
+}
+
+template <typename _Ty>
+std::errc
+MatrixMath::TiledMatrix<_Ty>::
+WriteTile(const int tileRow, const int tileColumn, const _Ty* tile) const
+{
+    return pFile->Write(this->offset(tileRow, tileColumn), tile, this->GetTileBytes());
+}
+
+template <typename _Ty>
+template <typename order>
+std::errc
+MatrixMath::TiledMatrix<_Ty>::
+Store(const DynamicMatrix<_Ty, order>& matrix) const
+{
+    if (matrix.GetHeight() != height || matrix.GetWidth() != width)
+        return std::errc::invalid_argument;
+
+    std::vector<_Ty> tile(static_cast<std::size_t>(tileSize) * tileSize);
+    for (int tileRow = 0; tileRow < this->GetTileRows(); tileRow++)
+    {
+        for (int tileColumn = 0; tileColumn < this->GetTileColumns(); tileColumn++)
+        {
+            std::fill(tile.begin(), tile.end(), _Ty{});
+            const int rows{ std::min(tileSize, height - tileRow * tileSize) };
+            const int columns{ std::min(tileSize, width - tileColumn * tileSize) };
+            for (int row = 0; row < rows; row++)
+                for (int column = 0; column < columns; column++)
+                    tile[row * tileSize + column] = matrix.GetElement(tileRow * tileSize + row, tileColumn * tileSize + column);
+            if (const std::errc ec{ this->WriteTile(tileRow, tileColumn, tile.data()) }; ec != std::errc{})
+                return ec;
+        }
+    }
+    return std::errc{};
+}
+
+template <typename _Ty>
+template <typename order>
+std::errc
+MatrixMath::TiledMatrix<_Ty>::
+Load(DynamicMatrix<_Ty, order>& matrix) const
+{
+    matrix.Resize(height, width);
+
+    std::vector<_Ty> tile(static_cast<std::size_t>(tileSize) * tileSize);
+    for (int tileRow = 0; tileRow < this->GetTileRows(); tileRow++)
+    {
+        for (int tileColumn = 0; tileColumn < this->GetTileColumns(); tileColumn++)
+        {
+            if (const std::errc ec{ this->ReadTile(tileRow, tileColumn, tile.data()) }; ec != std::errc{})
+                return ec;
+            const int rows{ std::min(tileSize, height - tileRow * tileSize) };
+            const int columns{ std::min(tileSize, width - tileColumn * tileSize) };
+            for (int row = 0; row < rows; row++)
+                for (int column = 0; column < columns; column++)
+                    matrix.SetElement(tileRow * tileSize + row, tileColumn * tileSize + column, tile[row * tileSize + column]);
+        }
+    }
+    return std::errc{};
+}
+
+namespace detail
+{
+    // Run `load(buffer)` for step 0, then for every step: wait for its tiles,
+    // start loading those of the next step into the other buffer,
+    // and run `compute(buffer)` meanwhile
+    template <typename _Buffer, typename _Load, typename _Compute>
+    std::errc DoubleBuffered(const int steps, _Buffer (&buffers)[2], const bool prefetch,
+        _Load&& load, _Compute&& compute)
+    {
+        if (steps <= 0)
+            return std::errc{};
+
+        std::future<std::errc> pending;
+        std::errc ec{ load(0, buffers[0]) };
+        for (int step = 0; step < steps && ec == std::errc{}; step++)
+        {
+            _Buffer& current{ buffers[step % 2] };
+            _Buffer& next{ buffers[(step + 1) % 2] };
+            const bool hasNext{ step + 1 < steps };
+
+            if (hasNext && prefetch)
+                pending = std::async(std::launch::async, [&load, &next, step]() { return load(step + 1, next); });
+            ec = compute(step, current);
+            if (hasNext)
+            {
+                const std::errc loaded{ prefetch ? pending.get() : load(step + 1, next) };
+                if (ec == std::errc{})
+                    ec = loaded;
+            }
+        }
+        return ec;
+    }
+}
+
+template <typename _Ty>
+MatrixMath::OutOfCoreResult
+MatrixMath::
+Multiply(const TiledMatrix<_Ty>& lhs, const TiledMatrix<_Ty>& rhs, const TiledMatrix<_Ty>& result,
+    const OutOfCoreOptions& options)
+{
+    OutOfCoreResult status;
+    const int T{ lhs.GetTileSize() };
+    // the tiles of the result would overwrite those still to be read
+    if (!lhs.IsOpen() || !rhs.IsOpen() || !result.IsOpen()
+        || result.SharesFileWith(lhs) || result.SharesFileWith(rhs)
+        || lhs.GetWidth() != rhs.GetHeight() || result.GetHeight() != lhs.GetHeight() || result.GetWidth() != rhs.GetWidth()
+        || rhs.GetTileSize() != T || result.GetTileSize() != T)
+    {
+        status.ec = std::errc::invalid_argument;
+        return status;
+    }
+
+    // b * b tiles of the result, plus twice (for the prefetch) b tiles of both operands
+    const std::size_t tileBytes{ lhs.GetTileBytes() };
+    const std::size_t budget{ options.memoryBudget / tileBytes };
+    int b{ 0 };
+    while (static_cast<std::size_t>(b + 1) * (b + 1) + 4 * static_cast<std::size_t>(b + 1) <= budget
+        && (b < result.GetTileRows() || b < result.GetTileColumns()))
+        b++;
+    if (b == 0)
+    {
+        status.ec = std::errc::not_enough_memory;
+        return status;
+    }
+    const int squareRows{ std::min(b, result.GetTileRows()) };
+    const int squareColumns{ std::min(b, result.GetTileColumns()) };
+    const std::size_t tileEntries{ static_cast<std::size_t>(T) * T };
+
+    struct Panels
+    {
+        std::vector<_Ty> lhs;
+        std::vector<_Ty> rhs;
+    };
+    Panels panels[2];
+    for (auto& panel : panels)
+    {
+        panel.lhs.resize(squareRows * tileEntries);
+        panel.rhs.resize(squareColumns * tileEntries);
+    }
+    std::vector<_Ty> square(static_cast<std::size_t>(squareRows) * squareColumns * tileEntries);
+    status.residentBytes = (square.size() + 2 * (panels[0].lhs.size() + panels[0].rhs.size())) * sizeof(_Ty);
+
+    const int steps{ lhs.GetTileColumns() };
+    for (int firstRow = 0; firstRow < result.GetTileRows() && status; firstRow += squareRows)
+    {
+        for (int firstColumn = 0; firstColumn < result.GetTileColumns() && status; firstColumn += squareColumns)
+        {
+            const int rows{ std::min(squareRows, result.GetTileRows() - firstRow) };
+            const int columns{ std::min(squareColumns, result.GetTileColumns() - firstColumn) };
+            std::fill(square.begin(), square.end(), _Ty{});
+
+            // tiles (firstRow + i, step) of lhs and (step, firstColumn + j) of rhs
+            auto load = [&](const int step, Panels& panel) {
+                for (int i = 0; i < rows; i++)
+                    if (const std::errc ec{ lhs.ReadTile(firstRow + i, step, panel.lhs.data() + i * tileEntries) }; ec != std::errc{})
+                        return ec;
+                for (int j = 0; j < columns; j++)
+                    if (const std::errc ec{ rhs.ReadTile(step, firstColumn + j, panel.rhs.data() + j * tileEntries) }; ec != std::errc{})
+                        return ec;
+                return std::errc{};
+            };
+            auto compute = [&](const int, const Panels& panel) {
+                for (int i = 0; i < rows; i++)
+                    for (int j = 0; j < columns; j++)
+                        detail::MultiplyAddBlock(panel.lhs.data() + i * tileEntries, T,
+                            panel.rhs.data() + j * tileEntries, T,
+                            square.data() + (i * columns + j) * tileEntries, T, T, T, T);
+                return std::errc{};
+            };
+            status.ec = detail::DoubleBuffered(steps, panels, options.prefetch, load, compute);
+            status.bytesRead += static_cast<std::uint64_t>(steps) * (rows + columns) * tileBytes;
+
+            for (int i = 0; i < rows && status; i++)
+                for (int j = 0; j < columns && status; j++)
+                    status.ec = result.WriteTile(firstRow + i, firstColumn + j, square.data() + (i * columns + j) * tileEntries);
+            status.bytesWritten += static_cast<std::uint64_t>(rows) * columns * tileBytes;
+        }
+    }
+    return status;
+}
+
+template <typename _Ty>
+MatrixMath::OutOfCoreResult
+MatrixMath::
+Transpose(const TiledMatrix<_Ty>& matrix, const TiledMatrix<_Ty>& result, const OutOfCoreOptions& options)
+{
+    OutOfCoreResult status;
+    const int T{ matrix.GetTileSize() };
+    if (!matrix.IsOpen() || !result.IsOpen() || result.SharesFileWith(matrix)
+        || result.GetHeight() != matrix.GetWidth() || result.GetWidth() != matrix.GetHeight() || result.GetTileSize() != T)
+    {
+        status.ec = std::errc::invalid_argument;
+        return status;
+    }
+
+    // two tiles being read, one being written
+    const std::size_t tileBytes{ matrix.GetTileBytes() };
+    if (options.memoryBudget < 3 * tileBytes)
+    {
+        status.ec = std::errc::not_enough_memory;
+        return status;
+    }
+    const std::size_t tileEntries{ static_cast<std::size_t>(T) * T };
+    std::vector<_Ty> tiles[2]{ std::vector<_Ty>(tileEntries), std::vector<_Ty>(tileEntries) };
+    std::vector<_Ty> transposed(tileEntries);
+    status.residentBytes = 3 * tileBytes;
+
+    const int columns{ matrix.GetTileColumns() };
+    const int steps{ matrix.GetTileRows() * columns };
+    status.ec = detail::DoubleBuffered(steps, tiles, options.prefetch,
+        [&](const int step, std::vector<_Ty>& tile) {
+            return matrix.ReadTile(step / columns, step % columns, tile.data());
+        },
+        [&](const int step, const std::vector<_Ty>& tile) {
+            detail::TransposeBlock(tile.data(), T, transposed.data(), T, T, T);
+            return result.WriteTile(step % columns, step / columns, transposed.data());
+        });
+    status.bytesRead = static_cast<std::uint64_t>(steps) * tileBytes;
+    status.bytesWritten = static_cast<std::uint64_t>(steps) * tileBytes;
+    return status;
+}
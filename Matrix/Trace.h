@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Define MATRIX_TRACE (e.g. -DMATRIX_TRACE=1) to time the library operations:
+// every MATRIX_TRACE_SCOPE counts its calls, elapsed time, FLOPs and bytes
+// touched, and records a span for the Chrome trace. Otherwise the scopes
+// expand to nothing, and their arguments are not even evaluated
+#if !defined(MATRIX_TRACE)
+#   define MATRIX_TRACE 0
+#endif
+
+#define MATRIX_TRACE_CONCAT_(a, b) a##b
+#define MATRIX_TRACE_CONCAT(a, b) MATRIX_TRACE_CONCAT_(a, b)
+
+#if MATRIX_TRACE
+// Time the rest of the enclosing block as the operation `name`,
+// a string literal, doing `flops` operations on `bytes` bytes
+#   define MATRIX_TRACE_SCOPE(name, flops, bytes) \
+        static const int MATRIX_TRACE_CONCAT(matrixTraceId, __LINE__){ ::detail::RegisterTraceOperation(name) }; \
+        const ::detail::TraceScope MATRIX_TRACE_CONCAT(matrixTraceScope, __LINE__){ \
+            MATRIX_TRACE_CONCAT(matrixTraceId, __LINE__), static_cast<std::uint64_t>(flops), static_cast<std::uint64_t>(bytes) }
+#else
+#   define MATRIX_TRACE_SCOPE(name, flops, bytes) static_cast<void>(0)
+#endif
+
+namespace MatrixMath
+{
+    // Totals of one operation; the time of nested operations
+    // is included in the time of the enclosing ones
+    struct OperationStats
+    {
+        std::string name;
+        std::uint64_t calls{ 0 };
+        std::uint64_t nanoseconds{ 0 };
+        std::uint64_t flops{ 0 };
+        std::uint64_t bytes{ 0 };
+    };
+
+    constexpr bool IsTraced{ MATRIX_TRACE != 0 };
+
+    // The operations called so far on any thread, by decreasing time;
+    // empty if not traced
+    std::vector<OperationStats> SnapshotOperations();
+    // One line per operation: calls, time, GFLOP/s and GB/s
+    std::string FormatTraceSummary();
+    // The spans recorded so far, in the trace event format of chrome://tracing
+    // and Perfetto; each thread keeps its first `SetTraceCapacity` spans
+    void WriteChromeTrace(std::ostream& stream);
+    void SetTraceCapacity(const std::size_t spansPerThread);
+    // Forget the spans and the totals; the threads must not be tracing meanwhile
+    void ResetTrace();
+}
+
+namespace detail
+{
+#if MATRIX_TRACE
+    // operations beyond this share the last totals, named "(other)"
+    constexpr int MaxTracedOperations{ 256 };
+    constexpr std::size_t TraceChunkSize{ 4096 };
+
+    struct TraceSpan
+    {
+        int operation;
+        // since the start of the trace
+        std::uint64_t start;
+        std::uint64_t duration;
+    };
+
+    // Spans are appended by their thread, then published by `count`,
+    // so that they can be exported while the thread keeps tracing
+    struct TraceChunk
+    {
+        std::array<TraceSpan, TraceChunkSize> spans;
+        std::atomic<std::size_t> count{ 0 };
+        std::atomic<TraceChunk*> pNext{ nullptr };
+    };
+
+    struct TraceThread
+    {
+        int id;
+        // calls, nanoseconds, flops, bytes; written by the thread only
+        std::array<std::array<std::atomic<std::uint64_t>, 4>, MaxTracedOperations> totals{};
+        TraceChunk first;
+        TraceChunk* pLast{ &first };
+        std::size_t recorded{ 0 };
+        std::atomic<bool> isExited{ false };
+
+        ~TraceThread()
+        {
+            for (TraceChunk* pChunk = first.pNext.load(); pChunk != nullptr;)
+            {
+                TraceChunk* pNext{ pChunk->pNext.load() };
+                delete pChunk;
+                pChunk = pNext;
+            }
+        }
+    };
+
+    // Never destroyed, so that the operations at exit can still be traced;
+    // the buffers of the exited threads are kept for the export
+    struct TraceRegistry
+    {
+        std::mutex mutex;
+        std::vector<std::string> operations;
+        std::vector<TraceThread*> threads;
+        std::atomic<std::size_t> capacity{ std::size_t{ 1 } << 20 };
+        const std::chrono::steady_clock::time_point epoch{ std::chrono::steady_clock::now() };
+        int nextThread{ 1 };
+
+        static TraceRegistry& Get()
+        {
+            static TraceRegistry* pRegistry{ new TraceRegistry };
+            return *pRegistry;
+        }
+    };
+
+    inline int RegisterTraceOperation(const char* name)
+    {
+        TraceRegistry& registry{ TraceRegistry::Get() };
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (int id = 0; id < static_cast<int>(registry.operations.size()); id++)
+            if (registry.operations[id] == name)
+                return id;
+        if (static_cast<int>(registry.operations.size()) == MaxTracedOperations - 1)
+            registry.operations.push_back("(other)");
+        if (static_cast<int>(registry.operations.size()) == MaxTracedOperations)
+            return MaxTracedOperations - 1;
+        registry.operations.push_back(name);
+        return static_cast<int>(registry.operations.size()) - 1;
+    }
+
+    inline thread_local TraceThread* pTraceThread{ nullptr };
+
+    // Marks the buffers of this thread as exited when it exits
+    class TraceThreadOwner
+    {
+    private:
+        TraceThread* pThread{ nullptr };
+        bool isExited{ false };
+
+    public:
+        ~TraceThreadOwner()
+        {
+            if (pThread != nullptr)
+                pThread->isExited.store(true);
+            pTraceThread = nullptr;
+            isExited = true;
+        }
+
+        // nullptr once the thread is exiting
+        TraceThread* Get()
+        {
+            if (pThread == nullptr && !isExited)
+            {
+                pThread = new TraceThread;
+                TraceRegistry& registry{ TraceRegistry::Get() };
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                pThread->id = registry.nextThread++;
+                registry.threads.push_back(pThread);
+            }
+            return pTraceThread = pThread;
+        }
+    };
+
+    inline TraceThread* AttachTraceThread()
+    {
+        thread_local TraceThreadOwner owner;
+        return owner.Get();
+    }
+
+    inline std::uint64_t TraceClock()
+    {
+        static const std::chrono::steady_clock::time_point epoch{ TraceRegistry::Get().epoch };
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    class TraceScope
+    {
+    private:
+        int operation;
+        std::uint64_t flops;
+        std::uint64_t bytes;
+        std::uint64_t start;
+
+        static void add(std::atomic<std::uint64_t>& counter, const std::uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+    public:
+        TraceScope(const int operation, const std::uint64_t flops, const std::uint64_t bytes)
+            : operation{ operation }
+            , flops{ flops }
+            , bytes{ bytes }
+            , start{ TraceClock() }
+        {
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+        ~TraceScope()
+        {
+            const std::uint64_t duration{ TraceClock() - start };
+            TraceThread* pThread{ pTraceThread };
+            if (pThread == nullptr && (pThread = AttachTraceThread()) == nullptr)
+                return;
+
+            auto& totals{ pThread->totals[operation] };
+            add(totals[0], 1);
+            add(totals[1], duration);
+            add(totals[2], flops);
+            add(totals[3], bytes);
+
+            if (pThread->recorded >= TraceRegistry::Get().capacity.load(std::memory_order_relaxed))
+                return;
+            TraceChunk* pChunk{ pThread->pLast };
+            std::size_t count{ pChunk->count.load(std::memory_order_relaxed) };
+            if (count == TraceChunkSize)
+            {
+                TraceChunk* pFresh{ new TraceChunk };
+                pChunk->pNext.store(pFresh, std::memory_order_release);
+                pThread->pLast = pChunk = pFresh;
+                count = 0;
+            }
+            pChunk->spans[count] = { operation, start, duration };
+            pChunk->count.store(count + 1, std::memory_order_release);
+            pThread->recorded++;
+        }
+    };
+#endif
+}
+
+
+inline std::vector<MatrixMath::OperationStats>
+MatrixMath::
+SnapshotOperations()
+{
+    std::vector<OperationStats> result;
+#if MATRIX_TRACE
+    detail::TraceRegistry& registry{ detail::TraceRegistry::Get() };
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int operation = 0; operation < static_cast<int>(registry.operations.size()); operation++)
+    {
+        OperationStats stats;
+        stats.name = registry.operations[operation];
+        for (const detail::TraceThread* pThread : registry.threads)
+        {
+            const auto& totals{ pThread->totals[operation] };
+            stats.calls += totals[0].load(std::memory_order_relaxed);
+            stats.nanoseconds += totals[1].load(std::memory_order_relaxed);
+            stats.flops += totals[2].load(std::memory_order_relaxed);
+            stats.bytes += totals[3].load(std::memory_order_relaxed);
+        }
+        if (stats.calls > 0)
+            result.push_back(std::move(stats));
+    }
+    std::sort(result.begin(), result.end(), [](const OperationStats& lhs, const OperationStats& rhs) {
+        return lhs.nanoseconds > rhs.nanoseconds;
+    });
+#endif
+    return result;
+}
+
+inline std::string
+MatrixMath::
+FormatTraceSummary()
+{
+    std::string result;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-24s %12s %14s %12s %10s %10s\n",
+        "operation", "calls", "total [us]", "mean [ns]", "GFLOP/s", "GB/s");
+    result += line;
+    for (const OperationStats& stats : SnapshotOperations())
+    {
+        const double nanoseconds{ static_cast<double>(std::max<std::uint64_t>(stats.nanoseconds, 1)) };
+        std::snprintf(line, sizeof(line), "%-24s %12llu %14.1f %12.1f %10.3f %10.3f\n",
+            stats.name.c_str(), static_cast<unsigned long long>(stats.calls), nanoseconds / 1e3,
+            nanoseconds / static_cast<double>(stats.calls), stats.flops / nanoseconds, stats.bytes / nanoseconds);
+        result += line;
+    }
+    return result;
+}
+
+inline void
+MatrixMath::
+WriteChromeTrace(std::ostream& stream)
+{
+    stream << "{\"traceEvents\":[";
+#if MATRIX_TRACE
+    detail::TraceRegistry& registry{ detail::TraceRegistry::Get() };
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    bool isFirst{ true };
+    char event[256];
+    for (const detail::TraceThread* pThread : registry.threads)
+    {
+        for (const detail::TraceChunk* pChunk = &pThread->first; pChunk != nullptr;
+            pChunk = pChunk->pNext.load(std::memory_order_acquire))
+        {
+            const std::size_t count{ pChunk->count.load(std::memory_order_acquire) };
+            for (std::size_t index = 0; index < count; index++)
+            {
+                const detail::TraceSpan& span{ pChunk->spans[index] };
+                // complete events, in microseconds
+                std::snprintf(event, sizeof(event),
+                    "%s\n{\"name\":\"%s\",\"cat\":\"matrix\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                    isFirst ? "" : ",", registry.operations[span.operation].c_str(),
+                    span.start / 1e3, span.duration / 1e3, pThread->id);
+                stream << event;
+                isFirst = false;
+            }
+        }
+    }
+#endif
+    stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+inline void
+MatrixMath::
+SetTraceCapacity(const std::size_t spansPerThread)
+{
+#if MATRIX_TRACE
+    detail::TraceRegistry::Get().capacity.store(spansPerThread);
+#else
+    (void)spansPerThread;
+#endif
+}
+
+inline void
+MatrixMath::
+ResetTrace()
+{
+#if MATRIX_TRACE
+    detail::TraceRegistry& registry{ detail::TraceRegistry::Get() };
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<detail::TraceThread*> live;
+    for (detail::TraceThread* pThread : registry.threads)
+    {
+        if (pThread->isExited.load())
+        {
+            delete pThread;
+            continue;
+        }
+        for (auto& totals : pThread->totals)
+            for (auto& total : totals)
+                total.store(0, std::memory_order_relaxed);
+        for (detail::TraceChunk* pChunk = pThread->first.pNext.exchange(nullptr); pChunk != nullptr;)
+        {
+            detail::TraceChunk* pNext{ pChunk->pNext.load() };
+            delete pChunk;
+            pChunk = pNext;
+        }
+        pThread->first.count.store(0);
+        pThread->pLast = &pThread->first;
+        pThread->recorded = 0;
+        live.push_back(pThread);
+    }
+    registry.threads = std::move(live);
+#endif
+}
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "Cpu.h"
+
+// Block sizes and unroll factors of the kernels. Every machine gets the
+// compiled-in defaults below, unless the tuning file has an entry for its
+// CPU model and instruction set: the file named by the environment variable
+// MATRIX_TUNING_FILE, or MatrixTuning.cfg in the working directory, is read
+// when a kernel first needs the tuning. The entries are written by
+// Autotune (Autotune.h), e.g. from `MatrixBenchmark --tune`:
+//
+//   # MatrixMath tuning
+//   [Intel(R) Xeon(R) Gold 6148 CPU @ 2.40GHz|avx512]
+//   multiply.rows = 4
+//   multiply.depth = 256
+//   multiply.width = 512
+//   transpose.leaf = 32
+//   lu.block = 64
+
+namespace MatrixMath
+{
+    struct TuningParameters
+    {
+        // rows of C accumulated in registers by the GEMM kernel: 1, 2, 4 or 8
+        int multiplyRows{ 4 };
+        // the GEMM kernel goes through B in blocks of (depth x width),
+        // which stay in cache while all the rows of C are updated;
+        // the width is a multiple of 16, the widest SIMD register
+        int multiplyDepth{ 256 };
+        int multiplyWidth{ 512 };
+        // edge length under which the recursive transpositions stop
+        // dividing the problem, at least MinTransposeLeafSize
+        int transposeLeaf{ 32 };
+        // block size of DistributedMatrix created without one, which is
+        // the panel width of DecomposeLU
+        int luBlock{ 64 };
+
+        bool IsValid() const;
+    };
+
+    // Leaves of the transpositions are never smaller,
+    // so that the blocks up to this size need no tuning
+    constexpr int MinTransposeLeafSize{ 8 };
+
+    // The parameters in use, loaded from the tuning file on first use
+    TuningParameters GetTuning();
+    // std::errc::invalid_argument if `parameters` are not valid;
+    // the kernels running meanwhile may still use the previous ones
+    std::errc SetTuning(const TuningParameters& parameters);
+
+    // "<CPU model>|<instruction set level in use>", the key of the tuning file entries
+    std::string GetMachineKey();
+    // Use the entry of this machine in the tuning file at `path`;
+    // std::errc::no_such_device if it has none, std::errc::invalid_argument
+    // if the entry is malformed, in which case nothing is changed
+    std::errc LoadTuning(const char* path);
+    // Replace the entry of this machine in the tuning file at `path`,
+    // keeping the entries of the other machines
+    std::errc SaveTuning(const char* path, const TuningParameters& parameters);
+}
+
+namespace detail
+{
+    // The tuning in use, read by the kernels without locking
+    struct TuningState
+    {
+        std::atomic<int> multiplyRows;
+        std::atomic<int> multiplyDepth;
+        std::atomic<int> multiplyWidth;
+        std::atomic<int> transposeLeaf;
+        std::atomic<int> luBlock;
+
+        void Store(const MatrixMath::TuningParameters& parameters)
+        {
+            multiplyRows.store(parameters.multiplyRows, std::memory_order_relaxed);
+            multiplyDepth.store(parameters.multiplyDepth, std::memory_order_relaxed);
+            multiplyWidth.store(parameters.multiplyWidth, std::memory_order_relaxed);
+            transposeLeaf.store(parameters.transposeLeaf, std::memory_order_relaxed);
+            luBlock.store(parameters.luBlock, std::memory_order_relaxed);
+        }
+
+        MatrixMath::TuningParameters Load() const
+        {
+            MatrixMath::TuningParameters parameters;
+            parameters.multiplyRows = multiplyRows.load(std::memory_order_relaxed);
+            parameters.multiplyDepth = multiplyDepth.load(std::memory_order_relaxed);
+            parameters.multiplyWidth = multiplyWidth.load(std::memory_order_relaxed);
+            parameters.transposeLeaf = transposeLeaf.load(std::memory_order_relaxed);
+            parameters.luBlock = luBlock.load(std::memory_order_relaxed);
+            return parameters;
+        }
+
+        // Never destroyed, so that the kernels running at exit can still read it
+        static TuningState& Get();
+    };
+
+    inline std::string TuningFilePath()
+    {
+#if defined(_MSC_VER)
+        char* value{ nullptr };
+        std::size_t length{ 0 };
+        std::string path;
+        if (_dupenv_s(&value, &length, "MATRIX_TUNING_FILE") == 0 && value != nullptr)
+            path = value;
+        std::free(value);
+#else
+        const char* value{ std::getenv("MATRIX_TUNING_FILE") };
+        std::string path{ value != nullptr ? value : "" };
+#endif
+        return path.empty() ? "MatrixTuning.cfg" : path;
+    }
+
+    inline std::string TrimTuning(const std::string& text)
+    {
+        const std::size_t first{ text.find_first_not_of(" \t\r") };
+        if (first == std::string::npos)
+            return std::string();
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    // The lines of every entry of a tuning file by key,
+    // in the order of the file; the lines before the first entry are dropped
+    inline std::vector<std::pair<std::string, std::vector<std::string>>> ReadTuningEntries(std::istream& stream)
+    {
+        std::vector<std::pair<std::string, std::vector<std::string>>> entries;
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            line = TrimTuning(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+            if (line.front() == '[' && line.back() == ']')
+                entries.emplace_back(line.substr(1, line.size() - 2), std::vector<std::string>());
+            else if (!entries.empty())
+                entries.back().second.push_back(line);
+        }
+        return entries;
+    }
+
+    // std::errc::invalid_argument on a line which is not "name = integer"
+    inline std::errc ParseTuningEntry(const std::vector<std::string>& lines, MatrixMath::TuningParameters& parameters)
+    {
+        for (const std::string& line : lines)
+        {
+            const std::size_t equal{ line.find('=') };
+            if (equal == std::string::npos)
+                return std::errc::invalid_argument;
+            const std::string name{ TrimTuning(line.substr(0, equal)) };
+            const std::string text{ TrimTuning(line.substr(equal + 1)) };
+            char* end{ nullptr };
+            const long value{ std::strtol(text.c_str(), &end, 10) };
+            if (text.empty() || *end != '\0' || value <= 0 || value > 1 << 20)
+                return std::errc::invalid_argument;
+
+            if (name == "multiply.rows")
+                parameters.multiplyRows = static_cast<int>(value);
+            else if (name == "multiply.depth")
+                parameters.multiplyDepth = static_cast<int>(value);
+            else if (name == "multiply.width")
+                parameters.multiplyWidth = static_cast<int>(value);
+            else if (name == "transpose.leaf")
+                parameters.transposeLeaf = static_cast<int>(value);
+            else if (name == "lu.block")
+                parameters.luBlock = static_cast<int>(value);
+            // the parameters of later versions are skipped
+        }
+        return std::errc{};
+    }
+}
+
+
+inline bool
+MatrixMath::TuningParameters::
+IsValid() const
+{
+    return (multiplyRows == 1 || multiplyRows == 2 || multiplyRows == 4 || multiplyRows == 8)
+        && multiplyDepth > 0
+        && multiplyWidth > 0 && multiplyWidth % 16 == 0
+        && transposeLeaf >= MinTransposeLeafSize
+        && luBlock > 0;
+}
+
+inline detail::TuningState&
+detail::TuningState::
+Get()
+{
+    static TuningState* pState{ [] {
+        TuningState* pState{ new TuningState };
+        pState->Store(MatrixMath::TuningParameters{});
+        std::ifstream file(TuningFilePath());
+        if (file)
+        {
+            // a malformed entry leaves the defaults
+            const std::string key{ MatrixMath::GetMachineKey() };
+            for (const auto& entry : ReadTuningEntries(file))
+            {
+                MatrixMath::TuningParameters parameters;
+                if (entry.first == key
+                    && ParseTuningEntry(entry.second, parameters) == std::errc{} && parameters.IsValid())
+                    pState->Store(parameters);
+            }
+        }
+        return pState;
+    }() };
+    return *pState;
+}
+
+inline MatrixMath::TuningParameters
+MatrixMath::
+GetTuning()
+{
+    return detail::TuningState::Get().Load();
+}
+
+inline std::errc
+MatrixMath::
+SetTuning(const TuningParameters& parameters)
+{
+    if (!parameters.IsValid())
+        return std::errc::invalid_argument;
+    detail::TuningState::Get().Store(parameters);
+    return std::errc{};
+}
+
+inline std::string
+MatrixMath::
+GetMachineKey()
+{
+    std::string model{ GetCpuModel() };
+    // the separators of the tuning file
+    for (char& character : model)
+        if (character == '|' || character == '[' || character == ']')
+            character = ' ';
+    return model + "|" + GetIsaName(GetIsaLevel());
+}
+
+inline std::errc
+MatrixMath::
+LoadTuning(const char* path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return std::errc::no_such_file_or_directory;
+
+    const std::string key{ GetMachineKey() };
+    for (const auto& entry : detail::ReadTuningEntries(file))
+    {
+        if (entry.first != key)
+            continue;
+        // the parameters missing from the entry keep their defaults
+        TuningParameters parameters;
+        if (detail::ParseTuningEntry(entry.second, parameters) != std::errc{})
+            return std::errc::invalid_argument;
+        return SetTuning(parameters);
+    }
+    return std::errc::no_such_device;
+}
+
+inline std::errc
+MatrixMath::
+SaveTuning(const char* path, const TuningParameters& parameters)
+{
+    if (!parameters.IsValid())
+        return std::errc::invalid_argument;
+
+    std::vector<std::pair<std::string, std::vector<std::string>>> entries;
+    {
+        std::ifstream file(path);
+        if (file)
+            entries = detail::ReadTuningEntries(file);
+    }
+
+    std::vector<std::string> lines{
+        "multiply.rows = " + std::to_string(parameters.multiplyRows),
+        "multiply.depth = " + std::to_string(parameters.multiplyDepth),
+        "multiply.width = " + std::to_string(parameters.multiplyWidth),
+        "transpose.leaf = " + std::to_string(parameters.transposeLeaf),
+        "lu.block = " + std::to_string(parameters.luBlock),
+    };
+    const std::string key{ GetMachineKey() };
+    bool isFound{ false };
+    for (auto& entry : entries)
+    {
+        if (entry.first == key)
+        {
+            entry.second = lines;
+            isFound = true;
+        }
+    }
+    if (!isFound)
+        entries.emplace_back(key, std::move(lines));
+
+    std::ostringstream text;
+    text << "# MatrixMath tuning, one entry per CPU model and instruction set\n";
+    for (const auto& entry : entries)
+    {
+        text << "\n[" << entry.first << "]\n";
+        for (const std::string& line : entry.second)
+            text << line << "\n";
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file || !(file << text.str()) || !file.flush())
+        return std::errc::io_error;
+    return std::errc{};
+}
@@ -0,0 +1,5 @@
+// MatrixInstances.cpp : Defines the explicit instantiations declared in "MatrixInstances.h".
+//
+
+#define MATRIX_EXTERN
+#include "MatrixInstances.h"